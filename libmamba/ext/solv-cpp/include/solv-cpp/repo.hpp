@@ -86,6 +86,13 @@ namespace solv
          */
         auto tool_version() const -> std::string_view;
 
+        /**
+         * The base url of the packages in the repository.
+         *
+         * @see ObjRepoView::set_base_url
+         */
+        auto base_url() const -> std::string_view;
+
         /** The number of solvables in this repository. */
         auto solvable_count() const -> std::size_t;
 
@@ -206,6 +213,19 @@ namespace solv
         void set_tool_version(raw_str_view str) const;
         void set_tool_version(const std::string& str) const;
 
+        /**
+         * Set the base url of the packages in the repository.
+         *
+         * This has no effect for libsolv and is purely for data storing.
+         * It allows not to store the url of every solvable when they only differ by their
+         * filename.
+         *
+         * @note A call to @ref ObjRepoView::internalize is required for this attribute to
+         *       be available for lookup.
+         */
+        void set_base_url(raw_str_view str) const;
+        void set_base_url(const std::string& str) const;
+
         /**
          * Clear all solvables from the repository.
          *
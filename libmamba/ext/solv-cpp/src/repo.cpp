@@ -360,6 +360,30 @@ namespace solv
         return set_tool_version(str.c_str());
     }
 
+    namespace
+    {
+        // This does modify the pool but does not impact our use
+        auto base_url_key(const ::Repo* repo) -> StringId
+        {
+            return ::pool_str2id(repo->pool, "repository:base_url", /* create= */ true);
+        }
+    }
+
+    auto ObjRepoViewConst::base_url() const -> std::string_view
+    {
+        return repo_lookup_str(raw(), base_url_key(raw()));
+    }
+
+    void ObjRepoView::set_base_url(raw_str_view str) const
+    {
+        return repo_set_str(raw(), base_url_key(raw()), str);
+    }
+
+    void ObjRepoView::set_base_url(const std::string& str) const
+    {
+        return set_base_url(str.c_str());
+    }
+
     void ObjRepoView::set_subdir(raw_str_view str) const
     {
         return repo_set_str(raw(), SOLVABLE_MEDIADIR, str);
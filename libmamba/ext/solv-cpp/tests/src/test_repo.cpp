@@ -75,6 +75,7 @@ namespace
             repo.set_subdir("noarch");
             repo.set_pip_added(true);
             repo.set_tool_version("1.2.3.4");
+            repo.set_base_url("https://repo.mamba.pm/conda-forge/noarch");
 
             SECTION("Empty without internalize")
             {
@@ -85,6 +86,7 @@ namespace
                 REQUIRE(repo.subdir() == "");
                 REQUIRE(repo.pip_added() == false);
                 REQUIRE(repo.tool_version() == "");
+                REQUIRE(repo.base_url() == "");
             }
 
             SECTION("Internalize and get attributes")
@@ -98,6 +100,7 @@ namespace
                 REQUIRE(repo.mod() == "Tue, 25 Apr 2023 11:48:37 GMT");
                 REQUIRE(repo.pip_added() == true);
                 REQUIRE(repo.tool_version() == "1.2.3.4");
+                REQUIRE(repo.base_url() == "https://repo.mamba.pm/conda-forge/noarch");
 
                 SECTION("Override attribute")
                 {
@@ -308,6 +308,53 @@ namespace YAML
         }
     };
 
+    template <>
+    struct convert<mamba::LogOverflowPolicy>
+    {
+        static Node encode(const mamba::LogOverflowPolicy& rhs)
+        {
+            if (rhs == mamba::LogOverflowPolicy::Block)
+            {
+                return Node("block");
+            }
+            else if (rhs == mamba::LogOverflowPolicy::DropOldest)
+            {
+                return Node("drop_oldest");
+            }
+            else
+            {
+                return Node();
+            }
+        }
+
+        static bool decode(const Node& node, mamba::LogOverflowPolicy& rhs)
+        {
+            if (!node.IsScalar())
+            {
+                return false;
+            }
+
+            auto str = node.as<std::string>();
+
+            if (str == "block")
+            {
+                rhs = mamba::LogOverflowPolicy::Block;
+            }
+            else if (str == "drop_oldest")
+            {
+                rhs = mamba::LogOverflowPolicy::DropOldest;
+            }
+            else
+            {
+                throw std::runtime_error(
+                    "Invalid 'LogOverflowPolicy', should be in {'block', 'drop_oldest'}"
+                );
+            }
+
+            return true;
+        }
+    };
+
     template <>
     struct convert<mamba::fs::u8path>
     {
@@ -17,6 +17,7 @@
 #include "mamba/core/palette.hpp"
 #include "mamba/core/subdir_parameters.hpp"
 #include "mamba/core/tasksync.hpp"
+#include "mamba/core/timings.hpp"
 #include "mamba/download/mirror_map.hpp"
 #include "mamba/download/parameters.hpp"
 #include "mamba/fs/filesystem.hpp"
@@ -60,7 +61,14 @@ namespace mamba
         Strict
     };
 
+    enum class LogOverflowPolicy
+    {
+        Block,
+        DropOldest
+    };
+
 
+    class AsyncLogQueue;
     class Logger;
     class Context;
 
@@ -87,6 +95,11 @@ namespace mamba
 
             std::string log_pattern{ "%^%-9!l%-8n%$ %v" };
             std::size_t log_backtrace{ 0 };
+            // Size of the queue of the logging thread, 0 to log synchronously
+            std::size_t log_async_queue_size{ 0 };
+            LogOverflowPolicy log_async_overflow{ LogOverflowPolicy::Block };
+            // File where the timings of the command are written, empty to not record them
+            fs::u8path timings_json;
         };
 
         struct GraphicsParams
@@ -121,6 +134,7 @@ namespace mamba
         bool auto_activate_base = false;
 
         bool extract_sparse = false;
+        bool stream_extract = false;
 
         bool dry_run = false;
         bool download_only = false;
@@ -206,6 +220,7 @@ namespace mamba
             return {
                 /* .offline */ this->offline,
                 /* .repodata_check_zst */ this->repodata_use_zst,
+                /* .timings */ &this->timings,
             };
         }
 
@@ -219,7 +234,8 @@ namespace mamba
                      /* .platform */ platform,
                      /* .prefix_params */ prefix_params,
                      /* .link_params */ link_params,
-                     /* .threads_params */ threads_params };
+                     /* .threads_params */ threads_params,
+                     /* .timings */ &timings };
         }
 
         std::size_t lock_timeout = 0;
@@ -267,6 +283,10 @@ namespace mamba
         // since we need to add a single "mirror" for non mirrored channels
         download::mirror_map mirrors;
 
+        // Time spent in the phases of the command, recorded when enabled.
+        // Mutable since phases are recorded from code only reading the configuration.
+        mutable Timings timings;
+
         Context(const Context&) = delete;
         Context& operator=(const Context&) = delete;
 
@@ -279,6 +299,13 @@ namespace mamba
         void set_verbosity(int lvl);
         void set_log_level(log_level level);
 
+        // Write the logs from a dedicated thread through a bounded queue, or synchronously if
+        // ``queue_size`` is 0.
+        // The previous queue, if any, is closed once its messages are written, and nothing is
+        // done if the queue size and policy are unchanged.
+        // This must be called while no other thread is logging.
+        void set_async_logging(std::size_t queue_size, LogOverflowPolicy policy);
+
         Context(const ContextOptions& options = {});
         ~Context();
 
@@ -293,6 +320,8 @@ namespace mamba
 
         class ScopedLogger;
         std::vector<ScopedLogger> loggers;
+        // Shared by the sinks of the loggers when logging asynchronously
+        std::shared_ptr<AsyncLogQueue> m_log_queue;
 
         std::shared_ptr<Logger> main_logger();
         void add_logger(std::shared_ptr<Logger>);
@@ -15,6 +15,8 @@
 // with a better name when the Context is fully refactored.
 namespace mamba
 {
+    class Timings;
+
     struct CommandParams
     {
         std::string caller_version{ "" };
@@ -58,5 +60,7 @@ namespace mamba
         PrefixParams prefix_params;
         LinkParams link_params;
         ThreadsParams threads_params;
+        /** Where the counters of the transaction are recorded, if not null. */
+        Timings* timings = nullptr;
     };
 }
@@ -8,9 +8,17 @@
 #define MAMBA_CORE_EXECUTION_HPP
 
 #include <atomic>
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 #include "mamba/core/error_handling.hpp"
@@ -22,15 +30,74 @@ namespace mamba
         using mamba_error::mamba_error;
     };
 
+    // Fixed-size pool of worker threads with one task queue per worker.
+    // Tasks posted from a worker go to that worker's own queue, other tasks are distributed
+    // round-robin. An idle worker first takes the most recent task of its own queue, then steals
+    // the oldest task of the other queues, so a burst of tasks posted to a single queue is still
+    // spread over all workers.
+    // Tasks must not block waiting on other tasks of the same pool, this could exhaust the workers.
+    class ThreadPool
+    {
+    public:
+
+        using task_type = std::function<void()>;
+
+        // Starts `thread_count` workers (at least one).
+        explicit ThreadPool(std::size_t thread_count);
+
+        // Stops the pool (see `join()`).
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        ThreadPool(ThreadPool&&) = delete;
+        ThreadPool& operator=(ThreadPool&&) = delete;
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+        // Queues a task for execution by one of the workers.
+        // Returns false and drops the task if the pool is stopping, unless the task is posted
+        // by one of the pool workers, in which case it is still run before the workers exit.
+        // Exceptions escaping a task are logged and ignored.
+        auto post(task_type task) -> bool;
+
+        // Requests the workers to exit once all queued tasks are done, without waiting for them.
+        void stop();
+
+        // Stops the pool and blocks until all the queued tasks are done and workers are joined.
+        // Must not be called from one of the workers of this pool.
+        void join();
+
+    private:
+
+        struct WorkQueue
+        {
+            std::mutex mutex;
+            std::deque<task_type> tasks;
+        };
+
+        std::vector<std::unique_ptr<WorkQueue>> m_queues;
+        std::vector<std::thread> m_workers;
+        std::atomic<std::size_t> m_next_queue{ 0 };
+
+        std::mutex m_state_mutex;
+        std::condition_variable m_state_cv;
+        bool m_stopping = false;
+
+        void run_worker(std::size_t index);
+        auto try_pop(std::size_t index) -> task_type;
+        auto has_queued_tasks() -> bool;
+    };
+
     // Main execution resource (for example threads) handler for this library.
     // Allows scoping the lifetime of threads being used by the library.
     // The user code can either create an instance of this type to determine
     // itself the lifetime of the threads, or it can just use `MainExecutor::instance()`
     // to obtain a global static instance. In this last case, `MainExecutor::instance().close()`
     // have to be called before the end of `main()` to avoid undefined behaviors.
-    // WARNING: this is a temporary solution designed to evolve, the current implementation
-    // uses threads directly, a future implementation will use a thread-pool or other similar
-    // mechanisms.
+    // Short-lived tasks should be given to `submit()` which runs them on a bounded `ThreadPool`.
+    // Long-running tasks (for example progress bars watchers) should be given to `schedule()`
+    // which runs each of them in a dedicated thread, so that they cannot starve the pool.
     class MainExecutor
     {
     public:
@@ -56,7 +123,7 @@ namespace mamba
         // This is mostly used for testing and libraries using the default main executor.
         static void stop_default();
 
-        // Schedules a task for execution.
+        // Schedules a task for execution in a dedicated thread.
         // The task must be a callable which takes either the provided arguments or none.
         // If this executor is open, the task is scheduled for execution and will be called
         // as soon as execution resources are available. The call to the task is not guaranteed
@@ -78,6 +145,116 @@ namespace mamba
             }
         }
 
+        // Submits a task for execution by the worker pool and returns a future to its result.
+        // The task must be a callable which takes either the provided arguments or none.
+        // The pool is started at the first submission with `pool_size()` workers, tasks are
+        // called as soon as a worker is available.
+        // If this executor is closed, the task is ignored and the returned future holds
+        // a `std::future_error` (broken promise).
+        template <typename Task, typename... Args>
+        auto submit(Task&& task, Args&&... args)
+            -> std::future<std::invoke_result_t<std::decay_t<Task>, std::decay_t<Args>...>>
+        {
+            using result_type = std::invoke_result_t<std::decay_t<Task>, std::decay_t<Args>...>;
+
+            auto packaged = std::make_shared<std::packaged_task<result_type()>>(
+                [t = std::forward<Task>(task), ... a = std::forward<Args>(args)]() mutable
+                { return std::invoke(std::move(t), std::move(a)...); }
+            );
+            auto future = packaged->get_future();
+
+            if (!is_open)
+            {
+                return future;
+            }
+
+            std::scoped_lock lock{ pool_mutex };
+            if (is_open)  // Double check necessary for correctness
+            {
+                if (!pool)
+                {
+                    pool = std::make_unique<ThreadPool>(requested_pool_size);
+                }
+                pool->post([packaged = std::move(packaged)] { (*packaged)(); });
+            }
+            return future;
+        }
+
+        // Calls `func(i)` for every `i` in `[0, count)` and blocks until all calls are done.
+        // The calls are shared between the calling thread and up to `pool_size()` helper tasks
+        // submitted to the pool. The calling thread never waits on a helper that has not started,
+        // so this can be used from a submitted task even when all the workers are busy.
+        // After a call throws, the remaining indices are skipped and the first exception is
+        // rethrown.
+        template <typename Func>
+        void parallel_for(std::size_t count, Func&& func)
+        {
+            struct State
+            {
+                std::atomic<std::size_t> next{ 0 };
+                std::atomic<bool> failed{ false };
+                std::size_t finished = 0;
+                std::exception_ptr error = nullptr;
+                std::mutex mutex;
+                std::condition_variable cv;
+            };
+
+            auto state = std::make_shared<State>();
+            // Only dereferenced for claimed indices, which are all done before returning.
+            auto* const func_ptr = &func;
+            auto work = [state, func_ptr, count]
+            {
+                for (auto i = state->next++; i < count; i = state->next++)
+                {
+                    auto error = std::exception_ptr();
+                    if (!state->failed)
+                    {
+                        try
+                        {
+                            (*func_ptr)(i);
+                        }
+                        catch (...)
+                        {
+                            error = std::current_exception();
+                        }
+                    }
+                    std::scoped_lock lock{ state->mutex };
+                    if (error && !state->failed)
+                    {
+                        state->failed = true;
+                        state->error = std::move(error);
+                    }
+                    if (++state->finished == count)
+                    {
+                        state->cv.notify_all();
+                    }
+                }
+            };
+
+            const auto helper_count = std::min(pool_size(), count > 0 ? count - 1 : 0);
+            for (std::size_t h = 0; h < helper_count; ++h)
+            {
+                submit(work);
+            }
+            work();
+
+            std::unique_lock lock{ state->mutex };
+            state->cv.wait(lock, [&] { return state->finished == count; });
+            if (state->error)
+            {
+                std::rethrow_exception(state->error);
+            }
+        }
+
+        // Returns the number of workers used by the pool running submitted tasks.
+        [[nodiscard]] auto pool_size() -> std::size_t;
+
+        // Sets the number of workers used by the pool running submitted tasks.
+        // A value of zero means the hardware concurrency.
+        // If the pool is already running with a different size, it is replaced by a new one
+        // and the previous one finishes its tasks in the background.
+        void set_pool_size(std::size_t size);
+
         // Moves ownership of a thread into this executor.
         // This is used in case a thread needs to be manipulated in a particular way,
         // but we still want to avoid having to use `std::thread::detach()`. By
@@ -100,7 +277,7 @@ namespace mamba
         }
 
         // Closes this executor:
-        // Only returns once all tasks scheduled before this call are finished
+        // Only returns once all tasks scheduled or submitted before this call are finished
         // and all owned execution resources (aka threads) are released.
         // Note that if any task never ends, this function will never end either.
         // Once called this function makes all other functions no-op, even before returning, to
@@ -116,12 +293,16 @@ namespace mamba
 
             invoke_close_handlers();
 
-            std::scoped_lock lock{ threads_mutex };
-            for (auto&& t : threads)
             {
-                t.join();
+                std::scoped_lock lock{ threads_mutex };
+                for (auto&& t : threads)
+                {
+                    t.join();
+                }
+                threads.clear();
             }
-            threads.clear();
+
+            join_pools();
         }
 
         using on_close_handler = std::function<void()>;
@@ -146,10 +327,16 @@ namespace mamba
         std::vector<std::thread> threads;
         std::recursive_mutex threads_mutex;  // TODO: replace by synchronized_value once available
 
+        std::unique_ptr<ThreadPool> pool;
+        std::vector<std::unique_ptr<ThreadPool>> retired_pools;
+        std::size_t requested_pool_size = std::thread::hardware_concurrency();
+        std::mutex pool_mutex;  // TODO: replace by synchronized_value once available
+
         std::vector<on_close_handler> close_handlers;
         std::recursive_mutex handlers_mutex;  // TODO: replace by synchronized_value once available
 
         void invoke_close_handlers();
+        void join_pools();
     };
 
 
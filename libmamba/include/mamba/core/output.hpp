@@ -11,6 +11,7 @@
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include <fmt/color.h>
@@ -175,6 +176,18 @@ namespace mamba
 
         std::stringstream& stream();
 
+        /**
+         * Whether a message of the given level would be logged.
+         *
+         * Messages below the logger level are still kept when a backtrace is enabled, or while
+         * they are buffered.
+         */
+        static bool is_enabled(log_level level);
+
+        /** Log a message formatted with ``fmt``, whatever the level. */
+        template <typename... Args>
+        static void log(log_level level, fmt::format_string<Args...> format, Args&&... args);
+
         static void activate_buffer();
         static void deactivate_buffer();
         static void print_buffer(std::ostream& ostream);
@@ -184,9 +197,28 @@ namespace mamba
         log_level m_level;
         std::stringstream m_stream;
 
+        static void log_message(std::string msg, log_level level);
         static void emit(const std::string& msg, const log_level& level);
     };
 
+    template <typename... Args>
+    void MessageLogger::log(log_level level, fmt::format_string<Args...> format, Args&&... args)
+    {
+        log_message(fmt::format(format, std::forward<Args>(args)...), level);
+    }
+
+    /**
+     * Turn the stream of the ``LOG`` macros into ``void``.
+     *
+     * The ``&`` operator binds less than ``<<`` but more than ``?:``.
+     */
+    struct MessageLoggerVoidify
+    {
+        void operator&(std::ostream&) const
+        {
+        }
+    };
+
 }  // namespace mamba
 
 #undef LOG
@@ -196,8 +228,19 @@ namespace mamba
 #undef LOG_WARNING
 #undef LOG_ERROR
 #undef LOG_CRITICAL
-
-#define LOG(severity) mamba::MessageLogger(severity).stream()
+#undef LOG_FMT
+#undef LOG_TRACE_FMT
+#undef LOG_DEBUG_FMT
+#undef LOG_INFO_FMT
+#undef LOG_WARNING_FMT
+#undef LOG_ERROR_FMT
+#undef LOG_CRITICAL_FMT
+
+// The operands of ``<<`` are only evaluated if the level is enabled.
+#define LOG(severity)                                                                              \
+    !mamba::MessageLogger::is_enabled(severity)                                                    \
+        ? static_cast<void>(0)                                                                     \
+        : mamba::MessageLoggerVoidify() & mamba::MessageLogger(severity).stream()
 #define LOG_TRACE LOG(mamba::log_level::trace)
 #define LOG_DEBUG LOG(mamba::log_level::debug)
 #define LOG_INFO LOG(mamba::log_level::info)
@@ -205,4 +248,15 @@ namespace mamba
 #define LOG_ERROR LOG(mamba::log_level::err)
 #define LOG_CRITICAL LOG(mamba::log_level::critical)
 
+// The arguments are only evaluated and formatted if the level is enabled.
+#define LOG_FMT(severity, ...)                                                                     \
+    (mamba::MessageLogger::is_enabled(severity) ? mamba::MessageLogger::log(severity, __VA_ARGS__) \
+                                                : static_cast<void>(0))
+#define LOG_TRACE_FMT(...) LOG_FMT(mamba::log_level::trace, __VA_ARGS__)
+#define LOG_DEBUG_FMT(...) LOG_FMT(mamba::log_level::debug, __VA_ARGS__)
+#define LOG_INFO_FMT(...) LOG_FMT(mamba::log_level::info, __VA_ARGS__)
+#define LOG_WARNING_FMT(...) LOG_FMT(mamba::log_level::warn, __VA_ARGS__)
+#define LOG_ERROR_FMT(...) LOG_FMT(mamba::log_level::err, __VA_ARGS__)
+#define LOG_CRITICAL_FMT(...) LOG_FMT(mamba::log_level::critical, __VA_ARGS__)
+
 #endif  // MAMBA_CORE_OUTPUT_HPP
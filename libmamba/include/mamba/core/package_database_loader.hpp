@@ -7,7 +7,11 @@
 #ifndef MAMBA_CORE_PACKAGE_DATABASE_LOADER_HPP
 #define MAMBA_CORE_PACKAGE_DATABASE_LOADER_HPP
 
+#include <memory>
+#include <vector>
+
 #include "mamba/core/error_handling.hpp"
+#include "mamba/solver/libsolv/parameters.hpp"
 #include "mamba/solver/libsolv/repo_info.hpp"
 #include "mamba/specs/channel.hpp"
 
@@ -30,6 +34,82 @@ namespace mamba
         const SubdirIndexLoader& subdir
     ) -> expected_t<solver::libsolv::RepoInfo>;
 
+    /**
+     * Load the subdirs in the database, in the given order.
+     *
+     * With the mamba repodata parser, the ``repodata.json`` of the subdirs without a valid solv
+     * cache are parsed concurrently on the @ref MainExecutor thread pool, while their packages
+     * are added to the database one subdir after the other on the calling thread.
+     * The time spent loading each subdir is logged.
+     */
+    auto load_subdirs_in_database(
+        const Context& ctx,
+        solver::libsolv::Database& database,
+        const std::vector<const SubdirIndexLoader*>& subdirs
+    ) -> std::vector<expected_t<solver::libsolv::RepoInfo>>;
+
+    /**
+     * Load subdirs in a database, parsing their ``repodata.json`` ahead of time.
+     *
+     * With the mamba repodata parser, @ref prepare starts parsing the ``repodata.json`` of a
+     * subdir without a valid solv cache on the @ref MainExecutor thread pool.
+     * It can be called as soon as the subdir cache is valid, for instance from the callback given
+     * to @ref SubdirIndexLoader::download_required_indexes, so that parsing overlaps downloads.
+     */
+    class SubdirDatabaseLoader
+    {
+    public:
+
+        explicit SubdirDatabaseLoader(const Context& ctx);
+        SubdirDatabaseLoader(const SubdirDatabaseLoader&) = delete;
+        SubdirDatabaseLoader(SubdirDatabaseLoader&&) = delete;
+        auto operator=(const SubdirDatabaseLoader&) -> SubdirDatabaseLoader& = delete;
+        auto operator=(SubdirDatabaseLoader&&) -> SubdirDatabaseLoader& = delete;
+        ~SubdirDatabaseLoader();
+
+        /** Thread-safe, preparing the same subdir more than once has no effect. */
+        void prepare(const SubdirIndexLoader& subdir);
+
+        /**
+         * Load the subdirs in the database, in the given order, on the calling thread.
+         *
+         * Subdirs not yet prepared are prepared first.
+         * The time spent loading each subdir is logged.
+         */
+        auto load(  //
+            solver::libsolv::Database& database,
+            const std::vector<const SubdirIndexLoader*>& subdirs
+        ) -> std::vector<expected_t<solver::libsolv::RepoInfo>>;
+
+    private:
+
+        struct Impl;
+        std::unique_ptr<Impl> p_impl;
+    };
+
+    /**
+     * Load the subdirs in the database from a single snapshot of all their solv caches.
+     *
+     * This only succeeds if all subdirs have a valid solv cache and a snapshot was written
+     * with @ref write_subdirs_snapshot for the same subdirs and priorities, in the same order.
+     * The loaded repos get the given priorities.
+     */
+    auto load_subdirs_from_snapshot(
+        const Context& ctx,
+        solver::libsolv::Database& database,
+        const std::vector<const SubdirIndexLoader*>& subdirs,
+        const std::vector<solver::libsolv::Priorities>& priorities
+    ) -> expected_t<std::vector<solver::libsolv::RepoInfo>>;
+
+    /** Write a snapshot of the repos loaded from the given subdirs, in the same order. */
+    void write_subdirs_snapshot(
+        const Context& ctx,
+        solver::libsolv::Database& database,
+        const std::vector<const SubdirIndexLoader*>& subdirs,
+        const std::vector<solver::libsolv::RepoInfo>& repos,
+        const std::vector<solver::libsolv::Priorities>& priorities
+    );
+
     auto load_installed_packages_in_database(
         const Context& ctx,
         solver::libsolv::Database& database,
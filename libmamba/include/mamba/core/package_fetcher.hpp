@@ -8,6 +8,8 @@
 #define MAMBA_CORE_PACKAGE_FETCHER_HPP
 
 #include <functional>
+#include <memory>
+#include <optional>
 
 #include "mamba/core/package_cache.hpp"
 #include "mamba/core/package_handling.hpp"
@@ -85,8 +87,12 @@ namespace mamba
         bool needs_download() const;
         bool needs_extract() const;
 
-        download::Request
-        build_download_request(std::optional<post_download_success_t> callback = std::nullopt);
+        // When ``options`` enables it, `.conda` packages are extracted while they are
+        // downloaded; the extracted directory is published by ``extract`` once validated.
+        download::Request build_download_request(
+            std::optional<post_download_success_t> callback = std::nullopt,
+            std::optional<ExtractOptions> options = std::nullopt
+        );
         ValidationResult
         validate(std::size_t downloaded_size, progress_callback_t* cb = nullptr) const;
         bool extract(const ExtractOptions& options, progress_callback_t* cb = nullptr);
@@ -119,6 +125,8 @@ namespace mamba
 
         void update_monitor(progress_callback_t* cb, PackageExtractEvent event) const;
 
+        bool publish_stream_extraction(const fs::u8path& extract_path);
+
         specs::PackageInfo m_package_info;
 
         fs::u8path m_tarball_path;
@@ -126,7 +134,10 @@ namespace mamba
 
         bool m_needs_download = false;
         std::string m_downloaded_url = {};
+        std::string m_downloaded_sha256 = {};
+        std::string m_downloaded_md5 = {};
         bool m_needs_extract = false;
+        std::shared_ptr<CondaStreamExtractor> m_stream_extractor = nullptr;
     };
 
     class PackageFetcherSemaphore
@@ -7,7 +7,10 @@
 #ifndef MAMBA_CORE_PACKAGE_HANDLING_HPP
 #define MAMBA_CORE_PACKAGE_HANDLING_HPP
 
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <system_error>
 #include <vector>
 
@@ -17,6 +20,8 @@ namespace mamba
 {
     struct ValidationParams;
     class Context;
+    class Timings;
+    class counting_semaphore;
 
     // Determine the kind of command line to run to extract subprocesses.
     enum class extract_subproc_mode
@@ -31,6 +36,10 @@ namespace mamba
     {
         bool sparse = false;
         extract_subproc_mode subproc_mode;
+        // Extract `.conda` packages while they are downloaded.
+        bool stream = false;
+        // Where the validation and extraction times are recorded, if not null.
+        Timings* timings = nullptr;
         static ExtractOptions from_context(const Context&);
     };
 
@@ -65,6 +74,54 @@ namespace mamba
         const ExtractOptions& options,
         const std::vector<std::string>& parts = { "info", "pkg" }
     );
+
+    // Extracts a `.conda` package into ``destination`` from its content fed in order, while it
+    // is being downloaded. The extraction is submitted to the MainExecutor with the first chunk,
+    // and holds a slot of ``semaphore`` while it runs. If it has not started when waited for, it
+    // runs on the waiting thread.
+    // It is abandoned, and the package must then be extracted from the downloaded file, if the
+    // content is not fed contiguously (e.g. a download restarting) or if more than
+    // ``max_buffered_size`` bytes are waiting to be extracted, or if no slot of ``semaphore`` is
+    // available.
+    // ``destination`` is removed on destruction, unless it has been moved away.
+    class CondaStreamExtractor
+    {
+    public:
+
+        static constexpr std::size_t default_max_buffered_size = 32 * 1024 * 1024;
+
+        CondaStreamExtractor(
+            fs::u8path destination,
+            ExtractOptions options,
+            counting_semaphore& semaphore,
+            std::size_t max_buffered_size = default_max_buffered_size
+        );
+        ~CondaStreamExtractor();
+
+        CondaStreamExtractor(const CondaStreamExtractor&) = delete;
+        CondaStreamExtractor& operator=(const CondaStreamExtractor&) = delete;
+        CondaStreamExtractor(CondaStreamExtractor&&) = delete;
+        CondaStreamExtractor& operator=(CondaStreamExtractor&&) = delete;
+
+        const fs::u8path& destination() const;
+
+        // Never blocks, ``chunk`` is copied.
+        void feed(std::size_t offset, std::string_view chunk);
+        // Signals the end of the content, without waiting for the extraction.
+        void close();
+        // Signals the end of the content and waits for the extraction to complete.
+        // Returns whether the whole package was extracted.
+        bool wait();
+
+    private:
+
+        struct Impl;
+        // Shared with the task extracting the package, which may outlive this object.
+        std::shared_ptr<Impl> p_impl;
+    };
+
+    // In-process extraction does not depend on process wide state (such as the working
+    // directory) and can be called concurrently from several threads.
     void
     extract(const fs::u8path& file, const fs::u8path& destination, const ExtractOptions& options);
     fs::u8path extract(const fs::u8path& file, const ExtractOptions& options);
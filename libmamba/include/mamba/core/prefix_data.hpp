@@ -47,6 +47,7 @@ namespace mamba
 
         PrefixData(const fs::u8path& prefix_path, ChannelContext& channel_context, bool no_pip);
 
+        void add_package_record(specs::PackageInfo prec);
         void load_site_packages();
 
         History m_history;
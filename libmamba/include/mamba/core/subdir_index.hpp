@@ -8,6 +8,7 @@
 #define MAMBA_CORE_SUBDIRDATA_HPP
 
 #include <algorithm>
+#include <functional>
 #include <optional>
 #include <string>
 #include <type_traits>
@@ -123,12 +124,22 @@ namespace mamba
     {
     public:
 
+        /**
+         * Called with a subdir as soon as it has a valid cache.
+         *
+         * It may be called from the downloading thread, concurrently with other downloads.
+         */
+        using on_index_ready_callback_t = std::function<void(const SubdirIndexLoader&)>;
+
         /**
          * Download the missing, invalid, or outdated indexes as needed in parallel.
          *
          * It first creates check requests to update some metadata, then download the indexes.
          * The result can be inspected with the input subdirs methods, such as
          * @ref valid_cache_found, @ref valid_json_cache_path etc.
+         * The optional @p on_index_ready is called for each subdir once its cache is valid,
+         * including the ones that already were, so that loading can start before all downloads
+         * are finished.
          */
         template <typename SubdirIter1, typename SubdirIter2>
         [[nodiscard]] static auto download_required_indexes(
@@ -140,7 +151,8 @@ namespace mamba
             const download::Options& download_options,
             const download::RemoteFetchParams& remote_fetch_params,
             download::Monitor* check_monitor = nullptr,
-            download::Monitor* download_monitor = nullptr
+            download::Monitor* download_monitor = nullptr,
+            const on_index_ready_callback_t& on_index_ready = nullptr
         ) -> expected_t<void>;
         template <typename Subdirs>
         [[nodiscard]] static auto download_required_indexes(
@@ -151,7 +163,8 @@ namespace mamba
             const download::Options& download_options,
             const download::RemoteFetchParams& remote_fetch_params,
             download::Monitor* check_monitor = nullptr,
-            download::Monitor* download_monitor = nullptr
+            download::Monitor* download_monitor = nullptr,
+            const on_index_ready_callback_t& on_index_ready = nullptr
         ) -> expected_t<void>;
 
         /** Check existing caches for a valid index validity and freshness. */
@@ -238,11 +251,16 @@ namespace mamba
         auto build_check_requests(const SubdirDownloadParams& params) -> download::MultiRequest;
 
         template <typename First, typename End>
-        static auto
-        build_all_index_requests(First subdirs_first, End subdirs_last, const SubdirDownloadParams& params)
-            -> download::MultiRequest;
-        auto build_index_request(const SubdirDownloadParams& params)
-            -> std::optional<download::Request>;
+        static auto build_all_index_requests(
+            First subdirs_first,
+            End subdirs_last,
+            const SubdirDownloadParams& params,
+            const on_index_ready_callback_t& on_index_ready
+        ) -> download::MultiRequest;
+        auto build_index_request(
+            const SubdirDownloadParams& params,
+            const on_index_ready_callback_t& on_index_ready
+        ) -> std::optional<download::Request>;
 
         [[nodiscard]] static auto download_requests(
             download::MultiRequest index_requests,
@@ -294,7 +312,8 @@ namespace mamba
         const download::Options& download_options,
         const download::RemoteFetchParams& remote_fetch_params,
         download::Monitor* check_monitor,
-        download::Monitor* download_monitor
+        download::Monitor* download_monitor,
+        const on_index_ready_callback_t& on_index_ready
     ) -> expected_t<void>
     {
         auto result = download_requests(
@@ -316,7 +335,7 @@ namespace mamba
         }
 
         return download_requests(
-            build_all_index_requests(subdirs_first, subdirs_last, subdir_params),
+            build_all_index_requests(subdirs_first, subdirs_last, subdir_params, on_index_ready),
             auth_info,
             mirrors,
             download_options,
@@ -334,7 +353,8 @@ namespace mamba
         const download::Options& download_options,
         const download::RemoteFetchParams& remote_fetch_params,
         download::Monitor* check_monitor,
-        download::Monitor* download_monitor
+        download::Monitor* download_monitor,
+        const on_index_ready_callback_t& on_index_ready
     ) -> expected_t<void>
     {
         return download_required_indexes(
@@ -346,7 +366,8 @@ namespace mamba
             download_options,
             remote_fetch_params,
             check_monitor,
-            download_monitor
+            download_monitor,
+            on_index_ready
         );
     }
 
@@ -385,7 +406,8 @@ namespace mamba
     auto SubdirIndexLoader::build_all_index_requests(
         First subdirs_first,
         End subdirs_last,
-        const SubdirDownloadParams& params
+        const SubdirDownloadParams& params,
+        const on_index_ready_callback_t& on_index_ready
     ) -> download::MultiRequest
     {
         download::MultiRequest requests;
@@ -405,11 +427,15 @@ namespace mamba
 
             if (!p_subdir->valid_cache_found())
             {
-                if (auto request = p_subdir->build_index_request(params))
+                if (auto request = p_subdir->build_index_request(params, on_index_ready))
                 {
                     requests.push_back(*std::move(request));
                 }
             }
+            else if (on_index_ready)
+            {
+                on_index_ready(*p_subdir);
+            }
         }
         return requests;
     }
@@ -11,6 +11,8 @@
 
 namespace mamba
 {
+    class Timings;
+
     struct SubdirParams
     {
         /**
@@ -29,6 +31,8 @@ namespace mamba
         bool offline = false;
         /** Make a request to check the use of zst compression format. */
         bool repodata_check_zst = true;
+        /** Where the transfer times are recorded, if not null. */
+        Timings* timings = nullptr;
     };
 }
 
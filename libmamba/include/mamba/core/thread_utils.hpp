@@ -163,6 +163,7 @@ namespace mamba
 
         inline counting_semaphore(std::ptrdiff_t max = 0);
         inline void lock();
+        inline bool try_lock();
         inline void unlock();
         inline std::ptrdiff_t get_max();
         inline void set_max(std::ptrdiff_t value);
@@ -191,6 +192,17 @@ namespace mamba
         --m_value;
     }
 
+    inline bool counting_semaphore::try_lock()
+    {
+        std::lock_guard<std::mutex> lock(m_access_mutex);
+        if (m_value <= 0)
+        {
+            return false;
+        }
+        --m_value;
+        return true;
+    }
+
     inline void counting_semaphore::unlock()
     {
         {
@@ -0,0 +1,119 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_CORE_TIMINGS_HPP
+#define MAMBA_CORE_TIMINGS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json_fwd.hpp>
+
+#include "mamba/fs/filesystem.hpp"
+
+namespace mamba
+{
+    /**
+     * Wall and CPU times spent in the phases of a command, and counters.
+     *
+     * A phase can be split into items, such as the subdirs or the packages it processes, in
+     * which case the phase holds the sum of its items.
+     * Items processed concurrently add up to more than the wall time of the whole phase.
+     * Nothing is recorded until enabled.
+     * All functions are thread safe.
+     */
+    class Timings
+    {
+    public:
+
+        using duration = std::chrono::nanoseconds;
+
+        struct Phase
+        {
+            duration wall_time = {};
+            /** The CPU time of the recording thread, zero when not measured. */
+            duration cpu_time = {};
+            std::size_t count = 0;
+        };
+
+        /** Record the time spent until destruction in a phase, from the current thread. */
+        class ScopedTimer
+        {
+        public:
+
+            /** Record nothing if ``timings`` is null or disabled. */
+            ScopedTimer(Timings* timings, std::string phase, std::string item = {});
+            ~ScopedTimer();
+
+            ScopedTimer(ScopedTimer&& other) noexcept;
+            ScopedTimer& operator=(ScopedTimer&&) = delete;
+            ScopedTimer(const ScopedTimer&) = delete;
+            ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+            /** Record the time spent so far, once. */
+            void stop();
+
+        private:
+
+            Timings* p_timings = nullptr;
+            std::string m_phase;
+            std::string m_item;
+            std::chrono::steady_clock::time_point m_wall_start;
+            duration m_cpu_start;
+        };
+
+        /** The CPU time used by the current thread. */
+        [[nodiscard]] static auto thread_cpu_time() -> duration;
+
+        void enable(bool value = true);
+        [[nodiscard]] auto enabled() const -> bool;
+
+        [[nodiscard]] auto time(std::string phase, std::string item = {}) -> ScopedTimer;
+
+        /** Add to a phase, and to one of its items if ``item`` is not empty. */
+        void record(
+            std::string_view phase,
+            std::string_view item,
+            duration wall_time,
+            duration cpu_time = {}
+        );
+
+        void add(std::string_view counter, std::size_t value = 1);
+
+        [[nodiscard]] auto phase(std::string_view phase) const -> std::optional<Phase>;
+        [[nodiscard]] auto item(std::string_view phase, std::string_view item) const
+            -> std::optional<Phase>;
+        [[nodiscard]] auto counter(std::string_view counter) const -> std::size_t;
+
+        /** The phases with their items, and the counters, with times in seconds. */
+        [[nodiscard]] auto to_json() const -> nlohmann::json;
+
+        void dump(const fs::u8path& path) const;
+
+        void clear();
+
+    private:
+
+        struct PhaseRecord
+        {
+            Phase total = {};
+            std::map<std::string, Phase, std::less<>> items = {};
+        };
+
+        mutable std::mutex m_mutex;
+        std::map<std::string, PhaseRecord, std::less<>> m_phases;
+        std::map<std::string, std::size_t, std::less<>> m_counters;
+        std::atomic<bool> m_enabled = false;
+    };
+}
+#endif
@@ -10,6 +10,7 @@
 #include <functional>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -27,6 +28,7 @@ namespace mamba::download
         std::string effective_url = "";
         std::size_t downloaded_size = 0;
         std::size_t average_speed_Bps = 0;
+        std::size_t total_time_us = 0;
     };
 
     struct Filename
@@ -49,6 +51,10 @@ namespace mamba::download
         std::string etag = "";
         std::string last_modified = "";
         std::size_t attempt_number = std::size_t(1);
+        // Hexadecimal digests of the content, computed while it was written when requested
+        // through ``RequestBase::compute_sha256`` and ``RequestBase::compute_md5``.
+        std::string sha256 = "";
+        std::string md5 = "";
     };
 
     struct Error
@@ -86,6 +92,8 @@ namespace mamba::download
         // TODO: remove these functions when we plug a library with continuation
         using on_success_callback_t = std::function<expected_t<void>(const Success&)>;
         using on_failure_callback_t = std::function<void(const Error&)>;
+        // Called with the offset of the chunk in the file and the chunk itself.
+        using on_content_callback_t = std::function<void(std::size_t, std::string_view)>;
 
         std::string name;
         // If filename is not initialized, the data will be downloaded
@@ -96,10 +104,17 @@ namespace mamba::download
         std::optional<std::size_t> expected_size = std::nullopt;
         std::optional<std::string> etag = std::nullopt;
         std::optional<std::string> last_modified = std::nullopt;
+        // Compute the digests of the content while it is being written, this avoids reading
+        // the downloaded file again to validate it.
+        bool compute_sha256 = false;
+        bool compute_md5 = false;
 
         std::optional<progress_callback_t> progress = std::nullopt;
         std::optional<on_success_callback_t> on_success = std::nullopt;
         std::optional<on_failure_callback_t> on_failure = std::nullopt;
+        // Called from the download thread with every chunk written to ``filename``. A new
+        // attempt writes the file from its start again, that is with an offset of 0.
+        std::optional<on_content_callback_t> on_content = std::nullopt;
 
     protected:
 
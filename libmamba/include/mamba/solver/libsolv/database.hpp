@@ -10,7 +10,9 @@
 #include <functional>
 #include <memory>
 #include <optional>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include "mamba/core/error_handling.hpp"
 #include "mamba/solver/libsolv/parameters.hpp"
@@ -41,6 +43,38 @@ namespace mamba::solver::libsolv
 {
     class Solver;
     class UnSolvable;
+    struct RepodataPackages;
+
+    /**
+     * The packages of a ``repodata.json`` file, parsed independently of any @ref Database.
+     *
+     * Parsing does not modify a database and can therefore be done concurrently for several
+     * files, whereas adding the packages to a database with
+     * @ref Database::add_repo_from_parsed_repodata must be done one repo at a time.
+     */
+    class ParsedRepodata
+    {
+    public:
+
+        ParsedRepodata(std::string url, std::unique_ptr<RepodataPackages> packages);
+        ParsedRepodata(const ParsedRepodata&) = delete;
+        ParsedRepodata(ParsedRepodata&&);
+
+        ~ParsedRepodata();
+
+        auto operator=(const ParsedRepodata&) -> ParsedRepodata& = delete;
+        auto operator=(ParsedRepodata&&) -> ParsedRepodata&;
+
+        [[nodiscard]] auto url() const -> const std::string&;
+        [[nodiscard]] auto package_count() const -> std::size_t;
+
+    private:
+
+        std::string m_url;
+        std::unique_ptr<RepodataPackages> m_packages;
+
+        friend class Database;
+    };
 
     /**
      * Database of solvable involved in resolving en environment.
@@ -89,6 +123,24 @@ namespace mamba::solver::libsolv
             RepodataParser repo_parser = RepodataParser::Mamba
         ) -> expected_t<RepoInfo>;
 
+        /**
+         * Parse a ``repodata.json`` file with the mamba parser, without modifying any database.
+         *
+         * This function can be called concurrently from several threads.
+         */
+        [[nodiscard]] static auto parse_repodata_json(
+            const fs::u8path& path,
+            std::string_view url,
+            PackageTypes package_types = PackageTypes::CondaOrElseTarBz2,
+            VerifyPackages verify_packages = VerifyPackages::No
+        ) -> expected_t<ParsedRepodata>;
+
+        auto add_repo_from_parsed_repodata(
+            const ParsedRepodata& repodata,
+            const std::string& channel_id,
+            PipAsPythonDependency add = PipAsPythonDependency::No
+        ) -> expected_t<RepoInfo>;
+
         auto add_repo_from_native_serialization(
             const fs::u8path& path,
             const RepodataOrigin& expected,
@@ -115,6 +167,44 @@ namespace mamba::solver::libsolv
         native_serialize_repo(const RepoInfo& repo, const fs::u8path& path, const RepodataOrigin& metadata)
             -> expected_t<RepoInfo>;
 
+        /**
+         * Add all the repos of a snapshot written with @ref native_serialize_repos.
+         *
+         * The whole file is memory mapped and read at once, and the repos get the priorities
+         * recorded in the snapshot.
+         * The snapshot is only used if it was written with the same entries, in the same order,
+         * and the same pip option. Otherwise an error is returned and the database is unchanged.
+         */
+        auto add_repos_from_native_snapshot(
+            const fs::u8path& path,
+            const std::vector<RepodataSnapshotEntry>& expected,
+            PipAsPythonDependency add = PipAsPythonDependency::No
+        ) -> expected_t<std::vector<RepoInfo>>;
+
+        /**
+         * Read the entries of a snapshot written with @ref native_serialize_repos.
+         *
+         * The repos are not read.
+         * An error is returned if the snapshot was written with another version of libsolv or
+         * another pip option.
+         */
+        [[nodiscard]] static auto native_snapshot_entries(
+            const fs::u8path& path,
+            PipAsPythonDependency add = PipAsPythonDependency::No
+        ) -> expected_t<std::vector<RepodataSnapshotEntry>>;
+
+        /**
+         * Write the given repos in a single snapshot file.
+         *
+         * The @p metadata entries describe the repos, in the same order.
+         */
+        auto native_serialize_repos(
+            const std::vector<RepoInfo>& repos,
+            const fs::u8path& path,
+            const std::vector<RepodataSnapshotEntry>& metadata,
+            PipAsPythonDependency add = PipAsPythonDependency::No
+        ) -> expected_t<void>;
+
         [[nodiscard]] auto installed_repo() const -> std::optional<RepoInfo>;
 
         void set_installed_repo(RepoInfo repo);
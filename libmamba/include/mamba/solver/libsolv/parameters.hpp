@@ -83,5 +83,24 @@ namespace mamba::solver::libsolv
 
     void to_json(nlohmann::json& j, const RepodataOrigin& m);
     void from_json(const nlohmann::json& j, RepodataOrigin& p);
+
+    /**
+     * Metadata of a repository serialized in a multi-repository snapshot.
+     *
+     * On top of the index origin, the snapshot records what is set on the repository when it is
+     * added to the database, so that it can be restored as is.
+     */
+    struct RepodataSnapshotEntry
+    {
+        RepodataOrigin origin = {};
+        std::string channel_id = {};
+        Priorities priorities = {};
+    };
+
+    auto operator==(const RepodataSnapshotEntry& lhs, const RepodataSnapshotEntry& rhs) -> bool;
+    auto operator!=(const RepodataSnapshotEntry& lhs, const RepodataSnapshotEntry& rhs) -> bool;
+
+    void to_json(nlohmann::json& j, const RepodataSnapshotEntry& m);
+    void from_json(const nlohmann::json& j, RepodataSnapshotEntry& p);
 }
 #endif
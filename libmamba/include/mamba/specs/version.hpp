@@ -191,11 +191,23 @@ namespace mamba::specs
          */
         [[nodiscard]] auto compatible_with(const Version& older, std::size_t level) const -> bool;
 
+        /**
+         * A byte string that compares (as with ``std::memcmp``) in the same order as versions.
+         *
+         * The key is computed upon construction and is what the comparison operators use, so
+         * that sorting versions does not need to walk through their parts and atoms.
+         */
+        [[nodiscard]] auto key() const noexcept -> std::string_view;
+
     private:
 
+        // The key of the default version ``0.0``, with its leading null character
+        static constexpr std::string_view default_key = { "\x00\x7F\x7F", 3 };
+
         // Stored in decreasing size order for performance
         CommonVersion m_version = {};
         CommonVersion m_local = {};
+        std::string m_key = std::string(default_key);
         std::size_t m_epoch = 0;
     };
 
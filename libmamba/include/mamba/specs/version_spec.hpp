@@ -9,6 +9,7 @@
 
 #include <array>
 #include <functional>
+#include <memory>
 #include <string_view>
 #include <variant>
 
@@ -20,6 +21,8 @@
 
 namespace mamba::specs
 {
+    class VersionSpecProgram;
+
     /**
      * A stateful unary boolean function on the Version space.
      */
@@ -142,6 +145,7 @@ namespace mamba::specs
         friend auto operator==(not_version_glob, not_version_glob) -> bool;
         friend auto operator==(const VersionPredicate& lhs, const VersionPredicate& rhs) -> bool;
         friend struct ::fmt::formatter<VersionPredicate>;
+        friend class VersionSpecProgram;
     };
 
     auto operator==(const VersionPredicate& lhs, const VersionPredicate& rhs) -> bool;
@@ -191,7 +195,7 @@ namespace mamba::specs
 
         /** Construct VersionSpec that match all versions. */
         VersionSpec() = default;
-        explicit VersionSpec(tree_type&& tree) noexcept;
+        explicit VersionSpec(tree_type&& tree);
 
         /**
          * Returns whether the VersionSpec is unconstrained.
@@ -225,6 +229,9 @@ namespace mamba::specs
 
         /**
          * True if the set described by the VersionSpec contains the given version.
+         *
+         * The expression is compiled upon construction into a flat program that merges
+         * version comparisons into ranges of ``Version::key``.
          */
         [[nodiscard]] auto contains(const Version& point) const -> bool;
 
@@ -233,6 +240,11 @@ namespace mamba::specs
          */
         [[nodiscard]] auto expression_size() const -> std::size_t;
 
+        /**
+         * The boolean expression tree of VersionPredicate.
+         */
+        [[nodiscard]] auto expression() const -> const tree_type&;
+
         [[nodiscard]] auto operator==(const VersionSpec& other) const -> bool
         {
             return m_tree == other.m_tree;
@@ -246,6 +258,8 @@ namespace mamba::specs
     private:
 
         tree_type m_tree;
+        /** Compiled from the tree, shared between copies. */
+        std::shared_ptr<const VersionSpecProgram> m_program;
 
         friend struct ::fmt::formatter<VersionSpec>;
     };
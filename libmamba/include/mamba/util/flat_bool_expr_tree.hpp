@@ -172,6 +172,14 @@ namespace mamba::util
         template <typename UnaryFunc>
         void infix_for_each(UnaryFunc&& func) const;
 
+        /**
+         * Visit the variables and operators in postfix order (operands before their operator).
+         *
+         * Nothing is visited for an empty tree.
+         */
+        template <typename UnaryFunc>
+        void postfix_for_each(UnaryFunc&& func) const;
+
         // TODO(C++20): replace by the `= default` implementation of `operator==`
         [[nodiscard]] auto operator==(const self_type& other) const -> bool
         {
@@ -641,5 +649,40 @@ namespace mamba::util
 
         m_tree.dfs_raw(tree_visitor, m_tree.root());
     }
+
+    template <typename V>
+    template <typename UnaryFunc>
+    void flat_bool_expr_tree<V>::postfix_for_each(UnaryFunc&& func) const
+    {
+        struct TreeVisitor
+        {
+            using idx_type = typename tree_type::idx_type;
+
+            void on_leaf(const tree_type& tree, idx_type idx)
+            {
+                m_func(tree.leaf(idx));
+            }
+
+            void on_branch_left_before(const tree_type&, idx_type, idx_type)
+            {
+            }
+
+            void on_branch_infix(const tree_type&, idx_type, idx_type, idx_type)
+            {
+            }
+
+            void on_branch_right_after(const tree_type& tree, idx_type branch_idx, idx_type)
+            {
+                m_func(tree.branch(branch_idx));
+            }
+
+            UnaryFunc m_func;
+        } tree_visitor{ std::forward<UnaryFunc>(func) };
+
+        if (!m_tree.empty())
+        {
+            m_tree.dfs_raw(tree_visitor, m_tree.root());
+        }
+    }
 }
 #endif
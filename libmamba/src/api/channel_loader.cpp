@@ -205,6 +205,11 @@ namespace mamba
                 database.add_repo_from_packages(packages, "packages");
             }
 
+            // Repodata of the subdirs downloaded first are parsed while the others download.
+            auto subdir_loader = SubdirDatabaseLoader(ctx);
+            const auto on_index_ready = [&subdir_loader](const SubdirIndexLoader& subdir)
+            { subdir_loader.prepare(subdir); };
+
             expected_t<void> download_res;
             if (SubdirIndexMonitor::can_monitor(ctx))
             {
@@ -218,7 +223,8 @@ namespace mamba
                     ctx.download_options(),
                     ctx.remote_fetch_params,
                     &check_monitor,
-                    &index_monitor
+                    &index_monitor,
+                    on_index_ready
                 );
             }
             else
@@ -229,7 +235,10 @@ namespace mamba
                     ctx.authentication_info(),
                     ctx.mirrors,
                     ctx.download_options(),
-                    ctx.remote_fetch_params
+                    ctx.remote_fetch_params,
+                    nullptr,
+                    nullptr,
+                    on_index_ready
                 );
             }
 
@@ -254,6 +263,9 @@ namespace mamba
             }
             std::string prev_channel;
             bool loading_failed = false;
+            auto loaded_indices = std::vector<std::size_t>();
+            auto loaded_subdirs = std::vector<const SubdirIndexLoader*>();
+            auto loaded_priorities = std::vector<solver::libsolv::Priorities>();
             for (std::size_t i = 0; i < subdirs.size(); ++i)
             {
                 auto& subdir = subdirs[i];
@@ -268,10 +280,39 @@ namespace mamba
                     }
                     continue;
                 }
+                loaded_indices.push_back(i);
+                loaded_subdirs.push_back(&subdir);
+                loaded_priorities.push_back(priorities[i]);
+            }
+
+            auto repos = std::vector<expected_t<solver::libsolv::RepoInfo>>();
+            auto snapshot = load_subdirs_from_snapshot(
+                ctx,
+                database,
+                loaded_subdirs,
+                loaded_priorities
+            );
+            if (snapshot.has_value())
+            {
+                repos.assign(snapshot->cbegin(), snapshot->cend());
+            }
+            else
+            {
+                repos = subdir_loader.load(database, loaded_subdirs);
+            }
 
-                load_subdir_in_database(ctx, database, subdir)
-                    .transform([&](solver::libsolv::RepoInfo&& repo)
-                               { database.set_repo_priority(repo, priorities[i]); })
+            auto loaded_repos = std::vector<solver::libsolv::RepoInfo>();
+            for (std::size_t i = 0; i < repos.size(); ++i)
+            {
+                auto& subdir = subdirs[loaded_indices[i]];
+                std::move(repos[i])
+                    .transform(
+                        [&](solver::libsolv::RepoInfo&& repo)
+                        {
+                            database.set_repo_priority(repo, loaded_priorities[i]);
+                            loaded_repos.push_back(repo);
+                        }
+                    )
                     .or_else(
                         [&](const auto&)
                         {
@@ -296,6 +337,17 @@ namespace mamba
                     );
             }
 
+            if (!snapshot.has_value() && (loaded_repos.size() == loaded_subdirs.size()))
+            {
+                write_subdirs_snapshot(
+                    ctx,
+                    database,
+                    loaded_subdirs,
+                    loaded_repos,
+                    loaded_priorities
+                );
+            }
+
             if (loading_failed)
             {
                 if (!ctx.offline && !is_retry)
@@ -1751,6 +1751,17 @@ namespace mamba
                         host max concurrency minus the value, zero (default) is the host max
                         concurrency value.)")));
 
+        insert(Configurable("stream_extract", &m_context.stream_extract)
+                   .group("Extract, Link & Install")
+                   .set_rc_configurable()
+                   .set_env_var_names()
+                   .description("Extract .conda packages while they are downloaded")
+                   .long_description(unindent(R"(
+                        Extract .conda packages while they are being downloaded rather than
+                        re-reading them from the package cache afterwards.
+                        The extracted directory is only published once the checksum of the
+                        downloaded package has been validated.)")));
+
         insert(Configurable("allow_softlinks", &m_context.link_params.allow_softlinks)
                    .group("Extract, Link & Install")
                    .set_rc_configurable()
@@ -1923,6 +1934,35 @@ namespace mamba
                             Set the log backtrace size. It will replay the n last
                             logs if an error is thrown during the execution.)")));
 
+        insert(Configurable("log_async_queue_size", &m_context.output_params.log_async_queue_size)
+                   .group("Output, Prompt and Flow Control")
+                   .set_rc_configurable()
+                   .set_env_var_names()
+                   .description("Set the size of the asynchronous log queue")
+                   .long_description(unindent(R"(
+                            Write the logs from a dedicated thread, through a queue
+                            of this size, instead of from the threads logging them.
+                            The logs are written synchronously if it is 0.)")));
+
+        insert(Configurable("log_async_overflow", &m_context.output_params.log_async_overflow)
+                   .group("Output, Prompt and Flow Control")
+                   .set_rc_configurable()
+                   .set_env_var_names()
+                   .description("Set what to do when the asynchronous log queue is full")
+                   .long_description(unindent(R"(
+                            Set what to do when the asynchronous log queue is full,
+                            either 'block' the logging threads until there is room,
+                            or 'drop_oldest' to discard the oldest queued logs.)")));
+
+        insert(Configurable("timings_json", &m_context.output_params.timings_json)
+                   .group("Output, Prompt and Flow Control")
+                   .set_env_var_names({ "MAMBA_TIMINGS" })
+                   .description("Write the timings of the command to a JSON file")
+                   .long_description(unindent(R"(
+                            Record the wall and CPU times spent in the phases of the
+                            command, such as downloading, parsing, solving, or linking,
+                            with some counters, and write them to this JSON file.)")));
+
         insert(Configurable("log_pattern", &m_context.output_params.log_pattern)
                    .group("Output, Prompt and Flow Control")
                    .set_rc_configurable()
@@ -2260,6 +2300,11 @@ namespace mamba
         }
 
         m_context.set_log_level(m_context.output_params.logging_level);
+        m_context.set_async_logging(
+            m_context.output_params.log_async_queue_size,
+            m_context.output_params.log_async_overflow
+        );
+        m_context.timings.enable(!m_context.output_params.timings_json.empty());
 
         spdlog::apply_all([&](std::shared_ptr<spdlog::logger> l) { l->flush(); });
         spdlog::flush_on(spdlog::level::off);
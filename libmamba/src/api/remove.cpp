@@ -196,6 +196,7 @@ namespace mamba
                     /* .strict_repo_priority= */ ctx.channel_priority == ChannelPriority::Strict,
                 };
 
+                auto solve_timer = ctx.timings.time("solve");
                 auto outcome = solver::libsolv::Solver()
                                    .solve(
                                        database,
@@ -205,6 +206,7 @@ namespace mamba
                                            : solver::libsolv::MatchSpecParser::Mixed
                                    )
                                    .value();
+                solve_timer.stop();
                 if (auto* unsolvable = std::get_if<solver::libsolv::UnSolvable>(&outcome))
                 {
                     if (ctx.output_params.json)
@@ -201,6 +201,7 @@ namespace mamba
             // Console stream prints on destruction
         }
 
+        auto solve_timer = ctx.timings.time("solve");
         auto outcome = solver::libsolv::Solver()
                            .solve(
                                db,
@@ -210,11 +211,12 @@ namespace mamba
                                    : solver::libsolv::MatchSpecParser::Mixed
                            )
                            .value();
+        solve_timer.stop();
         if (auto* unsolvable = std::get_if<solver::libsolv::UnSolvable>(&outcome))
         {
             unsolvable->explain_problems_to(
                 db,
-                LOG_ERROR,
+                MessageLogger(log_level::err).stream(),
                 {
                     /* .unavailable= */ ctx.graphics_params.palette.failure,
                     /* .available= */ ctx.graphics_params.palette.success,
@@ -190,7 +190,7 @@ namespace mamba
             fmt::join(deps, ", ")
         );
 
-        fmt::print(LOG_INFO, "Calling: {}", fmt::join(command, " "));
+        LOG_INFO_FMT("Calling: {}", fmt::join(command, " "));
 
         auto [status, ec] = reproc::run(wrapped_command, options);
         assert_reproc_success(options, status, ec);
@@ -0,0 +1,281 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+#include "./async_log_sink.hpp"
+
+namespace mamba
+{
+    /************************************
+     *  Implementation of AsyncLogQueue  *
+     ************************************/
+
+    AsyncLogQueue::AsyncLogQueue(std::size_t capacity, LogOverflowPolicy policy)
+        : m_slots(rounded_capacity(capacity))
+        , m_mask(m_slots.size() - 1)
+        , m_policy(policy)
+    {
+        for (std::size_t i = 0; i < m_slots.size(); ++i)
+        {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        m_writer = std::thread([this] { run_writer(); });
+    }
+
+    AsyncLogQueue::~AsyncLogQueue()
+    {
+        close();
+    }
+
+    void AsyncLogQueue::push(spdlog::sinks::sink& sink, const spdlog::details::log_msg& msg)
+    {
+        m_pushing.fetch_add(1);
+        if (!m_open.load())
+        {
+            m_pushing.fetch_sub(1);
+            const auto lock = lock_writes();
+            sink.log(msg);
+            return;
+        }
+
+        while (!try_push(sink, msg))
+        {
+            if (m_policy == LogOverflowPolicy::DropOldest)
+            {
+                if (try_pop(false))
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            else
+            {
+                // Wait for the writing thread to make some room
+                const auto popped = m_popped.load(std::memory_order_acquire);
+                if (!try_push(sink, msg))
+                {
+                    m_popped.wait(popped, std::memory_order_acquire);
+                    continue;
+                }
+                break;
+            }
+        }
+
+        m_pushed.fetch_add(1, std::memory_order_release);
+        m_pushed.notify_one();
+        m_pushing.fetch_sub(1);
+    }
+
+    void AsyncLogQueue::flush()
+    {
+        // Every position claimed so far is eventually popped
+        const auto target = m_enqueue_pos.load(std::memory_order_acquire);
+        for (auto popped = m_popped.load(std::memory_order_acquire); popped < target;
+             popped = m_popped.load(std::memory_order_acquire))
+        {
+            m_popped.wait(popped, std::memory_order_acquire);
+        }
+    }
+
+    void AsyncLogQueue::close()
+    {
+        if (!m_open.exchange(false))
+        {
+            return;
+        }
+
+        // The messages being pushed are still queued, and written by the writing thread.
+        while (m_pushing.load() > 0)
+        {
+            std::this_thread::yield();
+        }
+
+        m_stopping.store(true);
+        m_pushed.fetch_add(1, std::memory_order_release);
+        m_pushed.notify_one();
+        m_writer.join();
+    }
+
+    auto AsyncLogQueue::lock_writes() -> std::unique_lock<std::mutex>
+    {
+        return std::unique_lock(m_write_mutex);
+    }
+
+    auto AsyncLogQueue::rounded_capacity(std::size_t capacity) -> std::size_t
+    {
+        return std::bit_ceil(std::max(capacity, std::size_t(2)));
+    }
+
+    auto AsyncLogQueue::capacity() const -> std::size_t
+    {
+        return m_slots.size();
+    }
+
+    auto AsyncLogQueue::policy() const -> LogOverflowPolicy
+    {
+        return m_policy;
+    }
+
+    auto AsyncLogQueue::dropped() const -> std::size_t
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    auto AsyncLogQueue::try_push(spdlog::sinks::sink& sink, const spdlog::details::log_msg& msg)
+        -> bool
+    {
+        auto pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            auto& slot = m_slots[pos & m_mask];
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(sequence)
+                              - static_cast<std::intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    slot.sink = &sink;
+                    slot.msg = spdlog::details::log_msg_buffer(msg);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                // The slot still holds the message from the previous round
+                return false;
+            }
+            else
+            {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    auto AsyncLogQueue::try_pop(bool write) -> bool
+    {
+        auto pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            auto& slot = m_slots[pos & m_mask];
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(sequence)
+                              - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    if (write)
+                    {
+                        assert(slot.sink != nullptr);
+                        const auto lock = lock_writes();
+                        slot.sink->log(slot.msg);
+                    }
+                    slot.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                    m_popped.fetch_add(1, std::memory_order_release);
+                    m_popped.notify_all();
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                // Empty, or the message is still being written into the slot
+                return false;
+            }
+            else
+            {
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void AsyncLogQueue::run_writer()
+    {
+        // Waking up the writing thread costs a system call to the logging threads.
+        static constexpr std::size_t max_idle_spins = 64;
+
+        std::size_t idle_spins = 0;
+        while (true)
+        {
+            const auto pushed = m_pushed.load(std::memory_order_acquire);
+            if (try_pop(true))
+            {
+                idle_spins = 0;
+                continue;
+            }
+            // No thread is pushing anymore, so the queue is empty
+            if (m_stopping.load())
+            {
+                return;
+            }
+            if (++idle_spins < max_idle_spins)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            m_pushed.wait(pushed, std::memory_order_acquire);
+        }
+    }
+
+    /***********************************
+     *  Implementation of AsyncLogSink  *
+     ***********************************/
+
+    AsyncLogSink::AsyncLogSink(
+        std::shared_ptr<AsyncLogQueue> queue,
+        std::shared_ptr<spdlog::sinks::sink> destination
+    )
+        : m_queue(std::move(queue))
+        , m_sink(std::move(destination))
+    {
+        assert(m_queue != nullptr);
+        assert(m_sink != nullptr);
+    }
+
+    AsyncLogSink::~AsyncLogSink()
+    {
+        m_queue->flush();
+    }
+
+    void AsyncLogSink::log(const spdlog::details::log_msg& msg)
+    {
+        m_queue->push(*m_sink, msg);
+    }
+
+    void AsyncLogSink::flush()
+    {
+        m_queue->flush();
+        m_sink->flush();
+    }
+
+    void AsyncLogSink::set_pattern(const std::string& pattern)
+    {
+        // Not while the writing thread is logging to the wrapped sink
+        const auto lock = m_queue->lock_writes();
+        m_sink->set_pattern(pattern);
+    }
+
+    void AsyncLogSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter)
+    {
+        const auto lock = m_queue->lock_writes();
+        m_sink->set_formatter(std::move(sink_formatter));
+    }
+
+    auto AsyncLogSink::wrapped() const -> const std::shared_ptr<spdlog::sinks::sink>&
+    {
+        return m_sink;
+    }
+
+    auto AsyncLogSink::queue() const -> const std::shared_ptr<AsyncLogQueue>&
+    {
+        return m_queue;
+    }
+}
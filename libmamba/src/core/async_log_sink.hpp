@@ -0,0 +1,146 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_CORE_ASYNC_LOG_SINK_HPP
+#define MAMBA_CORE_ASYNC_LOG_SINK_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <spdlog/details/log_msg_buffer.h>
+#include <spdlog/sinks/sink.h>
+
+#include "mamba/core/context.hpp"
+
+namespace mamba
+{
+    /**
+     * A bounded queue of log messages written to their sinks by a dedicated thread.
+     *
+     * The queue is a fixed-size lock-free ring buffer shared by all the sinks of the loggers so
+     * that messages are written in the order they were logged, which in particular preserves
+     * the order of the messages of every thread.
+     * When the queue is full, either the logging thread waits, or the oldest message is dropped.
+     */
+    class AsyncLogQueue
+    {
+    public:
+
+        /** Start the writing thread, the capacity is rounded up to a power of two. */
+        AsyncLogQueue(std::size_t capacity, LogOverflowPolicy policy);
+
+        /** Close the queue, see ``close``. */
+        ~AsyncLogQueue();
+
+        AsyncLogQueue(const AsyncLogQueue&) = delete;
+        AsyncLogQueue& operator=(const AsyncLogQueue&) = delete;
+
+        /**
+         * Queue a message to be logged by ``sink``.
+         *
+         * Once the queue is closed, the message is logged synchronously.
+         */
+        void push(spdlog::sinks::sink& sink, const spdlog::details::log_msg& msg);
+
+        /** Wait until all the messages queued before this call are written. */
+        void flush();
+
+        /**
+         * Write the remaining messages and stop the writing thread.
+         *
+         * The sinks of the queued messages must still be alive.
+         */
+        void close();
+
+        /**
+         * Prevent the messages from being written while the lock is held.
+         *
+         * The sinks are not required to support changing their format while logging.
+         */
+        [[nodiscard]] auto lock_writes() -> std::unique_lock<std::mutex>;
+
+        /** The capacity of a queue created for ``capacity`` messages. */
+        [[nodiscard]] static auto rounded_capacity(std::size_t capacity) -> std::size_t;
+
+        [[nodiscard]] auto capacity() const -> std::size_t;
+        [[nodiscard]] auto policy() const -> LogOverflowPolicy;
+
+        /** The number of messages dropped because the queue was full. */
+        [[nodiscard]] auto dropped() const -> std::size_t;
+
+    private:
+
+        struct Slot
+        {
+            /** The position of the message stored, plus one once it is written. */
+            std::atomic<std::size_t> sequence = 0;
+            spdlog::sinks::sink* sink = nullptr;
+            spdlog::details::log_msg_buffer msg = {};
+        };
+
+        std::vector<Slot> m_slots;
+        std::size_t m_mask;
+        LogOverflowPolicy m_policy;
+
+        alignas(64) std::atomic<std::size_t> m_enqueue_pos = 0;
+        alignas(64) std::atomic<std::size_t> m_dequeue_pos = 0;
+        /** Completed pushes, waited on by the writing thread. */
+        alignas(64) std::atomic<std::uint32_t> m_pushed = 0;
+        /** Completed pops (written or dropped), waited on by ``flush`` and blocked pushes. */
+        alignas(64) std::atomic<std::size_t> m_popped = 0;
+        std::atomic<std::size_t> m_dropped = 0;
+        /** The threads currently in ``push``, waited on by ``close``. */
+        std::atomic<std::size_t> m_pushing = 0;
+        std::atomic<bool> m_open = true;
+        std::atomic<bool> m_stopping = false;
+
+        /** Held while writing a message to a sink. */
+        std::mutex m_write_mutex;
+        std::thread m_writer;
+
+        [[nodiscard]] auto try_push(spdlog::sinks::sink& sink, const spdlog::details::log_msg& msg)
+            -> bool;
+
+        /** Pop the oldest message, writing it or not, and return whether there was one. */
+        auto try_pop(bool write) -> bool;
+
+        void run_writer();
+    };
+
+    /** A sink queuing its messages to be written by another sink in an ``AsyncLogQueue``. */
+    class AsyncLogSink : public spdlog::sinks::sink
+    {
+    public:
+
+        AsyncLogSink(
+            std::shared_ptr<AsyncLogQueue> queue,
+            std::shared_ptr<spdlog::sinks::sink> destination
+        );
+
+        /** Flush the queue before the wrapped sink can be destroyed. */
+        ~AsyncLogSink() override;
+
+        void log(const spdlog::details::log_msg& msg) override;
+        void flush() override;
+        void set_pattern(const std::string& pattern) override;
+        void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+
+        [[nodiscard]] auto wrapped() const -> const std::shared_ptr<spdlog::sinks::sink>&;
+        [[nodiscard]] auto queue() const -> const std::shared_ptr<AsyncLogQueue>&;
+
+    private:
+
+        std::shared_ptr<AsyncLogQueue> m_queue;
+        std::shared_ptr<spdlog::sinks::sink> m_sink;
+    };
+}
+#endif
@@ -25,6 +25,8 @@
 #include "mamba/util/string.hpp"
 #include "mamba/util/url_manip.hpp"
 
+#include "./async_log_sink.hpp"
+
 namespace mamba
 {
 
@@ -166,7 +168,19 @@ namespace mamba
             std::make_shared<Logger>("libmamba", output_params.log_pattern, "\n"),
             logger_kind::default_logger
         );
-        MainExecutor::instance().on_close(tasksync.synchronized([&] { main_logger()->flush(); }));
+        MainExecutor::instance().on_close(
+            tasksync.synchronized(
+                [&]
+                {
+                    main_logger()->flush();
+                    // Write the remaining messages and stop the asynchronous logging thread
+                    if (m_log_queue)
+                    {
+                        m_log_queue->close();
+                    }
+                }
+            )
+        );
 
         loggers.emplace_back(std::make_shared<Logger>("libcurl", output_params.log_pattern, ""));
 
@@ -261,6 +275,48 @@ namespace mamba
         spdlog::set_level(convert_log_level(level));
     }
 
+    void Context::set_async_logging(std::size_t queue_size, LogOverflowPolicy policy)
+    {
+        if ((queue_size == 0) && (m_log_queue == nullptr))
+        {
+            return;
+        }
+        if ((queue_size > 0) && (m_log_queue != nullptr)
+            && (m_log_queue->capacity() == AsyncLogQueue::rounded_capacity(queue_size))
+            && (m_log_queue->policy() == policy))
+        {
+            return;
+        }
+
+        // The replaced sinks log synchronously once their queue is closed
+        if (m_log_queue)
+        {
+            m_log_queue->close();
+        }
+        auto queue = std::shared_ptr<AsyncLogQueue>();
+        if (queue_size > 0)
+        {
+            // Shared by all loggers to keep the order of their messages
+            queue = std::make_shared<AsyncLogQueue>(queue_size, policy);
+        }
+
+        for (auto& scoped_logger : loggers)
+        {
+            for (auto& sink : scoped_logger.logger()->sinks())
+            {
+                if (auto async_sink = std::dynamic_pointer_cast<AsyncLogSink>(sink))
+                {
+                    sink = async_sink->wrapped();
+                }
+                if (queue)
+                {
+                    sink = std::make_shared<AsyncLogSink>(queue, sink);
+                }
+            }
+        }
+        m_log_queue = std::move(queue);
+    }
+
     std::vector<std::string> Context::platforms() const
     {
         return { platform, "noarch" };
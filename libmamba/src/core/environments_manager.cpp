@@ -13,6 +13,7 @@
 #include "mamba/core/output.hpp"
 #include "mamba/core/util.hpp"
 #include "mamba/util/environment.hpp"
+#include "mamba/util/string.hpp"
 
 namespace mamba
 {
@@ -118,10 +119,13 @@ namespace mamba
             if (fs::exists(meta_dir) && fs::is_directory(meta_dir))
             {
                 std::size_t count = 0;
-                for (auto& _ : fs::directory_iterator(meta_dir))
+                for (auto& entry : fs::directory_iterator(meta_dir))
                 {
-                    (void) _;
-                    ++count;
+                    // Indexes and caches written by mamba are not records
+                    if (!util::starts_with(entry.path().filename().string(), ".mamba-"))
+                    {
+                        ++count;
+                    }
                 }
                 if (count > 1)
                 {
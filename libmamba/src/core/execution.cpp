@@ -1,11 +1,211 @@
+#include <algorithm>
+
 #include "mamba/core/execution.hpp"
 #include "mamba/core/invoke.hpp"
 #include "mamba/core/output.hpp"
 
 namespace mamba
 {
+    /**************
+     * ThreadPool *
+     **************/
+
+    namespace
+    {
+        // Identifies the pool and queue of the worker running on the current thread, if any.
+        thread_local const ThreadPool* current_pool = nullptr;
+        thread_local std::size_t current_queue = 0;
+    }
+
+    ThreadPool::ThreadPool(std::size_t thread_count)
+    {
+        thread_count = std::max<std::size_t>(thread_count, 1);
+        m_queues.reserve(thread_count);
+        for (std::size_t i = 0; i < thread_count; ++i)
+        {
+            m_queues.push_back(std::make_unique<WorkQueue>());
+        }
+        m_workers.reserve(thread_count);
+        for (std::size_t i = 0; i < thread_count; ++i)
+        {
+            m_workers.emplace_back([this, i] { run_worker(i); });
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        join();
+    }
+
+    auto ThreadPool::size() const noexcept -> std::size_t
+    {
+        return m_queues.size();
+    }
+
+    auto ThreadPool::post(task_type task) -> bool
+    {
+        const bool from_worker = (current_pool == this);
+        const std::size_t index = from_worker ? current_queue : m_next_queue++ % m_queues.size();
+
+        std::unique_lock state_lock{ m_state_mutex };
+        if (m_stopping && !from_worker)
+        {
+            return false;
+        }
+        {
+            auto& queue = *m_queues[index];
+            std::scoped_lock queue_lock{ queue.mutex };
+            queue.tasks.push_back(std::move(task));
+        }
+        state_lock.unlock();
+
+        m_state_cv.notify_one();
+        return true;
+    }
+
+    void ThreadPool::stop()
+    {
+        {
+            std::scoped_lock lock{ m_state_mutex };
+            m_stopping = true;
+        }
+        m_state_cv.notify_all();
+    }
+
+    void ThreadPool::join()
+    {
+        stop();
+        for (auto& worker : m_workers)
+        {
+            if (worker.joinable())
+            {
+                worker.join();
+            }
+        }
+    }
+
+    auto ThreadPool::try_pop(std::size_t index) -> task_type
+    {
+        // Own queue first, newest task to benefit from cache locality.
+        {
+            auto& queue = *m_queues[index];
+            std::scoped_lock lock{ queue.mutex };
+            if (!queue.tasks.empty())
+            {
+                task_type task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+                return task;
+            }
+        }
+        // Then steal the oldest task of another queue.
+        for (std::size_t offset = 1; offset < m_queues.size(); ++offset)
+        {
+            auto& queue = *m_queues[(index + offset) % m_queues.size()];
+            std::scoped_lock lock{ queue.mutex };
+            if (!queue.tasks.empty())
+            {
+                task_type task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                return task;
+            }
+        }
+        return {};
+    }
+
+    // Must be called with `m_state_mutex` locked, under which tasks are pushed.
+    auto ThreadPool::has_queued_tasks() -> bool
+    {
+        return std::any_of(
+            m_queues.begin(),
+            m_queues.end(),
+            [](const auto& queue)
+            {
+                std::scoped_lock lock{ queue->mutex };
+                return !queue->tasks.empty();
+            }
+        );
+    }
+
+    void ThreadPool::run_worker(std::size_t index)
+    {
+        current_pool = this;
+        current_queue = index;
+
+        while (true)
+        {
+            if (task_type task = try_pop(index))
+            {
+                const auto result = safe_invoke(std::move(task));
+                if (!result)
+                {
+                    LOG_ERROR << "thread pool task failed (ignored): " << result.error().what();
+                }
+                continue;
+            }
+
+            std::unique_lock lock{ m_state_mutex };
+            // Tasks are pushed with `m_state_mutex` locked, so none can be missed between the
+            // failed pop and the wait. A task popped by another worker no longer wakes this one.
+            m_state_cv.wait(lock, [&] { return m_stopping || has_queued_tasks(); });
+            if (m_stopping && !has_queued_tasks())
+            {
+                break;
+            }
+        }
+
+        current_pool = nullptr;
+    }
+
+    /****************
+     * MainExecutor *
+     ****************/
+
     // NOTE: see singleton.cpp for other functions and why they are located there instead of here
 
+    auto MainExecutor::pool_size() -> std::size_t
+    {
+        std::scoped_lock lock{ pool_mutex };
+        return pool ? pool->size() : std::max<std::size_t>(requested_pool_size, 1);
+    }
+
+    void MainExecutor::set_pool_size(std::size_t size)
+    {
+        if (size == 0)
+        {
+            size = std::thread::hardware_concurrency();
+        }
+        size = std::max<std::size_t>(size, 1);
+
+        std::scoped_lock lock{ pool_mutex };
+        requested_pool_size = size;
+        if (pool && pool->size() != size)
+        {
+            // The previous pool might be running tasks, it is joined when closing.
+            pool->stop();
+            retired_pools.push_back(std::move(pool));
+        }
+    }
+
+    void MainExecutor::join_pools()
+    {
+        std::vector<std::unique_ptr<ThreadPool>> pools;
+        {
+            // Pools are joined outside of the lock so that running tasks trying to submit
+            // new tasks are not blocked.
+            std::scoped_lock lock{ pool_mutex };
+            pools = std::move(retired_pools);
+            retired_pools.clear();
+            if (pool)
+            {
+                pools.push_back(std::move(pool));
+            }
+        }
+        for (auto& p : pools)
+        {
+            p->join();
+        }
+    }
+
     void MainExecutor::invoke_close_handlers()
     {
         std::scoped_lock lock{ handlers_mutex };
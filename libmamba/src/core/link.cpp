@@ -4,21 +4,44 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <optional>
 #include <regex>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <sys/clonefile.h>
+#endif
+
 #include <reproc++/reproc.hpp>
 #include <reproc++/run.hpp>
 
 #include "./link.hpp"
+#include "mamba/core/execution.hpp"
 #include "mamba/core/menuinst.hpp"
 #include "mamba/core/output.hpp"
 #include "mamba/specs/match_spec.hpp"
 #include "mamba/util/build.hpp"
+#include "mamba/util/cryptography.hpp"
+#include "mamba/util/encoding.hpp"
 #include "mamba/util/environment.hpp"
+#include "mamba/util/random.hpp"
 #include "mamba/util/string.hpp"
 #include "mamba/validation/tools.hpp"
 
@@ -123,6 +146,381 @@ namespace mamba
         }
     }
 
+    /*************************************
+     *  Implementation of PrefixReplacer  *
+     *************************************/
+
+    PrefixReplacer::PrefixReplacer(
+        std::string placeholder,
+        std::string new_prefix,
+        FileMode mode,
+        sink_type sink
+    )
+        : m_placeholder(std::move(placeholder))
+        , m_new_prefix(std::move(new_prefix))
+        , m_sink(std::move(sink))
+        , m_padding_size(
+              std::max(m_placeholder.size(), m_new_prefix.size()) - m_new_prefix.size()
+          )
+        , m_mode(mode)
+        , m_shebang_state(
+              (mode != FileMode::BINARY && !util::on_win) ? ShebangState::Unknown
+                                                          : ShebangState::Done
+          )
+    {
+    }
+
+    void PrefixReplacer::feed(std::string_view data)
+    {
+        m_pending.append(data);
+        // The end of the data could be the beginning of a placeholder
+        process(m_placeholder.empty() ? 0 : m_placeholder.size() - 1);
+    }
+
+    void PrefixReplacer::finish()
+    {
+        process(0);
+        if (m_pending_padding > 0)
+        {
+            // The last null terminated string reaches the end of the data
+            write(std::string(std::exchange(m_pending_padding, 0), '\0'));
+        }
+        write_shebang();
+    }
+
+    auto PrefixReplacer::replaced() const -> bool
+    {
+        return m_replaced;
+    }
+
+    void PrefixReplacer::process(std::size_t keep)
+    {
+        const auto data = std::string_view(m_pending);
+        std::size_t start = 0;
+        if (!m_placeholder.empty())
+        {
+            // The first character is searched with memchr, which is vectorized in libc.
+            for (auto pos = data.find(m_placeholder); pos != std::string_view::npos;
+                 pos = data.find(m_placeholder, start))
+            {
+                write_binary(data.substr(start, pos - start));
+                write(m_new_prefix);
+                if (m_mode == FileMode::BINARY)
+                {
+                    m_pending_padding += m_padding_size;
+                }
+                m_replaced = true;
+                start = pos + m_placeholder.size();
+            }
+        }
+        const auto end = (data.size() > start + keep) ? data.size() - keep : start;
+        write_binary(data.substr(start, end - start));
+        m_pending.erase(0, end);
+    }
+
+    void PrefixReplacer::write_binary(std::string_view data)
+    {
+        if (m_pending_padding == 0)
+        {
+            write(data);
+            return;
+        }
+        // The padding goes at the end of the null terminated string that had replacements
+        const auto null_pos = data.find('\0');
+        if (null_pos == std::string_view::npos)
+        {
+            write(data);
+            return;
+        }
+        write(data.substr(0, null_pos));
+        write(std::string(std::exchange(m_pending_padding, 0), '\0'));
+        write(data.substr(null_pos));
+    }
+
+    void PrefixReplacer::write(std::string_view data)
+    {
+        if (m_shebang_state == ShebangState::Done)
+        {
+            if (!data.empty())
+            {
+                m_sink(data);
+            }
+            return;
+        }
+
+        // Only the first line is buffered, and only if it is a shebang
+        m_shebang.append(data);
+        if (m_shebang_state == ShebangState::Unknown && m_shebang.size() >= 2)
+        {
+            m_shebang_state = util::starts_with(m_shebang, "#!") ? ShebangState::Reading
+                                                                 : ShebangState::Done;
+        }
+        if ((m_shebang_state == ShebangState::Done)
+            || (m_shebang.find('\n') != std::string::npos))
+        {
+            write_shebang();
+        }
+    }
+
+    void PrefixReplacer::write_shebang()
+    {
+        if (m_shebang_state == ShebangState::Reading)
+        {
+            // We need to check the first line for a shebang and replace it if it's too long
+            const auto end_of_line = m_shebang.find('\n');
+            const auto first_line = m_shebang.substr(0, end_of_line);
+            if (first_line.size() > MAX_SHEBANG_LENGTH)
+            {
+                m_shebang.replace(0, end_of_line, replace_long_shebang(first_line));
+            }
+        }
+        m_shebang_state = ShebangState::Done;
+        if (!m_shebang.empty())
+        {
+            m_sink(m_shebang);
+            m_shebang.clear();
+        }
+    }
+
+    auto copy_with_prefix_replacement(
+        const fs::u8path& src,
+        const fs::u8path& dst,
+        const std::string& placeholder,
+        const std::string& new_prefix,
+        FileMode mode
+    ) -> std::pair<std::string, bool>
+    {
+        static constexpr std::size_t chunk_size = 1 << 16;
+
+        std::ifstream in = open_ifstream(src, std::ios::in | std::ios::binary);
+        std::ofstream out = open_ofstream(dst, std::ios::out | std::ios::binary);
+
+        auto digester = util::Sha256Digester();
+        digester.digest_start();
+        auto replacer = PrefixReplacer(
+            placeholder,
+            new_prefix,
+            mode,
+            [&](std::string_view data)
+            {
+                out.write(data.data(), static_cast<std::streamsize>(data.size()));
+                const auto* bytes = reinterpret_cast<const std::byte*>(data.data());
+                digester.digest_update(bytes, data.size());
+            }
+        );
+
+        auto buffer = std::string(chunk_size, '\0');
+        const auto buffer_size = static_cast<std::streamsize>(buffer.size());
+        while (in.read(buffer.data(), buffer_size) || in.gcount() > 0)
+        {
+            replacer.feed(std::string_view(buffer.data(), static_cast<std::size_t>(in.gcount())));
+        }
+        replacer.finish();
+        out.close();
+        if (out.fail())
+        {
+            throw std::runtime_error(util::concat("Could not write file ", dst.string()));
+        }
+
+        auto hash = std::array<std::byte, util::Sha256Digester::bytes_size>();
+        digester.digest_finalize_to(hash.data());
+        return { util::bytes_to_hex_str(hash.data(), hash.data() + hash.size()),
+                 replacer.replaced() };
+    }
+
+    /**************************************
+     *  Implementation of link strategies  *
+     **************************************/
+
+    namespace
+    {
+#if defined(__linux__)
+        // Opens ``src`` and creates ``dst`` with the same permissions, then fills ``dst`` with
+        // ``copy(in_fd, out_fd, size)``, removing it if anything fails.
+        template <typename Func>
+        void copy_file_descriptors(
+            const fs::u8path& src,
+            const fs::u8path& dst,
+            std::error_code& ec,
+            Func&& copy
+        )
+        {
+            ec.clear();
+            const int in = ::open(src.string().c_str(), O_RDONLY | O_CLOEXEC);
+            if (in < 0)
+            {
+                ec = std::error_code(errno, std::generic_category());
+                return;
+            }
+            struct ::stat st = {};
+            if (::fstat(in, &st) != 0)
+            {
+                ec = std::error_code(errno, std::generic_category());
+                ::close(in);
+                return;
+            }
+            const auto mode = st.st_mode & 07777;
+            const int out = ::open(
+                dst.string().c_str(),
+                O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                mode
+            );
+            if (out < 0)
+            {
+                ec = std::error_code(errno, std::generic_category());
+                ::close(in);
+                return;
+            }
+            // ``fchmod`` because the permissions given to ``open`` are restricted by the umask.
+            if (!copy(in, out, st.st_size) || (::fchmod(out, mode) != 0))
+            {
+                ec = std::error_code(errno, std::generic_category());
+            }
+            ::close(out);
+            ::close(in);
+            if (ec)
+            {
+                ::unlink(dst.string().c_str());
+            }
+        }
+#endif
+
+        auto link_strategy_name(LinkStrategy strategy) -> std::string_view
+        {
+            switch (strategy)
+            {
+                case LinkStrategy::Reflink:
+                    return "reflinked";
+                case LinkStrategy::Hardlink:
+                    return "hard-linked";
+                case LinkStrategy::Softlink:
+                    return "soft-linked";
+                case LinkStrategy::CopyFileRange:
+                    return "copied in kernel";
+                case LinkStrategy::Copy:
+                    return "copied";
+            }
+            return "";
+        }
+    }
+
+    void reflink_file(const fs::u8path& src, const fs::u8path& dst, std::error_code& ec)
+    {
+#if defined(__linux__) && defined(FICLONE)
+        copy_file_descriptors(
+            src,
+            dst,
+            ec,
+            [](int in, int out, off_t) { return ::ioctl(out, FICLONE, in) == 0; }
+        );
+#elif defined(__APPLE__)
+        ec.clear();
+        if (::clonefile(src.string().c_str(), dst.string().c_str(), 0) != 0)
+        {
+            ec = std::error_code(errno, std::generic_category());
+        }
+#else
+        static_cast<void>(src);
+        static_cast<void>(dst);
+        ec = std::make_error_code(std::errc::operation_not_supported);
+#endif
+    }
+
+    void copy_file_range_file(const fs::u8path& src, const fs::u8path& dst, std::error_code& ec)
+    {
+#if defined(__linux__) && defined(SYS_copy_file_range)
+        // Through ``syscall`` since the glibc wrapper is more recent than the kernel one.
+        copy_file_descriptors(
+            src,
+            dst,
+            ec,
+            [](int in, int out, off_t size)
+            {
+                while (size > 0)
+                {
+                    const auto copied = ::syscall(
+                        SYS_copy_file_range,
+                        in,
+                        nullptr,
+                        out,
+                        nullptr,
+                        static_cast<std::size_t>(size),
+                        0u
+                    );
+                    if (copied < 0)
+                    {
+                        return false;
+                    }
+                    if (copied == 0)
+                    {
+                        break;
+                    }
+                    size -= static_cast<off_t>(copied);
+                }
+                return true;
+            }
+        );
+#else
+        static_cast<void>(src);
+        static_cast<void>(dst);
+        ec = std::make_error_code(std::errc::operation_not_supported);
+#endif
+    }
+
+    auto probe_link_capabilities(const fs::u8path& source_file, const fs::u8path& target_dir)
+        -> LinkCapabilities
+    {
+        const auto probe = target_dir
+                           / util::concat(
+                               ".mamba-link-probe-",
+                               util::generate_random_alphanumeric_string(8)
+                           );
+        const auto try_create = [&](auto create)
+        {
+            std::error_code ec;
+            create(ec);
+            const bool created = !ec;
+            fs::remove(probe, ec);
+            return created;
+        };
+
+        auto capabilities = LinkCapabilities();
+        capabilities.reflink = try_create(  //
+            [&](std::error_code& ec) { reflink_file(source_file, probe, ec); }
+        );
+        capabilities.hardlink = try_create(  //
+            [&](std::error_code& ec) { fs::create_hard_link(source_file, probe, ec); }
+        );
+        capabilities.copy_file_range = try_create(  //
+            [&](std::error_code& ec) { copy_file_range_file(source_file, probe, ec); }
+        );
+        LOG_DEBUG << "Link capabilities to '" << target_dir.string()
+                  << "': reflink=" << capabilities.reflink
+                  << ", hardlink=" << capabilities.hardlink
+                  << ", copy_file_range=" << capabilities.copy_file_range;
+        return capabilities;
+    }
+
+    auto link_capabilities(
+        const fs::u8path& pkgs_dir,
+        const fs::u8path& prefix,
+        const fs::u8path& probe_file
+    ) -> LinkCapabilities
+    {
+        static std::mutex mutex;
+        static std::map<std::pair<std::string, std::string>, LinkCapabilities> cache;
+
+        auto key = std::make_pair(pkgs_dir.string(), prefix.string());
+        std::lock_guard<std::mutex> lock(mutex);
+        if (auto it = cache.find(key); it != cache.end())
+        {
+            return it->second;
+        }
+        const auto capabilities = probe_link_capabilities(probe_file, prefix);
+        cache.emplace(std::move(key), capabilities);
+        return capabilities;
+    }
+
     std::string python_shebang(const std::string& python_exe)
     {
         // Shebangs cannot be longer than 127 (or 512) characters and executable with
@@ -577,37 +975,48 @@ namespace mamba
         assert(m_context != nullptr);
     }
 
-    std::tuple<std::string, std::string>
-    LinkPackage::link_path(const PathData& path_data, bool noarch_python)
+    auto LinkPackage::link_target(const PathData& path_data, bool noarch_python) const -> fs::u8path
     {
-        std::string subtarget = path_data.path;
-        LOG_TRACE << "linking '" << subtarget << "'";
-        fs::u8path dst, rel_dst;
         if (noarch_python)
         {
-            rel_dst = get_python_noarch_target_path(
-                subtarget,
+            return get_python_noarch_target_path(
+                path_data.path,
                 m_context->python_params().site_packages_path
             );
-            dst = m_context->prefix_params().target_prefix / rel_dst;
-        }
-        else
-        {
-            rel_dst = subtarget;
-            dst = m_context->prefix_params().target_prefix / rel_dst;
         }
+        return path_data.path;
+    }
 
-        fs::u8path src = m_source / subtarget;
-        if (!fs::exists(dst.parent_path()))
+    auto LinkPackage::paths() -> const std::vector<PathData>&
+    {
+        if (!m_paths.has_value())
         {
-            fs::create_directories(dst.parent_path());
+            m_paths = read_paths(m_source);
         }
+        return m_paths.value();
+    }
+
+    auto LinkPackage::target_path(const PathData& path_data) const -> fs::u8path
+    {
+        return link_target(path_data, m_pkg_info.noarch == specs::NoArchType::Python);
+    }
+
+    std::tuple<std::string, std::string> LinkPackage::link_path(
+        const PathData& path_data,
+        const fs::u8path& rel_dst,
+        bool& clobbered
+    ) const
+    {
+        const std::string& subtarget = path_data.path;
+        LOG_TRACE_FMT("linking '{}'", subtarget);
+        const fs::u8path dst = m_context->prefix_params().target_prefix / rel_dst;
+        const fs::u8path src = m_source / subtarget;
 
         std::error_code ec;
         if (lexists(dst, ec) && !ec)
         {
             // Sometimes we might want to raise here ...
-            m_clobber_warnings.push_back(rel_dst.string());
+            clobbered = true;
 #ifdef _WIN32
             return std::make_tuple(std::string(validation::sha256sum(dst)), rel_dst.generic_string());
 #endif
@@ -618,9 +1027,6 @@ namespace mamba
             LOG_WARNING << "Could not check file existence: " << ec.message() << " (" << dst << ")";
         }
 
-#ifdef __APPLE__
-        bool binary_changed = false;
-#endif
         // std::string path_type = path_data["path_type"].get<std::string>();
         if (!path_data.prefix_placeholder.empty())
         {
@@ -629,41 +1035,16 @@ namespace mamba
             std::string new_prefix = m_context->prefix_params().relocate_prefix.string();
 #ifdef _WIN32
             util::replace_all(new_prefix, "\\", "/");
-#endif
-            LOG_TRACE << "Copying file & replace prefix " << src << " -> " << dst;
-            // TODO windows does something else here
 
-            std::string buffer;
-            if (path_data.file_mode != FileMode::BINARY)
+            // on win we only replace pyzzer entrypoints in binary files apparently
+            if (path_data.file_mode == FileMode::BINARY)
             {
-                buffer = read_contents(src, std::ios::in | std::ios::binary);
-                util::replace_all(buffer, path_data.prefix_placeholder, new_prefix);
+                LOG_TRACE << "Copying binary file & replace pyzzer prefix " << src << " -> " << dst;
+                std::string buffer = read_contents(src, std::ios::in | std::ios::binary);
 
-                if constexpr (!util::on_win)  // only on non-windows platforms
-                {
-                    // we need to check the first line for a shebang and replace it if it's too long
-                    if (buffer[0] == '#' && buffer[1] == '!')
-                    {
-                        std::size_t end_of_line = buffer.find_first_of('\n');
-                        std::string first_line = buffer.substr(0, end_of_line);
-                        if (first_line.size() > MAX_SHEBANG_LENGTH)
-                        {
-                            std::string new_shebang = replace_long_shebang(first_line);
-                            buffer.replace(0, end_of_line, new_shebang);
-                        }
-                    }
-                }
-            }
-            else
-            {
-                assert(path_data.file_mode == FileMode::BINARY);
-                buffer = read_contents(src, std::ios::in | std::ios::binary);
-
-#ifdef _WIN32
                 auto has_pyzzer_entrypoint = [](const std::string& data)
                 { return data.rfind("PK\x05\x06"); };
 
-                // on win we only replace pyzzer entrypoints apparently
                 auto entry_point = has_pyzzer_entrypoint(buffer);
 
                 struct pyzzer_struct
@@ -706,39 +1087,27 @@ namespace mamba
                         rel_dst.generic_string()
                     );
                 }
-#else
-                std::size_t padding_size = (path_data.prefix_placeholder.size() > new_prefix.size())
-                                               ? path_data.prefix_placeholder.size()
-                                                     - new_prefix.size()
-                                               : 0;
-                std::string padding(padding_size, '\0');
-
-                std::size_t pos = buffer.find(path_data.prefix_placeholder);
-                while (pos != std::string::npos)
-                {
-#if defined(__APPLE__)
-                    binary_changed = true;
-#endif
-                    std::size_t end = pos + path_data.prefix_placeholder.size();
-                    std::string suffix;
-
-                    while (end < buffer.size() && buffer[end] != '\0')
-                    {
-                        suffix += buffer[end];
-                        ++end;
-                    }
-
-                    std::string replacement = util::concat(new_prefix, suffix, padding);
-                    buffer.replace(pos, end - pos, replacement);
 
-                    pos = buffer.find(path_data.prefix_placeholder, pos + new_prefix.size());
-                }
-#endif
+                std::ofstream fo = open_ofstream(dst, std::ios::out | std::ios::binary);
+                fo << buffer;
+                fo.close();
+                return std::make_tuple(
+                    std::string(validation::sha256sum(dst)),
+                    rel_dst.generic_string()
+                );
             }
+#endif
+            LOG_TRACE << "Copying file & replace prefix " << src << " -> " << dst;
+            // TODO windows does something else here
 
-            std::ofstream fo = open_ofstream(dst, std::ios::out | std::ios::binary);
-            fo << buffer;
-            fo.close();
+            // The sha256 in prefix is computed while writing the file.
+            auto [sha256_in_prefix, replaced] = copy_with_prefix_replacement(
+                src,
+                dst,
+                path_data.prefix_placeholder,
+                new_prefix,
+                path_data.file_mode
+            );
 
             std::error_code lec;
             fs::permissions(dst, fs::status(src).permissions(), lec);
@@ -748,55 +1117,60 @@ namespace mamba
             }
 
 #if defined(__APPLE__)
+            const bool binary_changed = replaced && (path_data.file_mode == FileMode::BINARY);
             if (binary_changed && m_pkg_info.platform == "osx-arm64")
             {
                 codesign(dst, m_context->transaction_params().verbosity > 1);
+                // Signing modifies the file
+                sha256_in_prefix = validation::sha256sum(dst);
             }
+#else
+            static_cast<void>(replaced);
 #endif
-            return std::make_tuple(std::string(validation::sha256sum(dst)), rel_dst.generic_string());
+            return std::make_tuple(std::move(sha256_in_prefix), rel_dst.generic_string());
         }
 
         if ((path_data.path_type == PathType::HARDLINK) || path_data.no_link)
         {
-            bool copy = path_data.no_link || m_context->link_params().always_copy;
-            bool softlink = m_context->link_params().always_softlink;
+            const auto& link_params = m_context->link_params();
+            const bool copy = path_data.no_link || link_params.always_copy;
+            bool softlink = link_params.always_softlink;
+            std::optional<LinkStrategy> strategy;
+            std::error_code lec;
 
-            if (!copy && !softlink)
+            // Strategies known not to work between the package cache and the prefix are skipped.
+            if (!softlink && m_capabilities.reflink)
             {
-                std::error_code lec;
-                fs::create_hard_link(src, dst, lec);
-
-                if (lec)
-                {
-                    softlink = m_context->link_params().allow_softlinks;
-                    copy = !softlink;
-                }
-                else
+                reflink_file(src, dst, lec);
+                strategy = lec ? std::nullopt : std::optional(LinkStrategy::Reflink);
+            }
+            if (!strategy && !softlink && !copy)
+            {
+                if (m_capabilities.hardlink)
                 {
-                    LOG_TRACE << "hard-linked '" << src.string() << "'" << std::endl
-                              << " --> '" << dst.string() << "'";
+                    fs::create_hard_link(src, dst, lec);
+                    strategy = lec ? std::nullopt : std::optional(LinkStrategy::Hardlink);
                 }
+                softlink = !strategy && link_params.allow_softlinks;
             }
-            if (softlink)
+            if (!strategy && softlink)
             {
-                std::error_code lec;
                 fs::create_symlink(src, dst, lec);
-                if (lec)
-                {
-                    copy = true;
-                }
-                else
-                {
-                    LOG_TRACE << "soft-linked '" << src.string() << "'" << std::endl
-                              << " --> '" << dst.string() << "'";
-                }
+                strategy = lec ? std::nullopt : std::optional(LinkStrategy::Softlink);
             }
-            if (copy)
+            if (!strategy && m_capabilities.copy_file_range)
+            {
+                copy_file_range_file(src, dst, lec);
+                strategy = lec ? std::nullopt : std::optional(LinkStrategy::CopyFileRange);
+            }
+            if (!strategy)
             {
                 fs::copy(src, dst);
-                LOG_TRACE << "copied '" << src.string() << "'" << std::endl
-                          << " --> '" << dst.string() << "'";
+                strategy = LinkStrategy::Copy;
             }
+            m_context->link_statistics().add(*strategy);
+            LOG_TRACE << link_strategy_name(*strategy) << " '" << src.string() << "'" << std::endl
+                      << " --> '" << dst.string() << "'";
         }
         else if (path_data.path_type == PathType::SOFTLINK)
         {
@@ -853,7 +1227,9 @@ namespace mamba
         LOG_TRACE << "Preparing linking from '" << m_source.string() << "'";
 
         LOG_TRACE << "Opening: " << m_source / "info" / "paths.json";
-        auto paths_data = read_paths(m_source);
+        static_cast<void>(paths());
+        auto paths_data = std::move(m_paths).value();
+        m_paths.reset();
 
         LOG_TRACE << "Opening: " << m_source / "info" / "repodata_record.json";
 
@@ -896,9 +1272,54 @@ namespace mamba
         paths_json["paths"] = nlohmann::json::array();
         paths_json["paths_version"] = 1;
 
-        for (auto& path : paths_data)
+        // Parent directories are created once, before linking files concurrently.
+        const bool noarch_python = noarch_type == NoarchType::PYTHON;
+        std::vector<fs::u8path> targets;
+        targets.reserve(paths_data.size());
+        std::vector<std::string> parent_dirs;
+        parent_dirs.reserve(paths_data.size());
+        for (const auto& path : paths_data)
+        {
+            targets.push_back(link_target(path, noarch_python));
+            parent_dirs.push_back(
+                (m_context->prefix_params().target_prefix / targets.back()).parent_path().string()
+            );
+        }
+        std::sort(parent_dirs.begin(), parent_dirs.end());
+        parent_dirs.erase(std::unique(parent_dirs.begin(), parent_dirs.end()), parent_dirs.end());
+        for (const auto& dir : parent_dirs)
         {
-            auto [sha256_in_prefix, final_path] = link_path(path, noarch_type == NoarchType::PYTHON);
+            fs::create_directories(dir);
+        }
+
+        m_capabilities = link_capabilities(
+            m_cache_path,
+            m_context->prefix_params().target_prefix,
+            m_source / "info" / "repodata_record.json"
+        );
+
+        // Results are stored by index to keep the records in the order of ``paths.json``.
+        std::vector<std::tuple<std::string, std::string>> linked(paths_data.size());
+        // Not a ``std::vector<bool>`` which cannot be written concurrently.
+        std::vector<char> clobbered(paths_data.size(), false);
+        MainExecutor::instance().parallel_for(
+            paths_data.size(),
+            [&](std::size_t i)
+            {
+                bool path_clobbered = false;
+                linked[i] = link_path(paths_data[i], targets[i], path_clobbered);
+                clobbered[i] = path_clobbered;
+            }
+        );
+
+        for (std::size_t i = 0; i < paths_data.size(); ++i)
+        {
+            const auto& path = paths_data[i];
+            auto& [sha256_in_prefix, final_path] = linked[i];
+            if (clobbered[i])
+            {
+                m_clobber_warnings.push_back(targets[i].string());
+            }
             files_record.push_back(final_path);
 
             nlohmann::json json_record = { { "_path", final_path },
@@ -935,6 +1356,24 @@ namespace mamba
             paths_json["paths"].push_back(json_record);
         }
 
+        // Index of the files of the package by their canonical path, to reuse their sha256 for
+        // the symlinks pointing to them.
+        const auto& target_prefix = m_context->prefix_params().target_prefix;
+        std::error_code prefix_ec;
+        auto canonical_prefix = fs::canonical(target_prefix, prefix_ec);
+        if (prefix_ec)
+        {
+            canonical_prefix = target_prefix;
+        }
+        std::unordered_map<std::string, std::size_t> record_by_path;
+        for (std::size_t i = 0; i < paths_data.size(); ++i)
+        {
+            if (paths_data[i].path_type != PathType::SOFTLINK)
+            {
+                record_by_path.emplace((canonical_prefix / files_record[i]).generic_string(), i);
+            }
+        }
+
         for (std::size_t i = 0; i < paths_data.size(); ++i)
         {
             auto& path = paths_data[i];
@@ -942,37 +1381,25 @@ namespace mamba
             {
                 // here we try to avoid recomputing the costly sha256 sum
                 std::error_code ec;
-                auto points_to = fs::canonical(
-                    m_context->prefix_params().target_prefix / files_record[i],
-                    ec
-                );
+                auto points_to = fs::canonical(target_prefix / files_record[i], ec);
                 bool found = false;
                 if (!ec)
                 {
-                    for (std::size_t pix = 0; pix < files_record.size(); ++pix)
+                    if (auto it = record_by_path.find(points_to.generic_string());
+                        it != record_by_path.end())
                     {
-                        if ((m_context->prefix_params().target_prefix / files_record[pix])
-                            == points_to)
-                        {
-                            if (paths_json["paths"][pix].contains("sha256_in_prefix"))
-                            {
-                                LOG_TRACE << "Found symlink and target " << files_record[i]
-                                          << " -> " << files_record[pix];
-                                // use already computed value
-                                paths_json["paths"][i]["sha256_in_prefix"] = paths_json["paths"][pix]
-                                                                                       ["sha256_in_prefix"];
-                                found = true;
-                                break;
-                            }
-                        }
+                        const auto pix = it->second;
+                        LOG_TRACE << "Found symlink and target " << files_record[i] << " -> "
+                                  << files_record[pix];
+                        // use already computed value
+                        paths_json["paths"][i]["sha256_in_prefix"] = paths_json["paths"][pix]
+                                                                               ["sha256_in_prefix"];
+                        found = true;
                     }
                 }
                 if (!found)
                 {
-                    bool exists = fs::exists(
-                        m_context->prefix_params().target_prefix / files_record[i],
-                        ec
-                    );
+                    bool exists = fs::exists(target_prefix / files_record[i], ec);
                     if (ec)
                     {
                         LOG_WARNING << "Could not check existence for " << files_record[i] << ": "
@@ -983,7 +1410,7 @@ namespace mamba
                     if (exists)
                     {
                         paths_json["paths"][i]["sha256_in_prefix"] = validation::sha256sum(
-                            m_context->prefix_params().target_prefix / files_record[i]
+                            target_prefix / files_record[i]
                         );
                     }
                     else
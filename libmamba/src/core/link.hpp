@@ -7,9 +7,14 @@
 #ifndef MAMBA_CORE_LINK
 #define MAMBA_CORE_LINK
 
+#include <functional>
+#include <optional>
 #include <regex>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "mamba/core/package_paths.hpp"
@@ -36,6 +41,112 @@ namespace mamba
 
     constexpr std::size_t MAX_SHEBANG_LENGTH = util::on_linux ? 127 : 512;
 
+    /**
+     * Replace a prefix placeholder in a stream of data.
+     *
+     * The input is given by chunks of arbitrary sizes with ``feed`` and the output is written
+     * to the sink as soon as it cannot be part of a placeholder anymore, so that files of any
+     * size are rewritten with a memory footprint of a chunk.
+     *
+     * In text mode, all occurrences of the placeholder are replaced by the new prefix and,
+     * except on Windows, a shebang longer than ``MAX_SHEBANG_LENGTH`` is rewritten with
+     * ``replace_long_shebang``.
+     * In binary mode, the placeholder is replaced in the null terminated string where it
+     * occurs, which is padded with null characters to keep its length unchanged.
+     */
+    class PrefixReplacer
+    {
+    public:
+
+        using sink_type = std::function<void(std::string_view)>;
+
+        PrefixReplacer(
+            std::string placeholder,
+            std::string new_prefix,
+            FileMode mode,
+            sink_type sink
+        );
+
+        void feed(std::string_view data);
+        void finish();
+
+        /** Whether the placeholder was found in the data fed so far. */
+        [[nodiscard]] auto replaced() const -> bool;
+
+    private:
+
+        enum class ShebangState
+        {
+            Unknown,
+            Reading,
+            Done,
+        };
+
+        std::string m_placeholder;
+        std::string m_new_prefix;
+        std::string m_pending = {};
+        std::string m_shebang = {};
+        sink_type m_sink;
+        std::size_t m_padding_size = 0;
+        std::size_t m_pending_padding = 0;
+        FileMode m_mode;
+        ShebangState m_shebang_state = ShebangState::Unknown;
+        bool m_replaced = false;
+
+        void process(std::size_t keep);
+        void write_binary(std::string_view data);
+        void write(std::string_view data);
+        void write_shebang();
+    };
+
+    /**
+     * Copy a file replacing its prefix placeholder in a single streaming pass.
+     *
+     * Return the sha256 of the written file, computed along the way, and whether the
+     * placeholder was found.
+     */
+    auto copy_with_prefix_replacement(
+        const fs::u8path& src,
+        const fs::u8path& dst,
+        const std::string& placeholder,
+        const std::string& new_prefix,
+        FileMode mode
+    ) -> std::pair<std::string, bool>;
+
+    /** Which of the LinkStrategy are available between two directories. */
+    struct LinkCapabilities
+    {
+        bool reflink = false;
+        bool hardlink = false;
+        bool copy_file_range = false;
+    };
+
+    /**
+     * Probe the LinkCapabilities by creating copies of ``source_file`` in ``target_dir``.
+     *
+     * The copies are removed afterwards.
+     */
+    auto probe_link_capabilities(const fs::u8path& source_file, const fs::u8path& target_dir)
+        -> LinkCapabilities;
+
+    /**
+     * The LinkCapabilities from ``pkgs_dir`` to ``prefix``.
+     *
+     * They are probed with ``probe_file``, a file of ``pkgs_dir``, the first time a pair of
+     * directories is seen and cached for the rest of the process.
+     */
+    auto link_capabilities(
+        const fs::u8path& pkgs_dir,
+        const fs::u8path& prefix,
+        const fs::u8path& probe_file
+    ) -> LinkCapabilities;
+
+    /** Create ``dst`` as a copy on write clone of ``src``, with the same permissions. */
+    void reflink_file(const fs::u8path& src, const fs::u8path& dst, std::error_code& ec);
+
+    /** Copy ``src`` to ``dst`` inside the kernel, with the same permissions. */
+    void copy_file_range_file(const fs::u8path& src, const fs::u8path& dst, std::error_code& ec);
+
     struct python_entry_point_parsed
     {
         std::string command, module, func;
@@ -77,9 +188,19 @@ namespace mamba
         bool execute();
         bool undo();
 
+        /** The files of the package, read from its ``paths.json`` once until executed. */
+        auto paths() -> const std::vector<PathData>&;
+
+        /** Where a file of the package is linked, relative to the prefix. */
+        [[nodiscard]] auto target_path(const PathData& path_data) const -> fs::u8path;
+
     private:
 
-        std::tuple<std::string, std::string> link_path(const PathData& path_data, bool noarch_python);
+        [[nodiscard]] auto link_target(const PathData& path_data, bool noarch_python) const
+            -> fs::u8path;
+        // Thread safe, parent directories of ``rel_dst`` must already exist.
+        std::tuple<std::string, std::string>
+        link_path(const PathData& path_data, const fs::u8path& rel_dst, bool& clobbered) const;
         std::vector<fs::u8path> compile_pyc_files(const std::vector<fs::u8path>& py_files);
         auto
         create_python_entry_point(const fs::u8path& path, const python_entry_point_parsed& entry_point);
@@ -92,7 +213,9 @@ namespace mamba
         specs::PackageInfo m_pkg_info;
         fs::u8path m_cache_path;
         fs::u8path m_source;
+        std::optional<std::vector<PathData>> m_paths = std::nullopt;
         std::vector<std::string> m_clobber_warnings;
+        LinkCapabilities m_capabilities = {};
         TransactionContext* m_context;
     };
 
@@ -557,15 +557,38 @@ namespace mamba
     }
 
     MessageLogger::~MessageLogger()
+    {
+        log_message(m_stream.str(), m_level);
+    }
+
+    bool MessageLogger::is_enabled(log_level level)
+    {
+        const auto spdlog_level = static_cast<spdlog::level::level_enum>(level);
+        if (spdlog_level < SPDLOG_ACTIVE_LEVEL)
+        {
+            // Compiled out from ``emit``
+            return false;
+        }
+        if (MessageLoggerData::use_buffer)
+        {
+            // Filtered when printing the buffer, once the level is known
+            return true;
+        }
+        const auto* logger = spdlog::default_logger_raw();
+        return (logger == nullptr) || logger->should_log(spdlog_level)
+               || logger->should_backtrace();
+    }
+
+    void MessageLogger::log_message(std::string msg, log_level level)
     {
         if (!MessageLoggerData::use_buffer && Console::is_available())
         {
-            emit(m_stream.str(), m_level);
+            emit(msg, level);
         }
         else
         {
             const std::lock_guard<std::mutex> lock(MessageLoggerData::m_mutex);
-            MessageLoggerData::m_buffer.push_back({ m_stream.str(), m_level });
+            MessageLoggerData::m_buffer.push_back({ std::move(msg), level });
         }
     }
 
@@ -4,7 +4,15 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <optional>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include <fmt/format.h>
 #include <solv/evr.h>
@@ -14,6 +22,7 @@
 
 #include "mamba/core/channel_context.hpp"
 #include "mamba/core/context.hpp"
+#include "mamba/core/execution.hpp"
 #include "mamba/core/output.hpp"
 #include "mamba/core/package_database_loader.hpp"
 #include "mamba/core/prefix_data.hpp"
@@ -22,6 +31,7 @@
 #include "mamba/solver/libsolv/database.hpp"
 #include "mamba/solver/libsolv/repo_info.hpp"
 #include "mamba/util/build.hpp"
+#include "mamba/util/cryptography.hpp"
 #include "mamba/util/string.hpp"
 
 #include "solver/libsolv/helpers.hpp"
@@ -52,21 +62,99 @@ namespace mamba
         );
     }
 
+    namespace
+    {
+        auto subdir_cache_origin(const SubdirIndexLoader& subdir) -> solver::libsolv::RepodataOrigin
+        {
+            return {
+                /* .url= */ util::rsplit(subdir.metadata().url(), "/", 1).front(),
+                /* .etag= */ subdir.metadata().etag(),
+                /* .mod= */ subdir.metadata().last_modified(),
+            };
+        }
+
+        auto subdir_repo_url(const SubdirIndexLoader& subdir) -> std::string
+        {
+            return util::rsplit(subdir.metadata().url(), "/", 1).front();
+        }
+
+        auto add_pip_param(const Context& ctx) -> solver::libsolv::PipAsPythonDependency
+        {
+            return static_cast<solver::libsolv::PipAsPythonDependency>(
+                ctx.add_pip_as_python_dependency
+            );
+        }
+
+        auto package_types_param(const Context& ctx) -> solver::libsolv::PackageTypes
+        {
+            using PackageTypes = solver::libsolv::PackageTypes;
+            return ctx.use_only_tar_bz2 ? PackageTypes::TarBz2Only
+                                        : PackageTypes::CondaOrElseTarBz2;
+        }
+
+        auto verify_packages_param(const Context& ctx) -> solver::libsolv::VerifyPackages
+        {
+            return static_cast<solver::libsolv::VerifyPackages>(
+                ctx.validation_params.verify_artifacts
+            );
+        }
+
+        auto load_subdir_from_solv_cache(
+            const Context& ctx,
+            solver::libsolv::Database& database,
+            const SubdirIndexLoader& subdir
+        ) -> expected_t<solver::libsolv::RepoInfo>
+        {
+            return subdir.valid_libsolv_cache_path().and_then(
+                [&](fs::u8path&& solv_file)
+                {
+                    auto timer = ctx.timings.time("solv_cache.load", subdir.name());
+                    return database.add_repo_from_native_serialization(
+                        solv_file,
+                        subdir_cache_origin(subdir),
+                        subdir.channel_id(),
+                        add_pip_param(ctx)
+                    );
+                }
+            );
+        }
+
+        void write_subdir_solv_cache(
+            const Context& ctx,
+            solver::libsolv::Database& database,
+            const SubdirIndexLoader& subdir,
+            const solver::libsolv::RepoInfo& repo
+        )
+        {
+            if (util::on_win)
+            {
+                return;
+            }
+            auto timer = ctx.timings.time("solv_cache.write", subdir.name());
+            database
+                .native_serialize_repo(
+                    repo,
+                    subdir.writable_libsolv_cache_path(),
+                    subdir_cache_origin(subdir)
+                )
+                .or_else(
+                    [&](const auto& err)
+                    {
+                        LOG_WARNING << R"(Fail to write native serialization to file ")"
+                                    << subdir.writable_libsolv_cache_path() << R"(" for repo ")"
+                                    << subdir.name() << ": " << err.what();
+                        ;
+                    }
+                );
+        }
+    }
+
     auto load_subdir_in_database(
         const Context& ctx,
         solver::libsolv::Database& database,
         const SubdirIndexLoader& subdir
     ) -> expected_t<solver::libsolv::RepoInfo>
     {
-        const auto expected_cache_origin = solver::libsolv::RepodataOrigin{
-            /* .url= */ util::rsplit(subdir.metadata().url(), "/", 1).front(),
-            /* .etag= */ subdir.metadata().etag(),
-            /* .mod= */ subdir.metadata().last_modified(),
-        };
-
-        const auto add_pip = static_cast<solver::libsolv::PipAsPythonDependency>(
-            ctx.add_pip_as_python_dependency
-        );
         const auto json_parser = ctx.experimental_repodata_parsing
                                      ? solver::libsolv::RepodataParser::Mamba
                                      : solver::libsolv::RepodataParser::Libsolv;
@@ -74,18 +162,7 @@ namespace mamba
         // Solv files are too slow on Windows.
         if (!util::on_win)
         {
-            auto maybe_repo = subdir.valid_libsolv_cache_path().and_then(
-                [&](fs::u8path&& solv_file)
-                {
-                    return database.add_repo_from_native_serialization(
-                        solv_file,
-                        expected_cache_origin,
-                        subdir.channel_id(),
-                        add_pip
-                    );
-                }
-            );
-            if (maybe_repo)
+            if (auto maybe_repo = load_subdir_from_solv_cache(ctx, database, subdir))
             {
                 return maybe_repo;
             }
@@ -95,18 +172,15 @@ namespace mamba
             .and_then(
                 [&](fs::u8path&& repodata_json)
                 {
-                    using PackageTypes = solver::libsolv::PackageTypes;
-
                     LOG_INFO << "Trying to load repo from json file " << repodata_json;
+                    auto timer = ctx.timings.time("repodata.parse", subdir.name());
                     return database.add_repo_from_repodata_json(
                         repodata_json,
-                        util::rsplit(subdir.metadata().url(), "/", 1).front(),
+                        subdir_repo_url(subdir),
                         subdir.channel_id(),
-                        add_pip,
-                        ctx.use_only_tar_bz2 ? PackageTypes::TarBz2Only
-                                             : PackageTypes::CondaOrElseTarBz2,
-                        static_cast<solver::libsolv::VerifyPackages>(ctx.validation_params.verify_artifacts
-                        ),
+                        add_pip_param(ctx),
+                        package_types_param(ctx),
+                        verify_packages_param(ctx),
                         json_parser
                     );
                 }
@@ -114,26 +188,349 @@ namespace mamba
             .transform(
                 [&](solver::libsolv::RepoInfo&& repo) -> solver::libsolv::RepoInfo
                 {
-                    if (!util::on_win)
+                    write_subdir_solv_cache(ctx, database, subdir, repo);
+                    return std::move(repo);
+                }
+            );
+    }
+
+    /********************************************
+     *  Implementation of SubdirDatabaseLoader  *
+     ********************************************/
+
+    namespace
+    {
+        using steady_clock = std::chrono::steady_clock;
+        using seconds = std::chrono::duration<double>;
+    }
+
+    struct SubdirDatabaseLoader::Impl
+    {
+        struct ParseResult
+        {
+            expected_t<solver::libsolv::ParsedRepodata> repodata;
+            steady_clock::duration duration;
+            Timings::duration cpu_time;
+        };
+
+        explicit Impl(const Context& ctx)
+            : p_context(&ctx)
+        {
+        }
+
+        const Context* p_context;
+        std::mutex mutex = {};
+        // A subdir without parse is loaded as a whole on the loading thread.
+        std::unordered_map<const SubdirIndexLoader*, std::optional<std::future<ParseResult>>>
+            parses = {};
+    };
+
+    SubdirDatabaseLoader::SubdirDatabaseLoader(const Context& ctx)
+        : p_impl(std::make_unique<Impl>(ctx))
+    {
+    }
+
+    SubdirDatabaseLoader::~SubdirDatabaseLoader() = default;
+
+    void SubdirDatabaseLoader::prepare(const SubdirIndexLoader& subdir)
+    {
+        const auto& ctx = *p_impl->p_context;
+        std::lock_guard<std::mutex> lock(p_impl->mutex);
+        auto [it, inserted] = p_impl->parses.try_emplace(&subdir);
+        if (!inserted)
+        {
+            return;
+        }
+
+        // Only the mamba parser does not need the database to parse the repodata.
+        // Subdirs with a valid solv cache are expected to be loaded from it.
+        if (!ctx.experimental_repodata_parsing
+            || (!util::on_win && subdir.valid_libsolv_cache_path().has_value()))
+        {
+            return;
+        }
+        if (auto repodata_json = subdir.valid_json_cache_path())
+        {
+            using ParseResult = Impl::ParseResult;
+            it->second = MainExecutor::instance().submit(
+                [path = std::move(repodata_json).value(),
+                 url = subdir_repo_url(subdir),
+                 types = package_types_param(ctx),
+                 verify = verify_packages_param(ctx)]
+                {
+                    const auto start = steady_clock::now();
+                    const auto cpu_start = Timings::thread_cpu_time();
+                    auto repodata = solver::libsolv::Database::parse_repodata_json(
+                        path,
+                        url,
+                        types,
+                        verify
+                    );
+                    return ParseResult{
+                        std::move(repodata),
+                        steady_clock::now() - start,
+                        Timings::thread_cpu_time() - cpu_start,
+                    };
+                }
+            );
+        }
+    }
+
+    auto SubdirDatabaseLoader::load(
+        solver::libsolv::Database& database,
+        const std::vector<const SubdirIndexLoader*>& subdirs
+    ) -> std::vector<expected_t<solver::libsolv::RepoInfo>>
+    {
+        const auto& ctx = *p_impl->p_context;
+
+        for (const auto* subdir : subdirs)
+        {
+            prepare(*subdir);
+        }
+
+        // Packages are added to the database in the order of the subdirs, on this thread.
+        auto repos = std::vector<expected_t<solver::libsolv::RepoInfo>>();
+        repos.reserve(subdirs.size());
+        for (const auto* p_subdir : subdirs)
+        {
+            const auto& subdir = *p_subdir;
+            const auto start = steady_clock::now();
+
+            auto parse = [&]
+            {
+                std::lock_guard<std::mutex> lock(p_impl->mutex);
+                return std::move(p_impl->parses.at(p_subdir));
+            }();
+
+            if (!parse.has_value())
+            {
+                repos.push_back(load_subdir_in_database(ctx, database, subdir));
+                LOG_INFO << fmt::format(
+                    "Loaded subdir {} in {:.3f}s",
+                    subdir.name(),
+                    seconds(steady_clock::now() - start).count()
+                );
+                continue;
+            }
+
+            auto parsed = parse->get();
+            const auto wait_end = steady_clock::now();
+            const auto add_cpu_start = Timings::thread_cpu_time();
+            repos.push_back(parsed.repodata.and_then(
+                [&](const solver::libsolv::ParsedRepodata& repodata)
+                {
+                    return database.add_repo_from_parsed_repodata(
+                        repodata,
+                        subdir.channel_id(),
+                        add_pip_param(ctx)
+                    );
+                }
+            ));
+            const auto add_end = steady_clock::now();
+            // Recorded as a whole, like the subdirs parsed and added on this thread
+            ctx.timings.record(
+                "repodata.parse",
+                subdir.name(),
+                parsed.duration + (add_end - wait_end),
+                parsed.cpu_time + (Timings::thread_cpu_time() - add_cpu_start)
+            );
+            if (repos.back().has_value())
+            {
+                write_subdir_solv_cache(ctx, database, subdir, repos.back().value());
+            }
+            LOG_INFO << fmt::format(
+                "Loaded subdir {} (parsing in parallel: {:.3f}s, waiting: {:.3f}s, "
+                "adding to database: {:.3f}s, writing cache: {:.3f}s)",
+                subdir.name(),
+                seconds(parsed.duration).count(),
+                seconds(wait_end - start).count(),
+                seconds(add_end - wait_end).count(),
+                seconds(steady_clock::now() - add_end).count()
+            );
+        }
+        return repos;
+    }
+
+    auto load_subdirs_in_database(
+        const Context& ctx,
+        solver::libsolv::Database& database,
+        const std::vector<const SubdirIndexLoader*>& subdirs
+    ) -> std::vector<expected_t<solver::libsolv::RepoInfo>>
+    {
+        return SubdirDatabaseLoader(ctx).load(database, subdirs);
+    }
+
+    /*****************************************
+     *  Implementation of subdirs snapshots  *
+     *****************************************/
+
+    namespace
+    {
+        // The snapshot of a given list of subdirs is always written at the same place, so that
+        // it gets replaced when one of the subdirs is updated.
+        auto subdirs_snapshot_path(const std::vector<const SubdirIndexLoader*>& subdirs)
+            -> fs::u8path
+        {
+            auto ids = std::string();
+            for (const auto* subdir : subdirs)
+            {
+                ids += util::concat(subdir->repodata_url().str(), " ", subdir->channel_id(), "\n");
+            }
+            const auto name = util::Md5Hasher().str_hex_str(ids).substr(0, 8u);
+            return subdirs.front()->writable_libsolv_cache_path().parent_path()
+                   / util::concat(name, ".snapshot.solv");
+        }
+
+        auto subdirs_snapshot_entries(
+            const std::vector<const SubdirIndexLoader*>& subdirs,
+            const std::vector<solver::libsolv::Priorities>& priorities
+        ) -> std::vector<solver::libsolv::RepodataSnapshotEntry>
+        {
+            assert(subdirs.size() == priorities.size());
+            auto entries = std::vector<solver::libsolv::RepodataSnapshotEntry>();
+            entries.reserve(subdirs.size());
+            for (std::size_t i = 0; i < subdirs.size(); ++i)
+            {
+                entries.push_back({
+                    /* .origin= */ subdir_cache_origin(*subdirs[i]),
+                    /* .channel_id= */ subdirs[i]->channel_id(),
+                    /* .priorities= */ priorities[i],
+                });
+            }
+            return entries;
+        }
+
+        /**
+         * Remove the other snapshots that cannot be used anymore.
+         *
+         * They are unreadable, or hold one of the given subdirs at another state, which can only
+         * be found again if the subdir goes back to that state.
+         */
+        void remove_stale_subdirs_snapshots(
+            const fs::u8path& path,
+            const std::vector<solver::libsolv::RepodataSnapshotEntry>& entries,
+            solver::libsolv::PipAsPythonDependency add
+        )
+        {
+            const auto is_stale = [&](const solver::libsolv::RepodataSnapshotEntry& other)
+            {
+                return std::any_of(
+                    entries.cbegin(),
+                    entries.cend(),
+                    [&](const auto& entry)
                     {
-                        database
-                            .native_serialize_repo(
-                                repo,
-                                subdir.writable_libsolv_cache_path(),
-                                expected_cache_origin
-                            )
-                            .or_else(
-                                [&](const auto& err)
-                                {
-                                    LOG_WARNING << R"(Fail to write native serialization to file ")"
-                                                << subdir.writable_libsolv_cache_path()
-                                                << R"(" for repo ")" << subdir.name() << ": "
-                                                << err.what();
-                                    ;
-                                }
-                            );
+                        return (entry.origin.url == other.origin.url)
+                               && (entry.origin != other.origin);
                     }
-                    return std::move(repo);
+                );
+            };
+
+            std::error_code ec;
+            for (const auto& file : fs::directory_iterator(path.parent_path(), ec))
+            {
+                const auto other_path = file.path();
+                if ((other_path == path)
+                    || !util::ends_with(other_path.filename().string(), ".snapshot.solv"))
+                {
+                    continue;
+                }
+                const auto other_entries = solver::libsolv::Database::native_snapshot_entries(
+                    other_path,
+                    add
+                );
+                if (!other_entries.has_value()
+                    || std::any_of(other_entries->cbegin(), other_entries->cend(), is_stale))
+                {
+                    LOG_INFO << "Removing stale snapshot " << other_path;
+                    fs::remove(other_path, ec);
+                }
+            }
+        }
+    }
+
+    auto load_subdirs_from_snapshot(
+        const Context& ctx,
+        solver::libsolv::Database& database,
+        const std::vector<const SubdirIndexLoader*>& subdirs,
+        const std::vector<solver::libsolv::Priorities>& priorities
+    ) -> expected_t<std::vector<solver::libsolv::RepoInfo>>
+    {
+        // Solv files are too slow on Windows.
+        const auto all_solv_valid = std::all_of(
+            subdirs.cbegin(),
+            subdirs.cend(),
+            [](const auto* subdir) { return subdir->valid_libsolv_cache_path().has_value(); }
+        );
+        if (util::on_win || subdirs.empty() || !all_solv_valid)
+        {
+            return make_unexpected(
+                "Subdirs cannot be loaded from a snapshot",
+                mamba_error_code::repodata_not_loaded
+            );
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        auto timer = ctx.timings.time("solv_cache.load", "snapshot");
+        return database
+            .add_repos_from_native_snapshot(
+                subdirs_snapshot_path(subdirs),
+                subdirs_snapshot_entries(subdirs, priorities),
+                add_pip_param(ctx)
+            )
+            .transform(
+                [&](std::vector<solver::libsolv::RepoInfo>&& repos)
+                {
+                    LOG_INFO << fmt::format(
+                        "Loaded {} subdirs from snapshot in {:.3f}s",
+                        repos.size(),
+                        std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                            .count()
+                    );
+                    return std::move(repos);
+                }
+            );
+    }
+
+    void write_subdirs_snapshot(
+        const Context& ctx,
+        solver::libsolv::Database& database,
+        const std::vector<const SubdirIndexLoader*>& subdirs,
+        const std::vector<solver::libsolv::RepoInfo>& repos,
+        const std::vector<solver::libsolv::Priorities>& priorities
+    )
+    {
+        const auto any_caching_forbidden = std::any_of(
+            subdirs.cbegin(),
+            subdirs.cend(),
+            [](const auto* subdir) { return subdir->caching_is_forbidden(); }
+        );
+        if (util::on_win || subdirs.empty() || any_caching_forbidden)
+        {
+            return;
+        }
+
+        const auto path = subdirs_snapshot_path(subdirs);
+        const auto entries = subdirs_snapshot_entries(subdirs, priorities);
+        // The snapshot was not loaded, but may still be current, for instance if one of the solv
+        // caches was rewritten without a change in the subdir.
+        const auto current = solver::libsolv::Database::native_snapshot_entries(
+            path,
+            add_pip_param(ctx)
+        );
+        if (current.has_value() && (*current == entries))
+        {
+            LOG_DEBUG << "Snapshot " << path << " is up to date";
+            return;
+        }
+
+        auto timer = ctx.timings.time("solv_cache.write", "snapshot");
+        database.native_serialize_repos(repos, path, entries, add_pip_param(ctx))
+            .transform([&]() { remove_stale_subdirs_snapshots(path, entries, add_pip_param(ctx)); })
+            .or_else(
+                [&](const auto& err)
+                {
+                    LOG_WARNING << R"(Fail to write native snapshot to file ")" << path
+                                << R"(": )" << err.what();
                 }
             );
     }
@@ -4,9 +4,12 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <chrono>
+
 #include "mamba/core/invoke.hpp"
 #include "mamba/core/output.hpp"
 #include "mamba/core/package_fetcher.hpp"
+#include "mamba/core/timings.hpp"
 #include "mamba/core/util.hpp"
 #include "mamba/specs/archive.hpp"
 #include "mamba/util/string.hpp"
@@ -43,6 +46,7 @@ namespace mamba
     auto PackageExtractTask::run() -> Result
     {
         bool is_valid = true;
+        auto timer = Timings::ScopedTimer(m_options.timings, "extract", p_fetcher->name());
         bool is_extracted = p_fetcher->extract(m_options);
         return { is_valid, is_extracted };
     }
@@ -50,11 +54,18 @@ namespace mamba
     auto PackageExtractTask::run(std::size_t downloaded_size) -> Result
     {
         using ValidationResult = PackageFetcher::ValidationResult;
+        auto validation_timer = Timings::ScopedTimer(
+            m_options.timings,
+            "validate",
+            p_fetcher->name()
+        );
         ValidationResult validation_res = p_fetcher->validate(downloaded_size, get_progress_callback());
+        validation_timer.stop();
         const bool is_valid = validation_res == ValidationResult::VALID;
         bool is_extracted = false;
         if (is_valid)
         {
+            auto timer = Timings::ScopedTimer(m_options.timings, "extract", p_fetcher->name());
             is_extracted = p_fetcher->extract(m_options, get_progress_callback());
         }
         return { is_valid, is_extracted };
@@ -135,8 +146,41 @@ namespace mamba
         return m_needs_extract;
     }
 
-    download::Request
-    PackageFetcher::build_download_request(std::optional<post_download_success_t> callback)
+    namespace
+    {
+        fs::u8path get_extract_path(const std::string& filename, const fs::u8path& cache_path)
+        {
+            std::string fn = filename;
+            if (util::ends_with(fn, ".tar.bz2"))
+            {
+                fn = fn.substr(0, fn.size() - 8);
+            }
+            else if (util::ends_with(fn, ".conda"))
+            {
+                fn = fn.substr(0, fn.size() - 6);
+            }
+            else
+            {
+                LOG_ERROR << "Unknown package format '" << filename << "'";
+                throw std::runtime_error("Unknown package format.");
+            }
+            return cache_path / fn;
+        }
+
+        void clear_extract_path(const fs::u8path& path)
+        {
+            if (fs::exists(path))
+            {
+                LOG_DEBUG << "Removing '" << path.string() << "' before extracting it again";
+                fs::remove_all(path);
+            }
+        }
+    }
+
+    download::Request PackageFetcher::build_download_request(
+        std::optional<post_download_success_t> callback,
+        std::optional<ExtractOptions> options
+    )
     {
         // download::Request request(name(), download::MirrorName(""), url(),
         // m_tarball_path.string());
@@ -144,10 +188,52 @@ namespace mamba
             request(name(), download::MirrorName(channel()), url_path(), m_tarball_path.string());
         request.expected_size = expected_size();
         request.sha256 = sha256();
+        // Only the checksum used by `validate` is computed during the download
+        request.compute_sha256 = !sha256().empty();
+        request.compute_md5 = sha256().empty() && !md5().empty();
+        // Read before the options are moved to the stream extractor
+        Timings* timings = options.has_value() ? options->timings : nullptr;
+
+        if (options.has_value() && options->stream && util::ends_with(filename(), ".conda"))
+        {
+            const fs::u8path stream_path = util::concat(
+                get_extract_path(filename(), m_cache_path).string(),
+                ".streaming"
+            );
+            clear_extract_path(stream_path);
+            m_stream_extractor = std::make_shared<CondaStreamExtractor>(
+                stream_path,
+                std::move(options).value(),
+                PackageFetcherSemaphore::semaphore
+            );
+            request.on_content = [extractor = m_stream_extractor](std::size_t offset,
+                                                                  std::string_view chunk)
+            { extractor->feed(offset, chunk); };
+        }
 
-        request.on_success = [this, cb = std::move(callback)](const download::Success& success)
+        request.on_success = [this, cb = std::move(callback), timings](
+                                 const download::Success& success
+                             )
         {
             LOG_INFO << "Download finished, tarball available at '" << m_tarball_path.string() << "'";
+            if (timings != nullptr)
+            {
+                timings->record(
+                    "fetch",
+                    name(),
+                    std::chrono::microseconds(success.transfer.total_time_us)
+                );
+                timings->add("fetch.downloaded_bytes", success.transfer.downloaded_size);
+            }
+            // A running extraction must not wait for the extraction task to signal the end of
+            // the content, since that task may be waiting for a thread of the MainExecutor.
+            if (m_stream_extractor != nullptr)
+            {
+                m_stream_extractor->close();
+            }
+            // Must be set before the callback which may schedule the validation
+            m_downloaded_sha256 = success.sha256;
+            m_downloaded_md5 = success.md5;
             if (cb.has_value())
             {
                 cb.value()(success.transfer.downloaded_size);
@@ -196,20 +282,28 @@ namespace mamba
 
         interruption_point();
 
+        // Checksums computed while downloading are used when available, the tarball is only
+        // read again otherwise.
         if (!sha256().empty())
         {
+            const std::string_view actual = m_downloaded_sha256.empty()
+                                                ? validation::sha256sum(m_tarball_path)
+                                                : std::string_view(m_downloaded_sha256);
             res = validate_checksum({
                 /* .expected= */ sha256(),
-                /* .actual= */ validation::sha256sum(m_tarball_path),
+                /* .actual= */ actual,
                 /* .name= */ "SHA256",
                 /* .error= */ ValidationResult::SHA256_ERROR,
             });
         }
         else if (!md5().empty())
         {
+            const std::string_view actual = m_downloaded_md5.empty()
+                                                ? validation::md5sum(m_tarball_path)
+                                                : std::string_view(m_downloaded_md5);
             res = validate_checksum({
                 /* .expected= */ md5(),
-                /* .actual= */ validation::md5sum(m_tarball_path),
+                /* .actual= */ actual,
                 /* .name= */ "MD5",
                 /* .error= */ ValidationResult::MD5SUM_ERROR,
             });
@@ -221,87 +315,40 @@ namespace mamba
         return res;
     }
 
-    namespace
-    {
-        fs::u8path get_extract_path(const std::string& filename, const fs::u8path& cache_path)
-        {
-            std::string fn = filename;
-            if (util::ends_with(fn, ".tar.bz2"))
-            {
-                fn = fn.substr(0, fn.size() - 8);
-            }
-            else if (util::ends_with(fn, ".conda"))
-            {
-                fn = fn.substr(0, fn.size() - 6);
-            }
-            else
-            {
-                LOG_ERROR << "Unknown package format '" << filename << "'";
-                throw std::runtime_error("Unknown package format.");
-            }
-            return cache_path / fn;
-        }
-
-        void clear_extract_path(const fs::u8path& path)
-        {
-            if (fs::exists(path))
-            {
-                LOG_DEBUG << "Removing '" << path.string() << "' before extracting it again";
-                fs::remove_all(path);
-            }
-        }
-
-        void extract_impl(
-            const fs::u8path& tarball_path,
-            const fs::u8path& extract_path,
-            const ExtractOptions& options
-        )
-        {
-            // Use non-subproc version if concurrency is disabled to avoid
-            // any potential subprocess issues
-            if (PackageFetcherSemaphore::get_max() == 1)
-            {
-                mamba::extract(tarball_path, extract_path, options);
-            }
-            else
-            {
-                mamba::extract_subproc(tarball_path, extract_path, options);
-            }
-        }
-    }
-
     bool PackageFetcher::extract(const ExtractOptions& options, progress_callback_t* cb)
     {
-        // Extracting is __not__ yet thread safe it seems...
         interruption_point();
 
         LOG_DEBUG << "Waiting for decompression " << m_tarball_path;
         update_monitor(cb, PackageExtractEvent::extract_update);
 
+        try
         {
-            std::lock_guard<counting_semaphore> lock(PackageFetcherSemaphore::semaphore);
-            interruption_point();
-            LOG_DEBUG << "Decompressing '" << m_tarball_path.string() << "'";
-            try
+            const fs::u8path extract_path = get_extract_path(filename(), m_cache_path);
+            // Be sure the first writable cache doesn't contain invalid extracted package
+            clear_extract_path(extract_path);
+            // The extraction while downloading holds its own slot of the semaphore
+            if (!publish_stream_extraction(extract_path))
             {
-                const fs::u8path extract_path = get_extract_path(filename(), m_cache_path);
-                // Be sure the first writable cache doesn't contain invalid extracted package
-                clear_extract_path(extract_path);
-                extract_impl(m_tarball_path, extract_path, options);
-
+                std::lock_guard<counting_semaphore> lock(PackageFetcherSemaphore::semaphore);
                 interruption_point();
-                LOG_DEBUG << "Extracted to '" << extract_path.string() << "'";
-                write_repodata_record(extract_path);
-                update_urls_txt();
-                update_monitor(cb, PackageExtractEvent::extract_success);
-            }
-            catch (std::exception& e)
-            {
-                Console::instance().print(filename() + " extraction failed");
-                LOG_ERROR << "Error when extracting package: " << e.what();
-                update_monitor(cb, PackageExtractEvent::extract_failure);
-                return false;
+                LOG_DEBUG << "Decompressing '" << m_tarball_path.string() << "'";
+                // In-process extraction is reentrant, the semaphore bounds the concurrency
+                mamba::extract(m_tarball_path, extract_path, options);
             }
+
+            interruption_point();
+            LOG_DEBUG << "Extracted to '" << extract_path.string() << "'";
+            write_repodata_record(extract_path);
+            update_urls_txt();
+            update_monitor(cb, PackageExtractEvent::extract_success);
+        }
+        catch (std::exception& e)
+        {
+            Console::instance().print(filename() + " extraction failed");
+            LOG_ERROR << "Error when extracting package: " << e.what();
+            update_monitor(cb, PackageExtractEvent::extract_failure);
+            return false;
         }
         m_needs_extract = false;
         return true;
@@ -464,6 +511,24 @@ namespace mamba
         urls_txt << url() << std::endl;
     }
 
+    bool PackageFetcher::publish_stream_extraction(const fs::u8path& extract_path)
+    {
+        if (m_stream_extractor == nullptr)
+        {
+            return false;
+        }
+        // Only called once the tarball has been validated
+        auto extractor = std::move(m_stream_extractor);
+        if (!extractor->wait())
+        {
+            LOG_DEBUG << "Extraction while downloading failed, extracting '"
+                      << m_tarball_path.string() << "'";
+            return false;
+        }
+        fs::rename(extractor->destination(), extract_path);
+        return true;
+    }
+
     void PackageFetcher::update_monitor(progress_callback_t* cb, PackageExtractEvent event) const
     {
         if (cb)
@@ -5,11 +5,20 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
 #include <archive.h>
 #include <archive_entry.h>
 #include <reproc++/run.hpp>
 
 #include "mamba/core/context.hpp"
+#include "mamba/core/execution.hpp"
 #include "mamba/core/output.hpp"
 #include "mamba/core/package_handling.hpp"
 #include "mamba/core/package_paths.hpp"
@@ -30,6 +39,8 @@ namespace mamba
             /* .subproc_mode = */ context.command_params.is_mamba_exe
                 ? extract_subproc_mode::mamba_exe
                 : extract_subproc_mode::mamba_package,
+            /* .stream = */ context.stream_extract,
+            /* .timings = */ &context.timings,
         };
     }
 
@@ -68,6 +79,16 @@ namespace mamba
         const fs::u8path& m_file;
     };
 
+    namespace
+    {
+        // ``archive_write_disk_new`` reads the process umask by setting it to 0 and restoring it.
+        // Files created by other threads in the meantime would not get the umask applied, so the
+        // extractions hold this mutex in shared mode when they create files, and
+        // ``archive_write_disk_new`` holds it exclusively.
+        // Files created elsewhere in the process while extracting are not protected.
+        std::shared_mutex umask_mutex;
+    }
+
     class scoped_archive_read : non_copyable_base
     {
     public:
@@ -115,6 +136,7 @@ namespace mamba
 
         static scoped_archive_write write_disk()
         {
+            std::unique_lock<std::shared_mutex> lock(umask_mutex);
             return scoped_archive_write(archive_write_disk_new());
         }
 
@@ -525,25 +547,52 @@ namespace mamba
         };
     }
 
+    namespace
+    {
+        // Makes the archive entry path (and hardlink target) relative to ``root`` rather than to
+        // the process working directory.
+        // Absolute entries are refused, as ``ARCHIVE_EXTRACT_SECURE_NOABSOLUTEPATHS`` would do.
+        void rebase_archive_entry(archive_entry* entry, const std::string& root)
+        {
+            const char* path = archive_entry_pathname_utf8(entry);
+            if (path == nullptr)
+            {
+                throw std::runtime_error("Extraction: could not decode archive entry path.");
+            }
+            if (fs::u8path(path).has_root_path())
+            {
+                throw std::runtime_error(fmt::format("Extraction: path is absolute '{}'.", path));
+            }
+            archive_entry_update_pathname_utf8(entry, util::concat(root, "/", path).c_str());
+
+            if (const char* link = archive_entry_hardlink_utf8(entry))
+            {
+                archive_entry_update_hardlink_utf8(entry, util::concat(root, "/", link).c_str());
+            }
+        }
+    }
+
     void stream_extract_archive(
         scoped_archive_read& a,
         const fs::u8path& destination,
         const ExtractOptions& options
     )
     {
-        auto prev_path = fs::current_path();
         if (!fs::exists(destination))
         {
+            std::shared_lock<std::shared_mutex> lock(umask_mutex);
             fs::create_directories(destination);
         }
-        fs::current_path(destination);
+        // Entries are written with absolute paths instead of changing the working directory,
+        // so that extraction is reentrant.
+        // The destination is resolved since secure symlinks checks apply to the whole path.
+        const std::string root = fs::canonical(destination).string();
 
         /* Select which attributes we want to restore. */
         int flags = ARCHIVE_EXTRACT_TIME;
         flags |= ARCHIVE_EXTRACT_PERM;
         flags |= ARCHIVE_EXTRACT_SECURE_NODOTDOT;
         flags |= ARCHIVE_EXTRACT_SECURE_SYMLINKS;
-        flags |= ARCHIVE_EXTRACT_SECURE_NOABSOLUTEPATHS;
         flags |= ARCHIVE_EXTRACT_UNLINK;
 
         if (options.sparse)
@@ -574,7 +623,12 @@ namespace mamba
                 throw std::runtime_error(archive_error_string(a));
             }
 
-            r = archive_write_header(ext, entry);
+            rebase_archive_entry(entry, root);
+            {
+                // Creates the entry and its missing parent directories
+                std::shared_lock<std::shared_mutex> lock(umask_mutex);
+                r = archive_write_header(ext, entry);
+            }
             if (r < ARCHIVE_OK)
             {
                 throw std::runtime_error(archive_error_string(ext));
@@ -606,8 +660,6 @@ namespace mamba
                 throw std::runtime_error(archive_error_string(ext));
             }
         }
-
-        fs::current_path(prev_path);
     }
 
     static la_ssize_t file_read(archive*, void* client_data, const void** buff)
@@ -633,6 +685,92 @@ namespace mamba
         return archive_read_open1(a);
     }
 
+    namespace
+    {
+        // Extracts the parts of an opened `.conda` archive, ``file`` is only used for messages.
+        void extract_conda_entries(
+            scoped_archive_read& a,
+            const fs::u8path& file,
+            const fs::u8path& dest_dir,
+            const ExtractOptions& options,
+            const std::vector<std::string>& parts
+        )
+        {
+            conda_extract_context extract_context(a);
+
+            auto check_parts = [&parts](const std::string& name)
+            {
+                std::size_t pos = name.find_first_of('-');
+                if (pos == std::string::npos)
+                {
+                    return false;
+                }
+                std::string part = name.substr(0, pos);
+                if (std::find(parts.begin(), parts.end(), part) != parts.end())
+                {
+                    return true;
+                }
+                return false;
+            };
+
+            int r;
+            archive_entry* entry;
+            for (;;)
+            {
+                if (is_sig_interrupted())
+                {
+                    throw std::runtime_error("SIGINT received. Aborting extraction.");
+                }
+
+                r = archive_read_next_header(a, &entry);
+                if (r == ARCHIVE_EOF)
+                {
+                    break;
+                }
+                if (r < ARCHIVE_OK)
+                {
+                    throw std::runtime_error(archive_error_string(a));
+                }
+
+                fs::u8path p(archive_entry_pathname(entry));
+                if (p.extension() == ".zst" && check_parts(p.filename().string()))
+                {
+                    // extract zstd file
+                    scoped_archive_read inner;
+                    archive_read_support_filter_zstd(inner);
+                    archive_read_support_format_tar(inner);
+
+                    archive_read_open_archive_entry(inner, &extract_context);
+                    stream_extract_archive(inner, dest_dir, options);
+                }
+                else if (p.filename() == "metadata.json")
+                {
+                    std::size_t json_size = static_cast<std::size_t>(archive_entry_size(entry));
+                    if (json_size == 0)
+                    {
+                        LOG_INFO << "Package contains empty metadata.json file (" << file << ")";
+                        continue;
+                    }
+                    std::string json(json_size, '\0');
+                    archive_read_data(a, json.data(), json_size);
+                    try
+                    {
+                        auto obj = nlohmann::json::parse(json);
+                        if (obj["conda_pkg_format_version"] != 2)
+                        {
+                            LOG_WARNING << "Unsupported conda package format version (" << file
+                                        << ") - still trying to extract";
+                        }
+                    }
+                    catch (const std::exception& e)
+                    {
+                        LOG_WARNING << "Error parsing metadata.json (" << file << "): " << e.what();
+                    }
+                }
+            }
+        }
+    }
+
     void extract_conda(
         const fs::u8path& file,
         const fs::u8path& dest_dir,
@@ -643,84 +781,307 @@ namespace mamba
         scoped_archive_read a;
         archive_read_support_format_zip(a);
 
-        conda_extract_context extract_context(a);
-
-        if (archive_read_open_filename(a, file.string().c_str(), extract_context.buffer.size())
+        if (archive_read_open_filename(a, file.string().c_str(), download::get_zstd_buff_out_size())
             != ARCHIVE_OK)
         {
             throw std::runtime_error(archive_error_string(a));
         }
 
-        auto check_parts = [&parts](const std::string& name)
+        extract_conda_entries(a, file, dest_dir, options, parts);
+    }
+
+    /************************
+     * CondaStreamExtractor *
+     ************************/
+
+    struct CondaStreamExtractor::Impl
+    {
+        // The content is copied in blocks of a fixed size, reused once extracted.
+        static constexpr std::size_t block_capacity = 256 * 1024;
+
+        struct Block
         {
-            std::size_t pos = name.find_first_of('-');
-            if (pos == std::string::npos)
+            std::unique_ptr<char[]> data = nullptr;
+            std::size_t size = 0;
+        };
+
+        Impl(
+            fs::u8path destination,
+            ExtractOptions options,
+            counting_semaphore& semaphore,
+            std::size_t max_buffered_size
+        );
+
+        // Returns false if the extraction was already started or abandoned.
+        // Must be called with the mutex locked.
+        bool claim();
+        void run();
+        void abandon(std::string_view reason);
+        void append(std::string_view chunk);
+        static la_ssize_t read_chunk(archive* a, void* client_data, const void** buff);
+
+        fs::u8path destination;
+        ExtractOptions options;
+        counting_semaphore& semaphore;
+        std::size_t max_buffered_size;
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        // Filled blocks, in order, the last one may not be full.
+        std::deque<Block> blocks;
+        std::vector<Block> free_blocks;
+        // Block handed to libarchive, that must be kept alive until the next read.
+        Block current_block;
+        std::size_t buffered_size = 0;
+        std::size_t next_offset = 0;
+        bool scheduled = false;
+        bool started = false;
+        bool closed = false;
+        bool abandoned = false;
+        bool finished = false;
+        bool succeeded = false;
+    };
+
+    CondaStreamExtractor::Impl::Impl(
+        fs::u8path ldestination,
+        ExtractOptions loptions,
+        counting_semaphore& lsemaphore,
+        std::size_t lmax_buffered_size
+    )
+        : destination(std::move(ldestination))
+        , options(std::move(loptions))
+        , semaphore(lsemaphore)
+        , max_buffered_size(lmax_buffered_size)
+    {
+    }
+
+    bool CondaStreamExtractor::Impl::claim()
+    {
+        if (started || abandoned)
+        {
+            return false;
+        }
+        if (!semaphore.try_lock())
+        {
+            // The package is then extracted from the downloaded file, as any other.
+            abandon("too many extractions are running");
+            return false;
+        }
+        started = true;
+        return true;
+    }
+
+    void CondaStreamExtractor::Impl::run()
+    {
+        bool success = false;
+        try
+        {
+            scoped_archive_read a;
+            archive_read_support_format_zip(a);
+            archive_read_set_read_callback(a, read_chunk);
+            archive_read_set_callback_data(a, this);
+            if (archive_read_open1(a) != ARCHIVE_OK)
             {
-                return false;
+                throw std::runtime_error(archive_error_string(a));
             }
-            std::string part = name.substr(0, pos);
-            if (std::find(parts.begin(), parts.end(), part) != parts.end())
+            extract_conda_entries(a, destination, destination, options, { "info", "pkg" });
+            success = true;
+        }
+        catch (const std::exception& e)
+        {
+            LOG_DEBUG << "Extraction while downloading to '" << destination.string()
+                      << "' stopped: " << e.what();
+        }
+        semaphore.unlock();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            succeeded = success && !abandoned;
+            finished = true;
+            blocks.clear();
+            free_blocks.clear();
+            current_block = {};
+            buffered_size = 0;
+        }
+        cv.notify_all();
+    }
+
+    // Must be called with the mutex locked.
+    void CondaStreamExtractor::Impl::abandon(std::string_view reason)
+    {
+        if (!abandoned)
+        {
+            LOG_DEBUG << "Abandoning extraction while downloading to '" << destination.string()
+                      << "': " << reason;
+        }
+        abandoned = true;
+        succeeded = false;
+        blocks.clear();
+        free_blocks.clear();
+        buffered_size = 0;
+    }
+
+    // Must be called with the mutex locked.
+    void CondaStreamExtractor::Impl::append(std::string_view chunk)
+    {
+        buffered_size += chunk.size();
+        while (!chunk.empty())
+        {
+            if (blocks.empty() || (blocks.back().size == block_capacity))
             {
-                return true;
+                if (free_blocks.empty())
+                {
+                    blocks.push_back({ std::unique_ptr<char[]>(new char[block_capacity]), 0 });
+                }
+                else
+                {
+                    blocks.push_back(std::move(free_blocks.back()));
+                    free_blocks.pop_back();
+                }
             }
-            return false;
-        };
+            auto& block = blocks.back();
+            const auto size = std::min(chunk.size(), block_capacity - block.size);
+            std::copy_n(chunk.data(), size, block.data.get() + block.size);
+            block.size += size;
+            chunk.remove_prefix(size);
+        }
+    }
 
-        int r;
-        archive_entry* entry;
-        for (;;)
+    la_ssize_t
+    CondaStreamExtractor::Impl::read_chunk(archive* a, void* client_data, const void** buff)
+    {
+        auto* self = static_cast<Impl*>(client_data);
+        std::unique_lock<std::mutex> lock(self->mutex);
+        if (self->current_block.data != nullptr)
         {
-            if (is_sig_interrupted())
+            self->current_block.size = 0;
+            self->free_blocks.push_back(std::move(self->current_block));
+            self->current_block = {};
+        }
+        self->cv.wait(
+            lock,
+            [self] { return !self->blocks.empty() || self->closed || self->abandoned; }
+        );
+        if (self->abandoned)
+        {
+            archive_set_error(a, ECANCELED, "Extraction abandoned");
+            return -1;
+        }
+        if (self->blocks.empty())
+        {
+            return 0;
+        }
+        // The block is taken even if not full, the next chunks are appended to a new one.
+        self->current_block = std::move(self->blocks.front());
+        self->blocks.pop_front();
+        self->buffered_size -= self->current_block.size;
+        *buff = self->current_block.data.get();
+        return static_cast<la_ssize_t>(self->current_block.size);
+    }
+
+    CondaStreamExtractor::CondaStreamExtractor(
+        fs::u8path destination,
+        ExtractOptions options,
+        counting_semaphore& semaphore,
+        std::size_t max_buffered_size
+    )
+        : p_impl(std::make_shared<Impl>(
+              std::move(destination),
+              std::move(options),
+              semaphore,
+              max_buffered_size
+          ))
+    {
+    }
+
+    CondaStreamExtractor::~CondaStreamExtractor()
+    {
+        {
+            std::unique_lock<std::mutex> lock(p_impl->mutex);
+            p_impl->abandoned = true;
+            p_impl->cv.notify_all();
+            // A submitted extraction that has not started does nothing once abandoned.
+            p_impl->cv.wait(lock, [&] { return !p_impl->started || p_impl->finished; });
+        }
+        std::error_code ec;
+        fs::remove_all(p_impl->destination, ec);
+    }
+
+    const fs::u8path& CondaStreamExtractor::destination() const
+    {
+        return p_impl->destination;
+    }
+
+    void CondaStreamExtractor::feed(std::size_t offset, std::string_view chunk)
+    {
+        {
+            std::lock_guard<std::mutex> lock(p_impl->mutex);
+            if (p_impl->abandoned)
             {
-                throw std::runtime_error("SIGINT received. Aborting extraction.");
+                return;
             }
-
-            r = archive_read_next_header(a, &entry);
-            if (r == ARCHIVE_EOF)
+            if (offset != p_impl->next_offset || p_impl->closed)
             {
-                break;
+                p_impl->abandon("content is not contiguous");
+                return;
             }
-            if (r < ARCHIVE_OK)
+            p_impl->next_offset += chunk.size();
+            // The extraction may complete before the end of the content (the zip central
+            // directory is not needed).
+            if (p_impl->finished)
             {
-                throw std::runtime_error(archive_error_string(a));
+                return;
             }
-
-            fs::u8path p(archive_entry_pathname(entry));
-            if (p.extension() == ".zst" && check_parts(p.filename().string()))
+            if (p_impl->buffered_size + chunk.size() > p_impl->max_buffered_size)
             {
-                // extract zstd file
-                scoped_archive_read inner;
-                archive_read_support_filter_zstd(inner);
-                archive_read_support_format_tar(inner);
-
-                archive_read_open_archive_entry(inner, &extract_context);
-                stream_extract_archive(inner, dest_dir, options);
+                p_impl->abandon("extraction is slower than the download");
+                return;
             }
-            else if (p.filename() == "metadata.json")
+            p_impl->append(chunk);
+            if (!p_impl->scheduled)
             {
-                std::size_t json_size = static_cast<std::size_t>(archive_entry_size(entry));
-                if (json_size == 0)
-                {
-                    LOG_INFO << "Package contains empty metadata.json file (" << file << ")";
-                    continue;
-                }
-                std::string json(json_size, '\0');
-                archive_read_data(a, json.data(), json_size);
-                try
-                {
-                    auto obj = nlohmann::json::parse(json);
-                    if (obj["conda_pkg_format_version"] != 2)
+                p_impl->scheduled = true;
+                MainExecutor::instance().submit(
+                    [impl = p_impl]
                     {
-                        LOG_WARNING << "Unsupported conda package format version (" << file
-                                    << ") - still trying to extract";
+                        {
+                            std::lock_guard<std::mutex> task_lock(impl->mutex);
+                            if (!impl->claim())
+                            {
+                                return;
+                            }
+                        }
+                        impl->run();
                     }
-                }
-                catch (const std::exception& e)
-                {
-                    LOG_WARNING << "Error parsing metadata.json (" << file << "): " << e.what();
-                }
+                );
             }
         }
+        p_impl->cv.notify_all();
+    }
+
+    void CondaStreamExtractor::close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(p_impl->mutex);
+            p_impl->closed = true;
+        }
+        p_impl->cv.notify_all();
+    }
+
+    bool CondaStreamExtractor::wait()
+    {
+        std::unique_lock<std::mutex> lock(p_impl->mutex);
+        p_impl->closed = true;
+        p_impl->cv.notify_all();
+        if (p_impl->scheduled && p_impl->claim())
+        {
+            // All the content is available, the extraction runs on this thread.
+            lock.unlock();
+            p_impl->run();
+            lock.lock();
+        }
+        p_impl->cv.wait(lock, [&] { return !p_impl->started || p_impl->finished; });
+        return p_impl->succeeded;
     }
 
     static fs::u8path extract_dest_dir(const fs::u8path& file)
@@ -739,9 +1100,6 @@ namespace mamba
 
     void extract(const fs::u8path& file, const fs::u8path& dest, const ExtractOptions& options)
     {
-        static std::mutex extract_mutex;
-        std::lock_guard<std::mutex> lock(extract_mutex);
-
         if (util::ends_with(file.string(), ".tar.bz2"))
         {
             extract_archive(file, dest, options);
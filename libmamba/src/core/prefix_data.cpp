@@ -4,10 +4,16 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <fstream>
+#include <optional>
 #include <string_view>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <fmt/ranges.h>
 #include <reproc++/run.hpp>
@@ -21,8 +27,12 @@
 #include "mamba/specs/conda_url.hpp"
 #include "mamba/util/environment.hpp"
 #include "mamba/util/graph.hpp"
+#include "mamba/util/random.hpp"
 #include "mamba/util/string.hpp"
 
+#include "./prefix_index.hpp"
+#include "./transaction_context.hpp"
+
 namespace mamba
 {
     auto
@@ -47,6 +57,17 @@ namespace mamba
         }
     }
 
+    namespace
+    {
+        auto load_package_record(const fs::u8path& path) -> specs::PackageInfo
+        {
+            auto infile = open_ifstream(path);
+            nlohmann::json j;
+            infile >> j;
+            return j.get<specs::PackageInfo>();
+        }
+    }
+
     PrefixData::PrefixData(const fs::u8path& prefix_path, ChannelContext& channel_context, bool no_pip)
         : m_history(prefix_path, channel_context)
         , m_prefix_path(prefix_path)
@@ -55,12 +76,11 @@ namespace mamba
         auto conda_meta_dir = m_prefix_path / "conda-meta";
         if (lexists(conda_meta_dir))
         {
-            for (auto& p : fs::directory_iterator(conda_meta_dir))
+            // The prefix is not locked, so the index is only written by transactions.
+            const auto index = PrefixIndex::refresh(conda_meta_dir, /* write= */ false);
+            for (const auto& record : index.records())
             {
-                if (util::ends_with(p.path().string(), ".json"))
-                {
-                    load_single_record(p.path());
-                }
+                add_package_record(record.info);
             }
         }
         // Load packages installed with pip if `no_pip` is not set to `true`
@@ -182,11 +202,11 @@ namespace mamba
     void PrefixData::load_single_record(const fs::u8path& path)
     {
         LOG_INFO << "Loading single package record: " << path;
-        auto infile = open_ifstream(path);
-        nlohmann::json j;
-        infile >> j;
-        auto prec = j.get<specs::PackageInfo>();
+        add_package_record(load_package_record(path));
+    }
 
+    void PrefixData::add_package_record(specs::PackageInfo prec)
+    {
         // Some versions of micromamba constructor generate repodata_record.json
         // and conda-meta json files with channel names while mamba expects
         // specs::PackageInfo channels to be platform urls. This fixes the issue described
@@ -201,69 +221,110 @@ namespace mamba
         m_package_records.insert({ prec.name, std::move(prec) });
     }
 
-    // Load python packages installed with pip in the site-packages of the prefix.
-    void PrefixData::load_site_packages()
+    namespace
     {
-        LOG_INFO << "Loading site packages";
+        struct PipPackage
+        {
+            std::string name;
+            std::string version;
+        };
 
-        // Look for `pip` package and return if it doesn't exist
-        auto python_pkg_record = m_package_records.find("pip");
-        if (python_pkg_record == m_package_records.end())
+        void to_json(nlohmann::json& j, const PipPackage& package)
         {
-            LOG_DEBUG << "`pip` not found";
-            return;
+            j = nlohmann::json{ { "name", package.name }, { "version", package.version } };
         }
 
-        // Run `pip inspect`
-        std::string out, err;
+        void from_json(const nlohmann::json& j, PipPackage& package)
+        {
+            j.at("name").get_to(package.name);
+            j.at("version").get_to(package.version);
+        }
 
-        const auto get_python_path = [&]
-        { return util::which_in("python", util::get_path_dirs(m_prefix_path)).string(); };
+        // Runs ``pip inspect`` in the prefix, returning the platform and the packages installed
+        // with pip.
+        auto run_pip_inspect(const fs::u8path& prefix)
+            -> std::pair<std::string, std::vector<PipPackage>>
+        {
+            // Run `pip inspect`
+            std::string out, err;
+
+            const auto get_python_path = [&]
+            { return util::which_in("python", util::get_path_dirs(prefix)).string(); };
+
+            const auto args = std::array<std::string, 6>{ get_python_path(), "-q",     "-m", "pip",
+                                                          "inspect",         "--local" };
+
+            const std::vector<std::pair<std::string, std::string>> env{
+                { "PYTHONIOENCODING", "utf-8" },
+                { "NO_COLOR", "1" },
+                { "PIP_NO_COLOR", "1" },
+            };
+            reproc::options run_options;
+            run_options.env.extra = reproc::env{ env };
+
+            {  // Scoped environment changes
+
+                // We need FORCE_COLOR to be removed to avoid rich output,
+                // we restore it as soon as the command is run.
+                const auto maybe_previous_force_color = util::get_env("FORCE_COLOR");
+                util::unset_env("FORCE_COLOR");
+                on_scope_exit _{ [&]
+                                 {
+                                     if (maybe_previous_force_color)
+                                     {
+                                         util::set_env(
+                                             "FORCE_COLOR",
+                                             maybe_previous_force_color.value()
+                                         );
+                                     }
+                                 } };
+
+                LOG_TRACE << "Running command: "
+                          << fmt::format(
+                                 "{}\n  env options (FORCE_COLOR is unset):{}",
+                                 fmt::join(args, " "),
+                                 fmt::join(env, " ")
+                             );
+
+                auto [status, ec] = reproc::run(
+                    args,
+                    run_options,
+                    reproc::sink::string(out),
+                    reproc::sink::string(err)
+                );
 
-        const auto args = std::array<std::string, 6>{ get_python_path(), "-q",     "-m", "pip",
-                                                      "inspect",         "--local" };
+                if (ec)
+                {
+                    const auto message = fmt::format(
+                        "failed to run python command :\n  error: {}\n  command ran: {}\n  env options:{}\n-> output:\n{}\n\n-> error output:{}",
+                        ec.message(),
+                        fmt::join(args, " "),
+                        fmt::join(env, " "),
+                        out,
+                        err
+                    );
+                    throw mamba_error{ message, mamba_error_code::internal_failure };
+                }
+            }
 
-        const std::vector<std::pair<std::string, std::string>> env{
-            { "PYTHONIOENCODING", "utf-8" },
-            { "NO_COLOR", "1" },
-            { "PIP_NO_COLOR", "1" },
-        };
-        reproc::options run_options;
-        run_options.env.extra = reproc::env{ env };
-
-        {  // Scoped environment changes
-
-            // We need FORCE_COLOR to be removed to avoid rich output,
-            // we restore it as soon as the command is run.
-            const auto maybe_previous_force_color = util::get_env("FORCE_COLOR");
-            util::unset_env("FORCE_COLOR");
-            on_scope_exit _{ [&]
-                             {
-                                 if (maybe_previous_force_color)
-                                 {
-                                     util::set_env("FORCE_COLOR", maybe_previous_force_color.value());
-                                 }
-                             } };
-
-            LOG_TRACE << "Running command: "
-                      << fmt::format(
-                             "{}\n  env options (FORCE_COLOR is unset):{}",
-                             fmt::join(args, " "),
-                             fmt::join(env, " ")
-                         );
-
-            auto [status, ec] = reproc::run(
-                args,
-                run_options,
-                reproc::sink::string(out),
-                reproc::sink::string(err)
-            );
+            // Nothing installed with `pip`
+            if (out.empty())
+            {
+                LOG_DEBUG << "Nothing installed with `pip`";
+                return {};
+            }
 
-            if (ec)
+            LOG_TRACE << "Parsing `pip inspect` output:\n" << out;
+            nlohmann::json j;
+            try
+            {
+                j = nlohmann::json::parse(out);
+            }
+            catch (const std::exception& parse_error)
             {
                 const auto message = fmt::format(
-                    "failed to run python command :\n  error: {}\n  command ran: {}\n  env options:{}\n-> output:\n{}\n\n-> error output:{}",
-                    ec.message(),
+                    "failed to parse python command output:\n  error: {}\n  command ran: {}\n  env options:{}\n-> output:\n{}\n\n-> error output:{}",
+                    parse_error.what(),
                     fmt::join(args, " "),
                     fmt::join(env, " "),
                     out,
@@ -271,65 +332,260 @@ namespace mamba
                 );
                 throw mamba_error{ message, mamba_error_code::internal_failure };
             }
+
+            auto result = std::pair<std::string, std::vector<PipPackage>>();
+            // Set platform by concatenating `sys_platform` and `platform_machine` to
+            // have something equivalent to `conda-forge`
+            if (j.contains("environment"))
+            {
+                result.first = j["environment"]["sys_platform"].get<std::string>() + "-"
+                               + j["environment"]["platform_machine"].get<std::string>();
+            }
+            if (j.contains("installed") && j["installed"].is_array())
+            {
+                for (const auto& package : j["installed"])
+                {
+                    // Get the package metadata, if installed with `pip`
+                    if (package.contains("installer") && package["installer"] == "pip")
+                    {
+                        if (package.contains("metadata"))
+                        {
+                            // NOTE As checking the presence of all used keys in the json object
+                            // can be cumbersome and might affect the code readability, the
+                            // elements where the check with `contains` is skipped are considered
+                            // mandatory. If a bug is ever to occur in the future, checking the
+                            // relevant key with `contains` should be introduced then.
+                            result.second.push_back({ package["metadata"]["name"],
+                                                      package["metadata"]["version"] });
+                        }
+                    }
+                }
+            }
+            return result;
         }
 
-        // Nothing installed with `pip`
-        if (out.empty())
+        // Bumped whenever the layout of the cache changes.
+        constexpr int pip_cache_version = 1;
+
+        auto pip_cache_path(const fs::u8path& prefix) -> fs::u8path
         {
-            LOG_DEBUG << "Nothing installed with `pip`";
-            return;
+            return prefix / "conda-meta" / ".mamba-pip-packages";
         }
 
-        LOG_TRACE << "Parsing `pip inspect` output:\n" << out;
-        nlohmann::json j;
-        try
+        /**
+         * The key identifying the state of the site-packages directory.
+         *
+         * Every ``*.dist-info`` directory with its modification time, which changes when pip
+         * installs, upgrades, or removes a package.
+         */
+        auto site_packages_key(const fs::u8path& site_packages) -> nlohmann::json
+        {
+            auto entries = std::vector<std::pair<std::string, std::int64_t>>();
+            for (const auto& entry : fs::directory_iterator(site_packages))
+            {
+                auto name = entry.path().filename().string();
+                if (util::ends_with(name, ".dist-info"))
+                {
+                    const auto mtime = entry.last_write_time().time_since_epoch().count();
+                    entries.emplace_back(std::move(name), static_cast<std::int64_t>(mtime));
+                }
+            }
+            std::sort(entries.begin(), entries.end());
+            return entries;
+        }
+
+        // Reads the first line of a file, without the trailing whitespaces.
+        auto read_first_line(const fs::u8path& path) -> std::optional<std::string>
+        {
+            std::ifstream in(path.std_path());
+            std::string line;
+            if (!in || !std::getline(in, line))
+            {
+                return std::nullopt;
+            }
+            return std::string(util::rstrip(line));
+        }
+
+        /**
+         * Read the ``Name`` and ``Version`` headers of a ``METADATA`` file.
+         *
+         * Return nothing if any of them is missing.
+         */
+        auto read_dist_metadata(const fs::u8path& path) -> std::optional<PipPackage>
         {
-            j = nlohmann::json::parse(out);
+            std::ifstream in(path.std_path());
+            auto package = PipPackage();
+            std::string line;
+            // Headers stop at the first empty line, followed by the description.
+            while (std::getline(in, line) && !util::strip(line).empty())
+            {
+                const auto [key, value] = util::split_once(line, ':');
+                if (!value.has_value())
+                {
+                    continue;
+                }
+                if (util::to_lower(key) == "name")
+                {
+                    package.name = util::strip(value.value());
+                }
+                else if (util::to_lower(key) == "version")
+                {
+                    package.version = util::strip(value.value());
+                }
+            }
+            if (package.name.empty() || package.version.empty())
+            {
+                return std::nullopt;
+            }
+            return package;
         }
-        catch (const std::exception& parse_error)
+
+        /**
+         * Read the packages installed by pip from the ``*.dist-info`` directories.
+         *
+         * Return nothing if they cannot be read, in which case ``pip inspect`` should be used.
+         */
+        auto scan_pip_packages(const fs::u8path& site_packages)
+            -> std::optional<std::vector<PipPackage>>
         {
-            const auto message = fmt::format(
-                "failed to parse python command output:\n  error: {}\n  command ran: {}\n  env options:{}\n-> output:\n{}\n\n-> error output:{}",
-                parse_error.what(),
-                fmt::join(args, " "),
-                fmt::join(env, " "),
-                out,
-                err
+            std::error_code ec;
+            if (!fs::is_directory(site_packages, ec))
+            {
+                return std::nullopt;
+            }
+
+            auto packages = std::vector<PipPackage>();
+            for (const auto& entry : fs::directory_iterator(site_packages))
+            {
+                if (!util::ends_with(entry.path().filename().string(), ".dist-info"))
+                {
+                    continue;
+                }
+                // Like ``pip inspect``, only the packages installed by pip itself are kept.
+                const auto installer = read_first_line(entry.path() / "INSTALLER");
+                if (installer != "pip")
+                {
+                    continue;
+                }
+                auto package = read_dist_metadata(entry.path() / "METADATA");
+                if (!package.has_value())
+                {
+                    LOG_DEBUG << "Could not read the metadata of " << entry.path();
+                    return std::nullopt;
+                }
+                packages.push_back(std::move(package).value());
+            }
+            std::sort(
+                packages.begin(),
+                packages.end(),
+                [](const auto& lhs, const auto& rhs) { return lhs.name < rhs.name; }
             );
-            throw mamba_error{ message, mamba_error_code::internal_failure };
+            return packages;
         }
+    }
 
-        if (j.contains("installed") && j["installed"].is_array())
+    // Load python packages installed with pip in the site-packages of the prefix.
+    void PrefixData::load_site_packages()
+    {
+        LOG_INFO << "Loading site packages";
+
+        // Look for `pip` package and return if it doesn't exist
+        auto python_pkg_record = m_package_records.find("pip");
+        if (python_pkg_record == m_package_records.end())
         {
-            for (const auto& package : j["installed"])
+            LOG_DEBUG << "`pip` not found";
+            return;
+        }
+
+        // The result of the previous ``pip inspect`` is reused while no package was installed
+        // or removed, and updated by reading the ``dist-info`` directories when possible.
+        auto site_packages = fs::u8path();
+        if (auto python = m_package_records.find("python"); python != m_package_records.end())
+        {
+            site_packages = m_prefix_path
+                            / get_python_site_packages_short_path(
+                                compute_short_python_version(python->second.version)
+                            );
+        }
+        auto key = nlohmann::json();
+        std::error_code ec;
+        if (!site_packages.empty() && fs::is_directory(site_packages, ec))
+        {
+            key = site_packages_key(site_packages);
+        }
+
+        auto cache = nlohmann::json();
+        if (std::ifstream in(pip_cache_path(m_prefix_path).std_path()); in)
+        {
+            cache = nlohmann::json::parse(in, nullptr, /* allow_exceptions= */ false);
+        }
+        const bool cache_usable = cache.is_object()
+                                  && (cache.value("version", 0) == pip_cache_version)
+                                  && cache.contains("platform") && cache.contains("packages");
+
+        auto platform = std::string();
+        auto packages = std::vector<PipPackage>();
+        if (cache_usable && !key.is_null() && (cache.value("key", nlohmann::json()) == key))
+        {
+            LOG_DEBUG << "Using cached pip packages";
+            platform = cache["platform"].get<std::string>();
+            packages = cache["packages"].get<std::vector<PipPackage>>();
+        }
+        else
+        {
+            // The platform is not known without running python, but does not change.
+            auto scanned = (cache_usable && !key.is_null()) ? scan_pip_packages(site_packages)
+                                                            : std::nullopt;
+            if (scanned.has_value())
             {
-                // Get the package metadata, if installed with `pip`
-                if (package.contains("installer") && package["installer"] == "pip")
+                LOG_DEBUG << "Read pip packages from " << site_packages;
+                platform = cache["platform"].get<std::string>();
+                packages = std::move(scanned).value();
+            }
+            else
+            {
+                std::tie(platform, packages) = run_pip_inspect(m_prefix_path);
+            }
+
+            if (!key.is_null())
+            {
+                const auto new_cache = nlohmann::json{ { "version", pip_cache_version },
+                                                       { "key", key },
+                                                       { "platform", platform },
+                                                       { "packages", packages } };
+                // Written aside and renamed, so that it is never read partially written.
+                const auto path = pip_cache_path(m_prefix_path);
+                const auto tmp_path = path.parent_path()
+                                      / util::concat(
+                                          ".mamba-pip-packages.",
+                                          util::generate_random_alphanumeric_string(8)
+                                      );
+                std::ofstream out(tmp_path.std_path());
+                out << new_cache.dump();
+                out.close();
+                std::error_code write_ec;
+                if (!out.fail())
                 {
-                    if (package.contains("metadata"))
-                    {
-                        // NOTE As checking the presence of all used keys in the json object can be
-                        // cumbersome and might affect the code readability, the elements where the
-                        // check with `contains` is skipped are considered mandatory. If a bug is
-                        // ever to occur in the future, checking the relevant key with `contains`
-                        // should be introduced then.
-                        auto prec = specs::PackageInfo(
-                            package["metadata"]["name"],
-                            package["metadata"]["version"],
-                            "pypi_0",
-                            "pypi"
-                        );
-                        // Set platform by concatenating `sys_platform` and `platform_machine` to
-                        // have something equivalent to `conda-forge`
-                        if (j.contains("environment"))
-                        {
-                            prec.platform = j["environment"]["sys_platform"].get<std::string>() + "-"
-                                            + j["environment"]["platform_machine"].get<std::string>();
-                        }
-                        m_pip_package_records.insert({ prec.name, std::move(prec) });
-                    }
+                    fs::rename(tmp_path, path, write_ec);
+                }
+                if (out.fail() || write_ec)
+                {
+                    LOG_DEBUG << "Could not write " << path;
+                    fs::remove(tmp_path, write_ec);
                 }
             }
         }
+
+        for (auto& package : packages)
+        {
+            auto prec = specs::PackageInfo(
+                std::move(package.name),
+                std::move(package.version),
+                "pypi_0",
+                "pypi"
+            );
+            prec.platform = platform;
+            m_pip_package_records.insert({ prec.name, std::move(prec) });
+        }
     }
 }  // namespace mamba
@@ -0,0 +1,530 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+#include <simdjson.h>
+
+#include "mamba/core/execution.hpp"
+#include "mamba/core/output.hpp"
+#include "mamba/core/util.hpp"
+#include "mamba/util/random.hpp"
+#include "mamba/util/string.hpp"
+
+#include "./prefix_index.hpp"
+
+namespace mamba
+{
+    namespace
+    {
+        // Bumped whenever the layout of the index changes.
+        constexpr std::string_view index_magic = "mamba-ix";
+        constexpr std::uint32_t index_version = 2;
+
+        auto time_to_int(fs::file_time_type time) -> std::int64_t
+        {
+            return time.time_since_epoch().count();
+        }
+
+        /***************************************
+         *  Reading json records with simdjson  *
+         ***************************************/
+
+        template <class JSONValue>
+        auto read_string_list(JSONValue&& value) -> std::vector<std::string>
+        {
+            auto list = std::vector<std::string>();
+            for (auto elem : value.get_array())
+            {
+                list.emplace_back(elem.get_string().value());
+            }
+            return list;
+        }
+
+        /**
+         * Read the specs::PackageInfo fields of a conda-meta record.
+         *
+         * The large ``files`` and ``paths_data`` arrays are skipped without being parsed.
+         * Throw a ``simdjson::simdjson_error`` on values that are not of the expected type, in
+         * which case the file should be read with ``nlohmann::json``.
+         */
+        void parse_record(
+            simdjson::ondemand::parser& parser,
+            const fs::u8path& path,
+            PrefixIndex::Record& record
+        )
+        {
+            const auto content = simdjson::padded_string::load(path.string()).value();
+            auto doc = parser.iterate(content);
+
+            auto& pkg = record.info;
+            auto build = std::optional<std::string>();
+            auto build_string = std::string();
+            for (auto field : doc.get_object())
+            {
+                const std::string_view key = field.unescaped_key();
+                auto value = field.value();
+                const auto read_string = [&](std::string& out)
+                { out = std::string(value.get_string().value()); };
+
+                if (key == "name")
+                {
+                    read_string(pkg.name);
+                }
+                else if (key == "version")
+                {
+                    read_string(pkg.version);
+                }
+                else if (key == "channel")
+                {
+                    read_string(pkg.channel);
+                }
+                else if (key == "url")
+                {
+                    read_string(pkg.package_url);
+                }
+                else if (key == "subdir")
+                {
+                    read_string(pkg.platform);
+                }
+                else if (key == "fn")
+                {
+                    read_string(pkg.filename);
+                }
+                else if (key == "size")
+                {
+                    pkg.size = value.get_uint64().value();
+                }
+                else if (key == "timestamp")
+                {
+                    pkg.timestamp = value.get_uint64().value();
+                }
+                else if (key == "build")
+                {
+                    read_string(build.emplace());
+                }
+                else if (key == "build_string")
+                {
+                    read_string(build_string);
+                }
+                else if (key == "build_number")
+                {
+                    pkg.build_number = value.get_uint64().value();
+                }
+                else if (key == "license")
+                {
+                    read_string(pkg.license);
+                }
+                else if (key == "md5")
+                {
+                    read_string(pkg.md5);
+                }
+                else if (key == "sha256")
+                {
+                    read_string(pkg.sha256);
+                }
+                else if (key == "signatures")
+                {
+                    read_string(pkg.signatures);
+                }
+                else if (key == "track_features")
+                {
+                    if (value.type().value() == simdjson::ondemand::json_type::array)
+                    {
+                        pkg.track_features = read_string_list(value);
+                    }
+                    else if (const std::string_view features = value.get_string().value();
+                             !features.empty())
+                    {
+                        // Split empty string would have an empty element
+                        pkg.track_features = util::split(features, ",");
+                    }
+                }
+                else if (key == "noarch")
+                {
+                    pkg.noarch = nlohmann::json::parse(value.raw_json().value());
+                }
+                else if (key == "depends")
+                {
+                    pkg.dependencies = read_string_list(value);
+                }
+                else if (key == "constrains")
+                {
+                    pkg.constrains = read_string_list(value);
+                }
+            }
+            // Same handling of the placeholder value as ``from_json``
+            if (build.has_value() && (*build != "<UNKNOWN>"))
+            {
+                pkg.build_string = std::move(*build);
+            }
+            else
+            {
+                pkg.build_string = std::move(build_string);
+            }
+        }
+
+        /**********************************
+         *  Binary encoding of the index  *
+         **********************************/
+
+        class IndexWriter
+        {
+        public:
+
+            template <typename Int>
+            void write_int(Int value)
+            {
+                const auto* bytes = reinterpret_cast<const char*>(&value);
+                m_data.append(bytes, sizeof(value));
+            }
+
+            void write_string(std::string_view str)
+            {
+                write_int(static_cast<std::uint32_t>(str.size()));
+                m_data.append(str);
+            }
+
+            void write_list(const std::vector<std::string>& list)
+            {
+                write_int(static_cast<std::uint32_t>(list.size()));
+                for (const auto& str : list)
+                {
+                    write_string(str);
+                }
+            }
+
+            void write_raw(std::string_view data)
+            {
+                m_data.append(data);
+            }
+
+            [[nodiscard]] auto data() const -> const std::string&
+            {
+                return m_data;
+            }
+
+        private:
+
+            std::string m_data;
+        };
+
+        class IndexReader
+        {
+        public:
+
+            explicit IndexReader(std::string_view data)
+                : m_data(data)
+            {
+            }
+
+            template <typename Int>
+            auto read_int() -> Int
+            {
+                auto value = Int();
+                std::memcpy(&value, read_raw(sizeof(value)).data(), sizeof(value));
+                return value;
+            }
+
+            auto read_string() -> std::string
+            {
+                const auto size = read_int<std::uint32_t>();
+                return std::string(read_raw(size));
+            }
+
+            auto read_list() -> std::vector<std::string>
+            {
+                const auto size = read_int<std::uint32_t>();
+                auto list = std::vector<std::string>();
+                list.reserve(std::min<std::size_t>(size, m_data.size()));
+                for (std::uint32_t i = 0; i < size; ++i)
+                {
+                    list.push_back(read_string());
+                }
+                return list;
+            }
+
+            auto read_raw(std::size_t size) -> std::string_view
+            {
+                if (size > m_data.size())
+                {
+                    throw std::runtime_error("Truncated prefix index");
+                }
+                const auto out = m_data.substr(0, size);
+                m_data.remove_prefix(size);
+                return out;
+            }
+
+            [[nodiscard]] auto done() const -> bool
+            {
+                return m_data.empty();
+            }
+
+        private:
+
+            std::string_view m_data;
+        };
+
+        void encode_record(IndexWriter& out, const PrefixIndex::Record& record)
+        {
+            const auto& pkg = record.info;
+            out.write_string(record.filename);
+            out.write_int(record.mtime);
+            out.write_int(record.file_size);
+            out.write_string(pkg.name);
+            out.write_string(pkg.version);
+            out.write_string(pkg.build_string);
+            out.write_int<std::uint64_t>(pkg.build_number);
+            out.write_string(pkg.channel);
+            out.write_string(pkg.package_url);
+            out.write_string(pkg.platform);
+            out.write_string(pkg.filename);
+            out.write_string(pkg.license);
+            out.write_string(pkg.md5);
+            out.write_string(pkg.sha256);
+            out.write_string(pkg.signatures);
+            out.write_list(pkg.track_features);
+            out.write_list(pkg.dependencies);
+            out.write_list(pkg.constrains);
+            out.write_int(static_cast<std::uint8_t>(pkg.noarch));
+            out.write_int<std::uint64_t>(pkg.size);
+            out.write_int<std::uint64_t>(pkg.timestamp);
+        }
+
+        auto decode_record(IndexReader& in) -> PrefixIndex::Record
+        {
+            auto record = PrefixIndex::Record();
+            auto& pkg = record.info;
+            record.filename = in.read_string();
+            record.mtime = in.read_int<std::int64_t>();
+            record.file_size = in.read_int<std::uint64_t>();
+            pkg.name = in.read_string();
+            pkg.version = in.read_string();
+            pkg.build_string = in.read_string();
+            pkg.build_number = in.read_int<std::uint64_t>();
+            pkg.channel = in.read_string();
+            pkg.package_url = in.read_string();
+            pkg.platform = in.read_string();
+            pkg.filename = in.read_string();
+            pkg.license = in.read_string();
+            pkg.md5 = in.read_string();
+            pkg.sha256 = in.read_string();
+            pkg.signatures = in.read_string();
+            pkg.track_features = in.read_list();
+            pkg.dependencies = in.read_list();
+            pkg.constrains = in.read_list();
+            const auto noarch = in.read_int<std::uint8_t>();
+            if (noarch >= specs::known_noarch_count())
+            {
+                throw std::runtime_error("Invalid noarch type in prefix index");
+            }
+            pkg.noarch = static_cast<specs::NoArchType>(noarch);
+            pkg.size = in.read_int<std::uint64_t>();
+            pkg.timestamp = in.read_int<std::uint64_t>();
+            return record;
+        }
+    }
+
+    /**********************************
+     *  Implementation of PrefixIndex  *
+     **********************************/
+
+    auto PrefixIndex::index_path(const fs::u8path& conda_meta_dir) -> fs::u8path
+    {
+        return conda_meta_dir / ".mamba-index";
+    }
+
+    auto PrefixIndex::read_record(const fs::u8path& path) -> Record
+    {
+        auto record = Record();
+        // A parser reuses its buffers across the files of a thread.
+        thread_local simdjson::ondemand::parser parser;
+        try
+        {
+            parse_record(parser, path, record);
+        }
+        catch (const simdjson::simdjson_error& e)
+        {
+            LOG_DEBUG << "Could not quickly read " << path << " (" << e.what()
+                      << "), falling back to full parsing";
+            auto infile = open_ifstream(path);
+            nlohmann::json j;
+            infile >> j;
+            record.info = j.get<specs::PackageInfo>();
+        }
+        return record;
+    }
+
+    auto PrefixIndex::read(const fs::u8path& conda_meta_dir) -> std::optional<PrefixIndex>
+    {
+        const auto path = index_path(conda_meta_dir);
+        std::error_code ec;
+        const std::uint64_t size = fs::file_size(path, ec);
+        if (ec)
+        {
+            return std::nullopt;
+        }
+
+        try
+        {
+            auto content = std::string(size, '\0');
+            std::ifstream in(path.std_path(), std::ios::binary);
+            in.read(content.data(), static_cast<std::streamsize>(content.size()));
+            if (!in)
+            {
+                throw std::runtime_error("Could not read the prefix index");
+            }
+
+            auto reader = IndexReader(content);
+            if ((reader.read_raw(index_magic.size()) != index_magic)
+                || (reader.read_int<std::uint32_t>() != index_version))
+            {
+                return std::nullopt;
+            }
+            auto index = PrefixIndex();
+            const auto count = reader.read_int<std::uint64_t>();
+            for (std::uint64_t i = 0; i < count; ++i)
+            {
+                index.m_records.push_back(decode_record(reader));
+            }
+            if (!reader.done())
+            {
+                return std::nullopt;
+            }
+            return { std::move(index) };
+        }
+        catch (const std::exception& e)
+        {
+            LOG_DEBUG << "Invalid prefix index " << path << ": " << e.what();
+            return std::nullopt;
+        }
+    }
+
+    auto PrefixIndex::refresh(const fs::u8path& conda_meta_dir, bool write) -> PrefixIndex
+    {
+        auto previous = read(conda_meta_dir);
+        auto previous_records = std::unordered_map<std::string, Record*>();
+        if (previous.has_value())
+        {
+            for (auto& record : previous->m_records)
+            {
+                previous_records.emplace(record.filename, &record);
+            }
+        }
+
+        // Records are kept in the directory order, along with their unchanged previous record.
+        auto index = PrefixIndex();
+        auto unchanged = std::vector<Record*>();
+        for (const auto& entry : fs::directory_iterator(conda_meta_dir))
+        {
+            auto filename = entry.path().filename().string();
+            if (!util::ends_with(filename, ".json"))
+            {
+                continue;
+            }
+            const auto mtime = time_to_int(entry.last_write_time());
+            const std::uint64_t file_size = entry.file_size();
+            const auto it = previous_records.find(filename);
+            const bool same = (it != previous_records.end()) && (it->second->mtime == mtime)
+                              && (it->second->file_size == file_size);
+            unchanged.push_back(same ? it->second : nullptr);
+            index.m_records.push_back({ std::move(filename), mtime, file_size, {} });
+        }
+
+        const bool same_records = previous.has_value()
+                                  && (index.m_records.size() == previous->m_records.size())
+                                  && std::none_of(
+                                      unchanged.cbegin(),
+                                      unchanged.cend(),
+                                      [](const Record* record) { return record == nullptr; }
+                                  );
+        if (same_records)
+        {
+            LOG_DEBUG << "Using prefix index " << index_path(conda_meta_dir);
+            return std::move(*previous);
+        }
+
+        auto to_parse = std::vector<std::size_t>();
+        for (std::size_t i = 0; i < index.m_records.size(); ++i)
+        {
+            if (unchanged[i] != nullptr)
+            {
+                index.m_records[i] = std::move(*unchanged[i]);
+            }
+            else
+            {
+                to_parse.push_back(i);
+            }
+        }
+
+        MainExecutor::instance().parallel_for(
+            to_parse.size(),
+            [&](std::size_t i)
+            {
+                auto& record = index.m_records[to_parse[i]];
+                LOG_INFO << "Loading single package record: " << record.filename;
+                record.info = read_record(conda_meta_dir / record.filename).info;
+            }
+        );
+
+        if (write)
+        {
+            try
+            {
+                index.write(conda_meta_dir);
+            }
+            catch (const std::exception& e)
+            {
+                LOG_DEBUG << "Could not write prefix index " << index_path(conda_meta_dir)
+                          << ": " << e.what();
+            }
+        }
+        return index;
+    }
+
+    void PrefixIndex::write(const fs::u8path& conda_meta_dir) const
+    {
+        auto out = IndexWriter();
+        out.write_raw(index_magic);
+        out.write_int(index_version);
+        out.write_int<std::uint64_t>(m_records.size());
+        for (const auto& record : m_records)
+        {
+            encode_record(out, record);
+        }
+
+        const auto path = index_path(conda_meta_dir);
+        const auto tmp_path = conda_meta_dir
+                              / util::concat(
+                                  ".mamba-index.",
+                                  util::generate_random_alphanumeric_string(8)
+                              );
+        {
+            std::ofstream file(tmp_path.std_path(), std::ios::binary);
+            file.write(out.data().data(), static_cast<std::streamsize>(out.data().size()));
+            file.close();
+            if (file.fail())
+            {
+                std::error_code ec;
+                fs::remove(tmp_path, ec);
+                throw std::runtime_error(util::concat("Could not write ", tmp_path.string()));
+            }
+        }
+        fs::rename(tmp_path, path);
+    }
+
+    auto PrefixIndex::records() const -> const std::vector<Record>&
+    {
+        return m_records;
+    }
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_CORE_PREFIX_INDEX_HPP
+#define MAMBA_CORE_PREFIX_INDEX_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "mamba/fs/filesystem.hpp"
+#include "mamba/specs/package_info.hpp"
+
+namespace mamba
+{
+    /**
+     * A binary index of the package records of a ``conda-meta`` directory.
+     *
+     * The index is stored in ``conda-meta/.mamba-index`` and holds, for every json record, its
+     * specs::PackageInfo fields.
+     * It is used as is when all the json records have the same file name, size, and
+     * modification time as when it was written.
+     * Otherwise, the unchanged records are reused, and only the other json files are parsed.
+     */
+    class PrefixIndex
+    {
+    public:
+
+        struct Record
+        {
+            /** The name of the json file in ``conda-meta``. */
+            std::string filename = {};
+            std::int64_t mtime = 0;
+            std::uint64_t file_size = 0;
+            specs::PackageInfo info = {};
+        };
+
+        /** The path of the index file of a ``conda-meta`` directory. */
+        [[nodiscard]] static auto index_path(const fs::u8path& conda_meta_dir) -> fs::u8path;
+
+        /** Read the PackageInfo fields of a ``conda-meta`` json record. */
+        [[nodiscard]] static auto read_record(const fs::u8path& path) -> Record;
+
+        /**
+         * Load the index of ``conda_meta_dir``, updating it with the json files that changed.
+         *
+         * With ``write``, the index file is rewritten if anything changed, unless the directory
+         * is read-only.
+         * This must only be done while holding the lock of the prefix.
+         */
+        [[nodiscard]] static auto refresh(const fs::u8path& conda_meta_dir, bool write)
+            -> PrefixIndex;
+
+        /** Read the index file, without checking it is up to date. */
+        [[nodiscard]] static auto read(const fs::u8path& conda_meta_dir)
+            -> std::optional<PrefixIndex>;
+
+        /** Write the index file of ``conda_meta_dir``. */
+        void write(const fs::u8path& conda_meta_dir) const;
+
+        /** The records in the order of the directory. */
+        [[nodiscard]] auto records() const -> const std::vector<Record>&;
+
+    private:
+
+        std::vector<Record> m_records = {};
+    };
+}
+#endif
@@ -322,7 +322,7 @@ namespace mamba
         }
 
         LOG_DEBUG << "Currently running processes: " << get_all_running_processes_info();
-        fmt::print(LOG_DEBUG, "Remaining args to run as command: {}", fmt::join(command, " "));
+        LOG_DEBUG_FMT("Remaining args to run as command: {}", fmt::join(command, " "));
 
         // replace the wrapping bash with new process entirely
 #ifndef _WIN32
@@ -338,7 +338,7 @@ namespace mamba
             context.command_params.is_mamba_exe
         );
 
-        fmt::print(LOG_DEBUG, "Running wrapped script: {}", fmt::join(command, " "));
+        LOG_DEBUG_FMT("Running wrapped script: {}", fmt::join(command, " "));
 
         bool sinkout = stream_options & static_cast<int>(STREAM_OPTIONS::SINKOUT);
         bool sinkerr = stream_options & static_cast<int>(STREAM_OPTIONS::SINKERR);
@@ -5,6 +5,7 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 #include <charconv>
+#include <chrono>
 #include <memory>
 #include <regex>
 #include <stdexcept>
@@ -15,6 +16,7 @@
 #include "mamba/core/package_cache.hpp"
 #include "mamba/core/subdir_index.hpp"
 #include "mamba/core/thread_utils.hpp"
+#include "mamba/core/timings.hpp"
 #include "mamba/core/util.hpp"
 #include "mamba/fs/filesystem.hpp"
 #include "mamba/specs/channel.hpp"
@@ -746,8 +748,18 @@ namespace mamba
                 /* lignore_failure = */ true
             ));
 
-            request.back().on_success = [this](const download::Success& success)
+            request.back().on_success = [this, timings = params.timings](
+                                            const download::Success& success
+                                        )
             {
+                if (timings != nullptr)
+                {
+                    timings->record(
+                        "repodata.check",
+                        name(),
+                        std::chrono::microseconds(success.transfer.total_time_us)
+                    );
+                }
                 const std::string& effective_url = success.transfer.effective_url;
                 int http_status = success.transfer.http_status;
                 LOG_INFO << "Checked: " << effective_url << " [" << http_status << "]";
@@ -771,8 +783,10 @@ namespace mamba
         return request;
     }
 
-    auto SubdirIndexLoader::build_index_request(const SubdirDownloadParams& params)
-        -> std::optional<download::Request>
+    auto SubdirIndexLoader::build_index_request(
+        const SubdirDownloadParams& params,
+        const on_index_ready_callback_t& on_index_ready
+    ) -> std::optional<download::Request>
     {
         if (params.offline && !caching_is_forbidden())
         {
@@ -798,24 +812,36 @@ namespace mamba
         request.etag = m_metadata.etag();
         request.last_modified = m_metadata.last_modified();
 
-        request.on_success = [this, artifact = std::move(artifact)](const download::Success& success)
+        request.on_success = [this,
+                              artifact = std::move(artifact),
+                              on_index_ready,
+                              timings = params.timings](const download::Success& success)
         {
-            if (success.transfer.http_status == 304)
+            if (timings != nullptr)
             {
-                return use_existing_cache();
+                timings->record(
+                    "repodata.download",
+                    name(),
+                    std::chrono::microseconds(success.transfer.total_time_us)
+                );
+                timings->add("repodata.downloaded_bytes", success.transfer.downloaded_size);
             }
-            else
+            auto result = (success.transfer.http_status == 304)
+                              ? use_existing_cache()
+                              : finalize_transfer(
+                                    SubdirMetadata::HttpMetadata{
+                                        repodata_url().str(),
+                                        success.etag,
+                                        success.last_modified,
+                                        success.cache_control,
+                                    },
+                                    artifact->path()
+                                );
+            if (result.has_value() && on_index_ready)
             {
-                return finalize_transfer(
-                    SubdirMetadata::HttpMetadata{
-                        repodata_url().str(),
-                        success.etag,
-                        success.last_modified,
-                        success.cache_control,
-                    },
-                    artifact->path()
-                );
+                on_index_ready(*this);
             }
+            return result;
         };
 
         request.on_failure = [](const download::Error& error)
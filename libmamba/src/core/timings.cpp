@@ -0,0 +1,239 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <cstdint>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <nlohmann/json.hpp>
+
+#include "mamba/core/timings.hpp"
+#include "mamba/core/util.hpp"
+
+namespace mamba
+{
+    namespace
+    {
+        auto phase_to_json(const Timings::Phase& phase) -> nlohmann::json
+        {
+            using seconds = std::chrono::duration<double>;
+            return {
+                { "wall_time", seconds(phase.wall_time).count() },
+                { "cpu_time", seconds(phase.cpu_time).count() },
+                { "count", phase.count },
+            };
+        }
+
+        void add_to(Timings::Phase& phase, Timings::duration wall_time, Timings::duration cpu_time)
+        {
+            phase.wall_time += wall_time;
+            phase.cpu_time += cpu_time;
+            phase.count += 1;
+        }
+    }
+
+    /*******************************************
+     *  Implementation of Timings::ScopedTimer  *
+     *******************************************/
+
+    Timings::ScopedTimer::ScopedTimer(Timings* timings, std::string phase, std::string item)
+    {
+        if ((timings == nullptr) || !timings->enabled())
+        {
+            return;
+        }
+        p_timings = timings;
+        m_phase = std::move(phase);
+        m_item = std::move(item);
+        m_cpu_start = thread_cpu_time();
+        m_wall_start = std::chrono::steady_clock::now();
+    }
+
+    Timings::ScopedTimer::~ScopedTimer()
+    {
+        stop();
+    }
+
+    Timings::ScopedTimer::ScopedTimer(ScopedTimer&& other) noexcept
+        : p_timings(std::exchange(other.p_timings, nullptr))
+        , m_phase(std::move(other.m_phase))
+        , m_item(std::move(other.m_item))
+        , m_wall_start(other.m_wall_start)
+        , m_cpu_start(other.m_cpu_start)
+    {
+    }
+
+    void Timings::ScopedTimer::stop()
+    {
+        if (p_timings == nullptr)
+        {
+            return;
+        }
+        const auto wall_time = std::chrono::steady_clock::now() - m_wall_start;
+        const auto cpu_time = thread_cpu_time() - m_cpu_start;
+        std::exchange(p_timings, nullptr)->record(m_phase, m_item, wall_time, cpu_time);
+    }
+
+    /******************************
+     *  Implementation of Timings  *
+     ******************************/
+
+    auto Timings::thread_cpu_time() -> duration
+    {
+#ifdef _WIN32
+        FILETIME creation, exit_time, kernel, user;
+        if (!GetThreadTimes(GetCurrentThread(), &creation, &exit_time, &kernel, &user))
+        {
+            return {};
+        }
+        const auto to_ticks = [](const FILETIME& ft)
+        { return (static_cast<std::uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime; };
+        // In units of 100 nanoseconds
+        return duration((to_ticks(kernel) + to_ticks(user)) * 100);
+#else
+        timespec ts;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        {
+            return {};
+        }
+        return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+#endif
+    }
+
+    void Timings::enable(bool value)
+    {
+        m_enabled.store(value, std::memory_order_relaxed);
+    }
+
+    auto Timings::enabled() const -> bool
+    {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    auto Timings::time(std::string phase, std::string item) -> ScopedTimer
+    {
+        return { this, std::move(phase), std::move(item) };
+    }
+
+    void Timings::record(
+        std::string_view phase,
+        std::string_view item,
+        duration wall_time,
+        duration cpu_time
+    )
+    {
+        if (!enabled())
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_phases.find(phase);
+        if (it == m_phases.end())
+        {
+            it = m_phases.emplace(std::string(phase), PhaseRecord()).first;
+        }
+        add_to(it->second.total, wall_time, cpu_time);
+        if (!item.empty())
+        {
+            auto& items = it->second.items;
+            auto item_it = items.find(item);
+            if (item_it == items.end())
+            {
+                item_it = items.emplace(std::string(item), Phase()).first;
+            }
+            add_to(item_it->second, wall_time, cpu_time);
+        }
+    }
+
+    void Timings::add(std::string_view counter, std::size_t value)
+    {
+        if (!enabled())
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_counters.find(counter);
+        if (it == m_counters.end())
+        {
+            it = m_counters.emplace(std::string(counter), 0).first;
+        }
+        it->second += value;
+    }
+
+    auto Timings::phase(std::string_view phase) const -> std::optional<Phase>
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (auto it = m_phases.find(phase); it != m_phases.end())
+        {
+            return { it->second.total };
+        }
+        return std::nullopt;
+    }
+
+    auto Timings::item(std::string_view phase, std::string_view item) const -> std::optional<Phase>
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (auto it = m_phases.find(phase); it != m_phases.end())
+        {
+            if (auto item_it = it->second.items.find(item); item_it != it->second.items.end())
+            {
+                return { item_it->second };
+            }
+        }
+        return std::nullopt;
+    }
+
+    auto Timings::counter(std::string_view counter) const -> std::size_t
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (auto it = m_counters.find(counter); it != m_counters.end())
+        {
+            return it->second;
+        }
+        return 0;
+    }
+
+    auto Timings::to_json() const -> nlohmann::json
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto phases = nlohmann::json::object();
+        for (const auto& [name, record] : m_phases)
+        {
+            auto phase = phase_to_json(record.total);
+            if (!record.items.empty())
+            {
+                auto& items = phase["items"] = nlohmann::json::object();
+                for (const auto& [item_name, item] : record.items)
+                {
+                    items[item_name] = phase_to_json(item);
+                }
+            }
+            phases[name] = std::move(phase);
+        }
+        return {
+            { "phases", std::move(phases) },
+            { "counters", m_counters },
+        };
+    }
+
+    void Timings::dump(const fs::u8path& path) const
+    {
+        auto out = open_ofstream(path, std::ios::out);
+        out << to_json().dump(4) << '\n';
+    }
+
+    void Timings::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_phases.clear();
+        m_counters.clear();
+    }
+}
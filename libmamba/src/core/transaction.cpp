@@ -5,10 +5,17 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <iostream>
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <stack>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -23,6 +30,7 @@
 #include "mamba/core/execution.hpp"
 #include "mamba/core/output.hpp"
 #include "mamba/core/package_fetcher.hpp"
+#include "mamba/core/package_paths.hpp"
 #include "mamba/core/repo_checker_store.hpp"
 #include "mamba/core/thread_utils.hpp"
 #include "mamba/core/transaction.hpp"
@@ -33,6 +41,7 @@
 #include "mamba/util/variant_cmp.hpp"
 
 #include "./link.hpp"
+#include "./prefix_index.hpp"
 #include "./transaction_context.hpp"
 #include "solver/helpers.hpp"
 
@@ -308,6 +317,201 @@ namespace mamba
         m_py_versions = find_python_version(m_solution, database);
     }
 
+    namespace
+    {
+        // For each package, the indices of the packages that must be linked before it: its
+        // dependencies installed in the same transaction, and the previous packages with files
+        // at the same target paths, so that clobbering still follows the order of the solution.
+        // Only previous packages are considered, which is what the serial linking in the
+        // (topologically sorted) solution order guarantees, and prevents cycles.
+        auto make_link_dependencies(
+            const std::vector<const specs::PackageInfo*>& pkgs,
+            std::vector<LinkPackage>& links
+        ) -> std::vector<std::vector<std::size_t>>
+        {
+            auto index_by_name = std::unordered_map<std::string, std::size_t>();
+            for (std::size_t i = 0; i < pkgs.size(); ++i)
+            {
+                index_by_name.emplace(pkgs[i]->name, i);
+            }
+
+            auto deps = std::vector<std::vector<std::size_t>>(pkgs.size());
+            auto last_writer = std::unordered_map<std::string, std::size_t>();
+            for (std::size_t i = 0; i < pkgs.size(); ++i)
+            {
+                for (const auto& dep : pkgs[i]->dependencies)
+                {
+                    const auto ms = specs::MatchSpec::parse(dep);
+                    if (!ms.has_value() || !ms->name().is_exact())
+                    {
+                        continue;
+                    }
+                    if (auto it = index_by_name.find(ms->name().to_string());
+                        (it != index_by_name.end()) && (it->second < i))
+                    {
+                        deps[i].push_back(it->second);
+                    }
+                }
+                // Noarch python files are linked elsewhere than their path in the package.
+                for (const auto& path : links[i].paths())
+                {
+                    auto [it, inserted] = last_writer.try_emplace(
+                        links[i].target_path(path).generic_string(),
+                        i
+                    );
+                    if (!inserted && (it->second < i))
+                    {
+                        deps[i].push_back(std::exchange(it->second, i));
+                    }
+                }
+                std::sort(deps[i].begin(), deps[i].end());
+                deps[i].erase(std::unique(deps[i].begin(), deps[i].end()), deps[i].end());
+            }
+            return deps;
+        }
+
+        // Calls ``link(i)`` for every package once all the packages in ``deps[i]`` are linked.
+        // Independent packages are linked concurrently by the calling thread and tasks submitted
+        // to the main executor pool.
+        // A task is only submitted for a package whose dependencies are linked, and returns
+        // without waiting if another thread took it, so that no worker of the pool is blocked.
+        // No new package is started once a call returns ``LoopControl::Break`` or throws, in
+        // which case the first exception is rethrown once the running calls are done.
+        template <typename Func>
+        void
+        link_in_dependency_order(const std::vector<std::vector<std::size_t>>& deps, Func&& link)
+        {
+            using link_type = std::remove_reference_t<Func>;
+
+            struct State : std::enable_shared_from_this<State>
+            {
+                // Only dereferenced for started packages, which are all done before returning.
+                link_type* link = nullptr;
+                std::vector<std::vector<std::size_t>> dependents = {};
+                std::vector<std::size_t> pending_deps = {};
+                std::deque<std::size_t> ready = {};
+                std::size_t running = 0;
+                std::size_t finished = 0;
+                bool stop = false;
+                std::exception_ptr error = nullptr;
+                std::mutex mutex = {};
+                std::condition_variable cv = {};
+
+                [[nodiscard]] auto done() const -> bool
+                {
+                    return (finished == pending_deps.size()) || (stop && (running == 0));
+                }
+
+                void submit_one()
+                {
+                    MainExecutor::instance().submit([self = this->shared_from_this()]
+                                                    { self->run_one(); });
+                }
+
+                // Links a ready package, if any, and returns whether it did.
+                auto run_one() -> bool
+                {
+                    auto lock = std::unique_lock(mutex);
+                    if (stop || ready.empty())
+                    {
+                        return false;
+                    }
+                    const auto i = ready.front();
+                    ready.pop_front();
+                    ++running;
+                    lock.unlock();
+
+                    auto control = util::LoopControl::Continue;
+                    auto call_error = std::exception_ptr();
+                    try
+                    {
+                        control = (*link)(i);
+                    }
+                    catch (...)
+                    {
+                        call_error = std::current_exception();
+                    }
+
+                    lock.lock();
+                    --running;
+                    ++finished;
+                    if (call_error && !error)
+                    {
+                        error = std::move(call_error);
+                    }
+                    stop = stop || error || (control == util::LoopControl::Break);
+                    std::size_t newly_ready = 0;
+                    for (auto d : dependents[i])
+                    {
+                        if (--pending_deps[d] == 0)
+                        {
+                            ready.push_back(d);
+                            ++newly_ready;
+                        }
+                    }
+                    const bool submit = !stop;
+                    cv.notify_all();
+                    lock.unlock();
+
+                    for (std::size_t n = 0; submit && (n < newly_ready); ++n)
+                    {
+                        submit_one();
+                    }
+                    return true;
+                }
+            };
+
+            const auto count = deps.size();
+            auto state = std::make_shared<State>();
+            state->link = &link;
+            state->dependents.resize(count);
+            state->pending_deps.resize(count, 0);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                for (auto d : deps[i])
+                {
+                    state->dependents[d].push_back(i);
+                    ++state->pending_deps[i];
+                }
+            }
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (state->pending_deps[i] == 0)
+                {
+                    state->ready.push_back(i);
+                }
+            }
+
+            // The calling thread takes one of the ready packages.
+            for (std::size_t n = 1; n < state->ready.size(); ++n)
+            {
+                state->submit_one();
+            }
+            // The calling thread also links packages, so that they are all linked even if the
+            // submitted tasks cannot run, and only waits when none is ready.
+            while (true)
+            {
+                if (state->run_one())
+                {
+                    continue;
+                }
+                auto lock = std::unique_lock(state->mutex);
+                state->cv.wait(
+                    lock,
+                    [&] { return state->done() || (!state->stop && !state->ready.empty()); }
+                );
+                if (state->done())
+                {
+                    if (state->error)
+                    {
+                        std::rethrow_exception(state->error);
+                    }
+                    return;
+                }
+            }
+        }
+    }
+
     class TransactionRollback
     {
     public:
@@ -402,18 +606,31 @@ namespace mamba
         TransactionRollback rollback;
         TransactionContext transaction_context(ctx.transaction_params(), m_py_versions, m_requested_specs);
 
-        const auto link = [&](const specs::PackageInfo& pkg)
+        auto to_link = std::vector<const specs::PackageInfo*>();
+        for_each_to_install(m_solution.actions, [&](const auto& pkg) { to_link.push_back(&pkg); });
+        auto link_cache_paths = std::vector<fs::u8path>();
+        // Their ``paths.json`` is read once, to order the linking and then to link them.
+        auto link_packages = std::vector<LinkPackage>();
+        link_cache_paths.reserve(to_link.size());
+        link_packages.reserve(to_link.size());
+        for (const auto* pkg : to_link)
+        {
+            link_cache_paths.push_back(m_multi_cache.get_extracted_dir_path(*pkg, false));
+            link_packages.emplace_back(*pkg, link_cache_paths.back(), &transaction_context);
+        }
+        // Not a ``std::vector<bool>`` which cannot be written concurrently.
+        auto linked = std::vector<char>(to_link.size(), false);
+
+        const auto link = [&](std::size_t i)
         {
             if (is_sig_interrupted())
             {
                 return util::LoopControl::Break;
             }
-            Console::stream() << "Linking " << pkg.str();
-            const fs::u8path cache_path(m_multi_cache.get_extracted_dir_path(pkg, false));
-            LinkPackage lp(pkg, cache_path, &transaction_context);
-            lp.execute();
-            rollback.record(lp);
-            m_history_entry.link_dists.push_back(pkg.long_str());
+            Console::stream() << "Linking " << to_link[i]->str();
+            auto timer = ctx.timings.time("link", to_link[i]->name);
+            link_packages[i].execute();
+            linked[i] = true;
             return util::LoopControl::Continue;
         };
         const auto unlink = [&](const specs::PackageInfo& pkg)
@@ -432,7 +649,22 @@ namespace mamba
         };
 
         for_each_to_remove(m_solution.actions, unlink);
-        for_each_to_install(m_solution.actions, link);
+        if (!is_sig_interrupted())
+        {
+            link_in_dependency_order(make_link_dependencies(to_link, link_packages), link);
+        }
+        LOG_INFO << "Linked files: " << transaction_context.link_statistics().str();
+        // Recorded in the solution order, whatever the order in which they were linked.
+        for (std::size_t i = 0; i < to_link.size(); ++i)
+        {
+            if (linked[i])
+            {
+                rollback.record(
+                    LinkPackage(*to_link[i], link_cache_paths[i], &transaction_context)
+                );
+                m_history_entry.link_dists.push_back(to_link[i]->long_str());
+            }
+        }
 
         if (is_sig_interrupted())
         {
@@ -440,12 +672,33 @@ namespace mamba
             rollback.rollback(ctx);
             return false;
         }
+        // Only the json records of the packages linked in this transaction are read.
+        try
+        {
+            // The index is written while holding the lock of the prefix.
+            static_cast<void>(PrefixIndex::refresh(
+                ctx.prefix_params.target_prefix / "conda-meta",
+                /* write= */ true
+            ));
+        }
+        catch (const std::exception& e)
+        {
+            LOG_WARNING << "Could not update the prefix index: " << e.what();
+        }
+
         LOG_INFO << "Waiting for pyc compilation to finish";
-        transaction_context.wait_for_pyc_compilation();
+        {
+            // Only the compilation not overlapping the linking
+            auto timer = ctx.timings.time("pyc_compile");
+            transaction_context.wait_for_pyc_compilation();
+        }
 
         Console::stream() << "\nTransaction finished\n";
 
-        prefix.history().add_entry(m_history_entry);
+        {
+            auto timer = ctx.timings.time("history.write");
+            prefix.history().add_entry(m_history_entry);
+        }
         return true;
     }
 
@@ -635,12 +888,14 @@ namespace mamba
         using ExtractTrackerList = std::vector<std::future<PackageExtractTask::Result>>;
 
         download::MultiRequest build_download_requests(
+            const Context& context,
             FetcherList& fetchers,
             ExtractTaskList& extract_tasks,
             ExtractTrackerList& extract_trackers,
             std::size_t download_size
         )
         {
+            const auto extract_options = ExtractOptions::from_context(context);
             download::MultiRequest download_requests;
             download_requests.reserve(download_size);
             for (auto [fit, eit] = std::tuple{ fetchers.begin(), extract_tasks.begin() };
@@ -655,11 +910,12 @@ namespace mamba
                 download_requests.push_back(fit->build_download_request(
                     [extract_task = std::move(task)](std::size_t downloaded_size)
                     {
-                        MainExecutor::instance().schedule(
+                        MainExecutor::instance().submit(
                             [t = std::move(extract_task)](std::size_t ds) { (*t)(ds); },
                             downloaded_size
                         );
-                    }
+                    },
+                    extract_options
                 ));
             }
             return download_requests;
@@ -677,10 +933,9 @@ namespace mamba
                  it != extract_tasks.end();
                  ++it)
             {
-                std::packaged_task<mamba::PackageExtractTask::Result()> task{ [=]
-                                                                              { return it->run(); } };
-                extract_trackers.push_back(task.get_future());
-                MainExecutor::instance().schedule(std::move(task));
+                extract_trackers.push_back(
+                    MainExecutor::instance().submit([=] { return it->run(); })
+                );
             }
         }
 
@@ -728,6 +983,9 @@ namespace mamba
     bool MTransaction::fetch_extract_packages(const Context& ctx, ChannelContext& channel_context)
     {
         PackageFetcherSemaphore::set_max(ctx.threads_params.extract_threads);
+        MainExecutor::instance().set_pool_size(
+            static_cast<std::size_t>(PackageFetcherSemaphore::get_max())
+        );
 
         FetcherList fetchers = build_fetchers(ctx, channel_context, m_solution, m_multi_cache);
 
@@ -755,6 +1013,7 @@ namespace mamba
         ExtractTrackerList extract_trackers;
         extract_trackers.reserve(extract_tasks.size());
         download::MultiRequest download_requests = build_download_requests(
+            ctx,
             fetchers,
             extract_tasks,
             extract_trackers,
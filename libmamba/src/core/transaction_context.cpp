@@ -11,6 +11,7 @@
 
 #include "mamba/core/error_handling.hpp"
 #include "mamba/core/output.hpp"
+#include "mamba/core/timings.hpp"
 #include "mamba/util/environment.hpp"
 #include "mamba/util/string.hpp"
 
@@ -91,6 +92,32 @@ namespace mamba
         }
     }
 
+    void LinkStatistics::add(LinkStrategy strategy)
+    {
+        m_counts[static_cast<std::size_t>(strategy)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto LinkStatistics::count(LinkStrategy strategy) const -> std::size_t
+    {
+        return m_counts[static_cast<std::size_t>(strategy)].load(std::memory_order_relaxed);
+    }
+
+    auto LinkStatistics::str() const -> std::string
+    {
+        return util::concat(
+            std::to_string(count(LinkStrategy::Reflink)),
+            " reflinked, ",
+            std::to_string(count(LinkStrategy::Hardlink)),
+            " hard-linked, ",
+            std::to_string(count(LinkStrategy::Softlink)),
+            " soft-linked, ",
+            std::to_string(count(LinkStrategy::CopyFileRange)),
+            " copied in kernel, ",
+            std::to_string(count(LinkStrategy::Copy)),
+            " copied"
+        );
+    }
+
     TransactionContext::PythonParams
     build_python_params(std::pair<std::string, std::string> py_versions)
     {
@@ -151,6 +178,10 @@ namespace mamba
         }
 
         LOG_INFO << "Compiling " << py_files.size() << " files to pyc";
+        if (m_transaction_params.timings != nullptr)
+        {
+            m_transaction_params.timings->add("pyc_compile.files", py_files.size());
+        }
         for (auto& f : py_files)
         {
             auto fs = f.string() + "\n";
@@ -232,6 +263,11 @@ namespace mamba
         return m_python_params;
     }
 
+    auto TransactionContext::link_statistics() const -> LinkStatistics&
+    {
+        return *m_link_statistics;
+    }
+
     const std::vector<specs::MatchSpec>& TransactionContext::requested_specs() const
     {
         return m_requested_specs;
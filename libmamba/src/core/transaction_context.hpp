@@ -7,6 +7,10 @@
 #ifndef MAMBA_CORE_TRANSACTION_CONTEXT
 #define MAMBA_CORE_TRANSACTION_CONTEXT
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
 #include <string>
 
 #include <reproc++/reproc.hpp>
@@ -28,6 +32,30 @@ namespace mamba
         const fs::u8path& target_site_packages_short_path
     );
 
+    /** The ways a file of a package can be created in the prefix, by order of preference. */
+    enum class LinkStrategy
+    {
+        Reflink,
+        Hardlink,
+        Softlink,
+        CopyFileRange,
+        Copy,
+    };
+
+    /** Thread safe counters of the files created in the prefix with each LinkStrategy. */
+    class LinkStatistics
+    {
+    public:
+
+        void add(LinkStrategy strategy);
+        [[nodiscard]] auto count(LinkStrategy strategy) const -> std::size_t;
+        [[nodiscard]] auto str() const -> std::string;
+
+    private:
+
+        std::array<std::atomic<std::size_t>, 5> m_counts = {};
+    };
+
     class TransactionContext
     {
     public:
@@ -60,6 +88,7 @@ namespace mamba
         const PrefixParams& prefix_params() const;
         const LinkParams& link_params() const;
         const PythonParams& python_params() const;
+        LinkStatistics& link_statistics() const;
 
         const std::vector<specs::MatchSpec>& requested_specs() const;
 
@@ -70,6 +99,8 @@ namespace mamba
         TransactionParams m_transaction_params;
         PythonParams m_python_params;
         std::vector<specs::MatchSpec> m_requested_specs;
+        // Behind a pointer to keep the context movable.
+        std::unique_ptr<LinkStatistics> m_link_statistics = std::make_unique<LinkStatistics>();
 
         std::unique_ptr<reproc::process> m_pyc_process = nullptr;
         std::unique_ptr<TemporaryFile> m_pyc_script_file = nullptr;
@@ -171,6 +171,7 @@ namespace mamba::download
         const RemoteFetchParams& params,
         const specs::AuthenticationDataBase& auth_info,
         bool verbose,
+        std::size_t attempt_number,
         on_success_callback success,
         on_failure_callback error
     )
@@ -181,6 +182,7 @@ namespace mamba::download
               params,
               auth_info,
               verbose,
+              attempt_number,
               std::move(success),
               std::move(error)
           ))
@@ -200,6 +202,7 @@ namespace mamba::download
         const RemoteFetchParams& params,
         const specs::AuthenticationDataBase& auth_info,
         bool verbose,
+        std::size_t attempt_number,
         on_success_callback success,
         on_failure_callback error
     )
@@ -208,12 +211,23 @@ namespace mamba::download
         , m_success_callback(std::move(success))
         , m_failure_callback(std::move(error))
         , m_retry_wait_seconds(static_cast<std::size_t>(params.retry_timeout))
+        , m_attempt_number(attempt_number)
     {
         p_stream = make_compression_stream(
             p_request->url,
             p_request->is_repodata_zst,
             [this](char* in, std::size_t size) { return this->write_data(in, size); }
         );
+        if (p_request->compute_sha256)
+        {
+            m_sha256_digester.emplace();
+            m_sha256_digester->digest_start();
+        }
+        if (p_request->compute_md5)
+        {
+            m_md5_digester.emplace();
+            m_md5_digester->digest_start();
+        }
         configure_handle(params, auth_info, verbose);
         downloader.add_handle(*p_handle);
     }
@@ -458,14 +472,33 @@ namespace mamba::download
                 // Return a size _different_ than the expected write size to signal an error
                 return size + 1;
             }
+            if (p_request->on_content.has_value())
+            {
+                p_request->on_content.value()(m_written_size, std::string_view(buffer, size));
+            }
+            m_written_size += size;
         }
         else
         {
             m_response.append(buffer, size);
         }
+        update_digests(buffer, size);
         return size;
     }
 
+    void DownloadAttempt::Impl::update_digests(const char* buffer, size_t size)
+    {
+        const auto* bytes = reinterpret_cast<const std::byte*>(buffer);
+        if (m_sha256_digester.has_value())
+        {
+            m_sha256_digester->digest_update(bytes, size);
+        }
+        if (m_md5_digester.has_value())
+        {
+            m_md5_digester->digest_update(bytes, size);
+        }
+    }
+
     size_t
     DownloadAttempt::Impl::curl_header_callback(char* buffer, size_t size, size_t nbitems, void* self)
     {
@@ -569,7 +602,8 @@ namespace mamba::download
                 .value_or(http::ARBITRARY_ERROR),
             /* .effective_url = */ std::move(url),
             /* .dwonloaded_size = */ p_handle->get_info<std::size_t>(CURLINFO_SIZE_DOWNLOAD_T).value_or(0),
-            /* .average_speed = */ p_handle->get_info<std::size_t>(CURLINFO_SPEED_DOWNLOAD_T).value_or(0)
+            /* .average_speed = */ p_handle->get_info<std::size_t>(CURLINFO_SPEED_DOWNLOAD_T).value_or(0),
+            /* .total_time_us = */ p_handle->get_info<std::size_t>(CURLINFO_TOTAL_TIME_T).value_or(0)
         };
     }
 
@@ -581,6 +615,7 @@ namespace mamba::download
                << p_handle->get_curl_effective_url() << "]\n"
                << p_handle->get_error_buffer();
         error.message = strerr.str();
+        error.attempt_number = m_attempt_number;
 
         if (can_retry(code))
         {
@@ -598,11 +633,28 @@ namespace mamba::download
                                            .value_or(m_retry_wait_seconds);
         }
         error.message = build_transfer_message(data.http_status, data.effective_url, data.downloaded_size);
+        error.attempt_number = m_attempt_number;
         error.transfer = std::move(data);
         return error;
     }
 
-    Success DownloadAttempt::Impl::build_download_success(TransferData data) const
+    namespace
+    {
+        template <typename Digester>
+        auto finalize_hex_digest(std::optional<Digester>& digester) -> std::string
+        {
+            if (!digester.has_value())
+            {
+                return "";
+            }
+            std::array<std::byte, Digester::bytes_size> bytes = {};
+            digester->digest_finalize_to(bytes.data());
+            digester.reset();
+            return util::bytes_to_hex_str(bytes.data(), bytes.data() + bytes.size());
+        }
+    }
+
+    Success DownloadAttempt::Impl::build_download_success(TransferData data)
     {
         Content content;
         if (p_request->filename.has_value())
@@ -614,11 +666,19 @@ namespace mamba::download
             content = Buffer{ std::move(m_response) };
         }
 
+        // Nothing was written for a "Not Modified" response
+        const bool has_content = data.http_status != 304;
+        std::string sha256 = has_content ? finalize_hex_digest(m_sha256_digester) : "";
+        std::string md5 = has_content ? finalize_hex_digest(m_md5_digester) : "";
+
         return { /*.content = */ std::move(content),
                  /*.transfer = */ std::move(data),
                  /*.cache_control = */ m_cache_control,
                  /*.etag = */ m_etag,
-                 /*.last_modified = */ m_last_modified };
+                 /*.last_modified = */ m_last_modified,
+                 /*.attempt_number = */ m_attempt_number,
+                 /*.sha256 = */ std::move(sha256),
+                 /*.md5 = */ std::move(md5) };
     }
 
     /********************************
@@ -687,6 +747,7 @@ namespace mamba::download
         const RemoteFetchParams& params,
         const specs::AuthenticationDataBase& auth_info,
         bool verbose,
+        std::size_t attempt_number,
         on_success_callback success,
         on_failure_callback error
     ) -> completion_function
@@ -700,6 +761,7 @@ namespace mamba::download
             params,
             auth_info,
             verbose,
+            attempt_number,
             std::move(success),
             std::move(error)
         );
@@ -832,6 +894,7 @@ namespace mamba::download
             params,
             auth_info,
             verbose,
+            m_attempt_results.size() + std::size_t(1),
             [this](Success res)
             {
                 expected_t<void> finalize_res = invoke_on_success(res);
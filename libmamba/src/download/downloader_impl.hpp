@@ -16,6 +16,7 @@
 #include "mamba/download/mirror_map.hpp"
 #include "mamba/download/parameters.hpp"
 #include "mamba/specs/authentication_info.hpp"
+#include "mamba/util/cryptography.hpp"
 #include "mamba/util/flat_set.hpp"
 
 #include "compression.hpp"
@@ -43,6 +44,7 @@ namespace mamba::download
             const RemoteFetchParams& params,
             const specs::AuthenticationDataBase& auth_info,
             bool verbose,
+            std::size_t attempt_number,
             on_success_callback success,
             on_failure_callback error
         );
@@ -63,6 +65,7 @@ namespace mamba::download
                 const RemoteFetchParams& params,
                 const specs::AuthenticationDataBase& auth_info,
                 bool verbose,
+                std::size_t attempt_number,
                 on_success_callback success,
                 on_failure_callback error
             );
@@ -82,6 +85,7 @@ namespace mamba::download
             );
 
             size_t write_data(char* buffer, size_t data);
+            void update_digests(const char* buffer, size_t size);
 
             static size_t curl_header_callback(char* buffer, size_t size, size_t nbitems, void* self);
             static size_t curl_write_callback(char* buffer, size_t size, size_t nbitems, void* self);
@@ -99,19 +103,25 @@ namespace mamba::download
             TransferData get_transfer_data() const;
             Error build_download_error(CURLcode code) const;
             Error build_download_error(TransferData data) const;
-            Success build_download_success(TransferData data) const;
+            Success build_download_success(TransferData data);
 
             CURLHandle* p_handle = nullptr;
             const MirrorRequest* p_request = nullptr;
             on_success_callback m_success_callback;
             on_failure_callback m_failure_callback;
             std::size_t m_retry_wait_seconds = std::size_t(0);
+            std::size_t m_attempt_number = std::size_t(1);
             std::unique_ptr<CompressionStream> p_stream = nullptr;
             std::ofstream m_file;
+            std::size_t m_written_size = 0;
             mutable std::string m_response = "";
             std::string m_cache_control;
             std::string m_etag;
             std::string m_last_modified;
+            // Digests are updated with the content as it is written; each attempt writes
+            // the content from its start, so they are never shared between attempts.
+            std::optional<util::Sha256Digester> m_sha256_digester;
+            std::optional<util::Md5Digester> m_md5_digester;
         };
 
         std::unique_ptr<Impl> p_impl = nullptr;
@@ -145,6 +155,7 @@ namespace mamba::download
             const RemoteFetchParams& params,
             const specs::AuthenticationDataBase& auth_info,
             bool verbose,
+            std::size_t attempt_number,
             on_success_callback success,
             on_failure_callback error
         ) -> completion_function;
@@ -27,6 +27,36 @@
 
 namespace mamba::solver::libsolv
 {
+    /**************************************
+     *  Implementation of ParsedRepodata  *
+     **************************************/
+
+    ParsedRepodata::ParsedRepodata(std::string url, std::unique_ptr<RepodataPackages> packages)
+        : m_url(std::move(url))
+        , m_packages(std::move(packages))
+    {
+    }
+
+    ParsedRepodata::ParsedRepodata(ParsedRepodata&&) = default;
+
+    ParsedRepodata::~ParsedRepodata() = default;
+
+    auto ParsedRepodata::operator=(ParsedRepodata&&) -> ParsedRepodata& = default;
+
+    auto ParsedRepodata::url() const -> const std::string&
+    {
+        return m_url;
+    }
+
+    auto ParsedRepodata::package_count() const -> std::size_t
+    {
+        return m_packages->packages.size();
+    }
+
+    /********************************
+     *  Implementation of Database  *
+     ********************************/
+
     struct Database::DatabaseImpl
     {
         explicit DatabaseImpl(specs::ChannelResolveParams p_channel_params, Settings settings_)
@@ -35,6 +65,24 @@ namespace mamba::solver::libsolv
         {
         }
 
+        /**
+         * Precompute the data used in the namespace callback.
+         *
+         * The callback is also used by a database loaded with the Libsolv parser when solving
+         * with the Mixed parser, so the names are always indexed for the glob names.
+         */
+        void add_matcher_data(solv::ObjRepoViewConst repo)
+        {
+            if (settings.matchspec_parser != MatchSpecParser::Libsolv)
+            {
+                matcher.add_repo(repo);
+            }
+            else
+            {
+                matcher.add_repo_names(repo);
+            }
+        }
+
         Settings settings;
         solv::ObjPool pool = {};
         Matcher matcher;
@@ -214,12 +262,64 @@ namespace mamba::solver::libsolv
                         add_pip_as_python_dependency(pool(), p_repo);
                     }
                     p_repo.internalize();
+                    m_data->add_matcher_data(p_repo);
                     return RepoInfo{ p_repo.raw() };
                 }
             )
             .or_else([&](const auto&) { pool().remove_repo(repo.id(), /* reuse_ids= */ true); });
     }
 
+    auto Database::parse_repodata_json(
+        const fs::u8path& path,
+        std::string_view url,
+        PackageTypes package_types,
+        VerifyPackages verify_packages
+    ) -> expected_t<ParsedRepodata>
+    {
+        if (!fs::exists(path))
+        {
+            return make_unexpected(
+                fmt::format(R"(File "{}" does not exist)", path),
+                mamba_error_code::repodata_not_loaded
+            );
+        }
+        auto str_url = std::string(url);
+        return mamba_parse_json(path, str_url, package_types, static_cast<bool>(verify_packages))
+            .transform(
+                [&](RepodataPackages&& packages)
+                {
+                    return ParsedRepodata(
+                        std::move(str_url),
+                        std::make_unique<RepodataPackages>(std::move(packages))
+                    );
+                }
+            );
+    }
+
+    auto Database::add_repo_from_parsed_repodata(
+        const ParsedRepodata& repodata,
+        const std::string& channel_id,
+        PipAsPythonDependency add
+    ) -> expected_t<RepoInfo>
+    {
+        auto repo = pool().add_repo(repodata.url()).second;
+        repo.set_url(repodata.url());
+        add_repodata_packages(
+            pool(),
+            repo,
+            *repodata.m_packages,
+            channel_id,
+            settings().matchspec_parser
+        );
+        if (add == PipAsPythonDependency::Yes)
+        {
+            add_pip_as_python_dependency(pool(), repo);
+        }
+        repo.internalize();
+        m_data->add_matcher_data(repo);
+        return RepoInfo{ repo.raw() };
+    }
+
     auto Database::add_repo_from_native_serialization(
         const fs::u8path& path,
         const RepodataOrigin& expected,
@@ -240,6 +340,7 @@ namespace mamba::solver::libsolv
                         add_pip_as_python_dependency(pool(), p_repo);
                     }
                     p_repo.internalize();
+                    m_data->add_matcher_data(p_repo);
                     return RepoInfo(p_repo.raw());
                 }
             )
@@ -273,6 +374,7 @@ namespace mamba::solver::libsolv
             add_pip_as_python_dependency(pool(), s_repo);
         }
         s_repo.internalize();
+        m_data->add_matcher_data(s_repo);
     }
 
     auto Database::native_serialize_repo(
@@ -286,6 +388,59 @@ namespace mamba::solver::libsolv
             .transform([](solv::ObjRepoView solv_repo) { return RepoInfo(solv_repo.raw()); });
     }
 
+    auto Database::add_repos_from_native_snapshot(
+        const fs::u8path& path,
+        const std::vector<RepodataSnapshotEntry>& expected,
+        PipAsPythonDependency add
+    ) -> expected_t<std::vector<RepoInfo>>
+    {
+        return read_solv_snapshot(pool(), path, expected, static_cast<bool>(add))
+            .transform(
+                [&](std::vector<solv::ObjRepoView>&& solv_repos)
+                {
+                    auto repos = std::vector<RepoInfo>();
+                    repos.reserve(solv_repos.size());
+                    for (std::size_t i = 0; i < solv_repos.size(); ++i)
+                    {
+                        repos.push_back(RepoInfo(solv_repos[i].raw()));
+                        set_repo_priority(repos.back(), expected[i].priorities);
+                        m_data->add_matcher_data(solv_repos[i]);
+                    }
+                    return repos;
+                }
+            );
+    }
+
+    auto Database::native_snapshot_entries(const fs::u8path& path, PipAsPythonDependency add)
+        -> expected_t<std::vector<RepodataSnapshotEntry>>
+    {
+        return read_solv_snapshot_entries(path, static_cast<bool>(add));
+    }
+
+    auto Database::native_serialize_repos(
+        const std::vector<RepoInfo>& repos,
+        const fs::u8path& path,
+        const std::vector<RepodataSnapshotEntry>& metadata,
+        PipAsPythonDependency add
+    ) -> expected_t<void>
+    {
+        if (repos.size() != metadata.size())
+        {
+            return make_unexpected(
+                "Snapshot metadata do not match the repos",
+                mamba_error_code::incorrect_usage
+            );
+        }
+        auto solv_repos = std::vector<solv::ObjRepoView>();
+        solv_repos.reserve(repos.size());
+        for (const auto& repo : repos)
+        {
+            assert(repo.m_ptr != nullptr);
+            solv_repos.emplace_back(*repo.m_ptr);
+        }
+        return write_solv_snapshot(solv_repos, path, metadata, static_cast<bool>(add));
+    }
+
     void Database::remove_repo(RepoInfo repo)
     {
         pool().remove_repo(repo.id(), /* reuse_ids= */ true);
@@ -4,11 +4,21 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <string_view>
 #include <type_traits>
 #include <variant>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include <fmt/ostream.h>
 #include <simdjson.h>
 #include <solv/conda.h>
@@ -26,6 +36,7 @@
 #include "mamba/specs/conda_url.hpp"
 #include "mamba/specs/match_spec.hpp"
 #include "mamba/util/cfile.hpp"
+#include "mamba/util/encoding.hpp"
 #include "mamba/util/random.hpp"
 #include "mamba/util/string.hpp"
 #include "mamba/util/type_traits.hpp"
@@ -103,6 +114,35 @@ namespace mamba::solver::libsolv
         solv.add_self_provide();
     }
 
+    auto solvable_url(solv::ObjSolvableViewConst s) -> std::string
+    {
+        if (const auto url = s.url(); !url.empty())
+        {
+            return std::string(url);
+        }
+        const auto base_url = solv::ObjRepoViewConst::of_solvable(s).base_url();
+        if (base_url.empty())
+        {
+            return {};
+        }
+        // The path goes before any query or fragment, only a full URL join handles them.
+        if (base_url.find_first_of("?#") != std::string_view::npos)
+        {
+            return specs::CondaURL::parse(base_url)
+                .transform(
+                    [&](specs::CondaURL&& url)
+                    { return (url / s.file_name()).str(specs::CondaURL::Credentials::Show); }
+                )
+                .value_or("");
+        }
+        // The filename is encoded as in ``CondaURL::operator/``, the base is already encoded.
+        return util::concat(
+            util::rstrip(base_url, '/'),
+            "/",
+            util::encode_percent(s.file_name(), '/')
+        );
+    }
+
     auto make_package_info(const solv::ObjPool& pool, solv::ObjSolvableViewConst s)
         -> specs::PackageInfo
     {
@@ -114,7 +154,7 @@ namespace mamba::solver::libsolv
         out.noarch = specs::noarch_parse(s.noarch()).value_or(specs::NoArchType::No);
         out.build_number = s.build_number();
         out.channel = s.channel();
-        out.package_url = s.url();
+        out.package_url = solvable_url(s);
         out.platform = s.platform();
         out.filename = s.file_name();
         out.license = s.license();
@@ -156,11 +196,10 @@ namespace mamba::solver::libsolv
             return util::lstrip_if_parts(tail, [&](char c) { return !is_sep(c); });
         }
 
-        void set_solv_signatures(
-            solv::ObjSolvableView solv,
+        auto signatures_for_file(
             const std::string& filename,
             const std::optional<nlohmann::json>& signatures
-        )
+        ) -> std::string
         {
             // NOTE We need to use an intermediate nlohmann::json object to store signatures
             // as simdjson objects are not conceived to be modified smoothly
@@ -172,12 +211,10 @@ namespace mamba::solver::libsolv
                     signatures_for_file != signatures->end())
                 {
                     glob_sigs["signatures"] = *signatures_for_file;
-
-                    solv.set_signatures(glob_sigs.dump());
-                    LOG_INFO << "Signatures for '" << filename
-                             << "' are set in corresponding solvable.";
+                    return glob_sigs.dump();
                 }
             }
+            return {};
         }
 
         template <class SimdJSONValue>
@@ -194,39 +231,36 @@ namespace mamba::solver::libsolv
             return all_signatures;
         }
 
-        template <class JSONObject>
-        [[nodiscard]] auto set_solvable(
-            solv::ObjPool& pool,
-            // const std::string& repo_url_str,
-            const specs::CondaURL& repo_url,
-            const std::string& channel_id,
-            solv::ObjSolvableView solv,
+        template <class JSONArray>
+        auto read_string_list(RepodataPackages& out, JSONArray&& array) -> RepodataPackages::StringList
+        {
+            auto list = RepodataPackages::StringList{ out.lists.size(), out.lists.size() };
+            for (auto elem : array)
+            {
+                if (!elem.error() && elem.is_string())
+                {
+                    out.lists.push_back(out.add_string(elem.get_string().value_unsafe()));
+                }
+            }
+            list.last = out.lists.size();
+            return list;
+        }
 
+        template <class JSONObject>
+        [[nodiscard]] auto read_package(
+            RepodataPackages& out,
             const std::string& filename,
             JSONObject&& pkg,
             const std::optional<nlohmann::json>& signatures,
-            const std::string& default_subdir,
-            MatchSpecParser parser
+            const std::string& default_subdir
         ) -> bool
         {
-            // Not available from RepoDataPackage
-            solv.set_url((repo_url / filename).str(specs::CondaURL::Credentials::Show));
-            solv.set_channel(channel_id);
-
-            solv.set_file_name(filename);
-            if (auto fn = pkg["fn"]; !fn.error())
-            {
-                solv.set_name(fn.get_string().value_unsafe());
-            }
-            else
-            {
-                // Fallback from key entry
-                solv.set_file_name(filename);
-            }
+            auto parsed = RepodataPackages::Package{};
+            parsed.filename = out.add_string(filename);
 
             if (auto name = pkg["name"]; !name.error())
             {
-                solv.set_name(name.get_string().value_unsafe());
+                parsed.name = out.add_string(name.get_string().value_unsafe());
             }
             else
             {
@@ -236,7 +270,7 @@ namespace mamba::solver::libsolv
 
             if (auto version = pkg["version"]; !version.error())
             {
-                solv.set_version(version.get_string().value_unsafe());
+                parsed.version = out.add_string(version.get_string().value_unsafe());
             }
             else
             {
@@ -246,7 +280,7 @@ namespace mamba::solver::libsolv
 
             if (auto build_string = pkg["build"]; !build_string.error())
             {
-                solv.set_build_string(build_string.get_string().value_unsafe());
+                parsed.build_string = out.add_string(build_string.get_string().value_unsafe());
             }
             else
             {
@@ -256,7 +290,7 @@ namespace mamba::solver::libsolv
 
             if (auto build_number = pkg["build_number"]; !build_number.error())
             {
-                solv.set_build_number(build_number.get_uint64().value_unsafe());
+                parsed.build_number = build_number.get_uint64().value_unsafe();
             }
             else
             {
@@ -266,43 +300,43 @@ namespace mamba::solver::libsolv
 
             if (auto subdir = pkg["subdir"]; !subdir.error())
             {
-                solv.set_platform(std::string(subdir.get_string().value_unsafe()));
+                parsed.platform = out.add_string(subdir.get_string().value_unsafe());
             }
             else
             {
-                solv.set_platform(default_subdir);
+                parsed.platform = out.add_string(default_subdir);
             }
 
             if (auto size = pkg["size"]; !size.error())
             {
-                solv.set_size(size.get_uint64().value_unsafe());
+                parsed.size = size.get_uint64().value_unsafe();
             }
 
             if (auto md5 = pkg["md5"]; !md5.error())
             {
-                solv.set_md5(std::string(md5.get_string().value_unsafe()));
+                parsed.md5 = out.add_string(md5.get_string().value_unsafe());
             }
 
             if (auto sha256 = pkg["sha256"]; !sha256.error())
             {
-                solv.set_sha256(std::string(sha256.get_string().value_unsafe()));
+                parsed.sha256 = out.add_string(sha256.get_string().value_unsafe());
             }
 
             if (auto elem = pkg["noarch"]; !elem.error())
             {
                 if (auto noarch = elem.get_bool(); !noarch.error() && noarch.value_unsafe())
                 {
-                    solv.set_noarch("generic");
+                    parsed.noarch = out.add_string("generic");
                 }
                 else if (elem.is_string())
                 {
-                    solv.set_noarch(std::string(elem.get_string().value_unsafe()));
+                    parsed.noarch = out.add_string(elem.get_string().value_unsafe());
                 }
             }
 
             if (auto license = pkg["license"]; !license.error())
             {
-                solv.set_license(std::string(license.get_string().value_unsafe()));
+                parsed.license = out.add_string(license.get_string().value_unsafe());
             }
 
             // TODO conda timestamp are not Unix timestamp.
@@ -311,103 +345,58 @@ namespace mamba::solver::libsolv
             if (auto timestamp = pkg["timestamp"]; !timestamp.error())
             {
                 const auto time = timestamp.get_uint64().value_unsafe();
-                solv.set_timestamp((time > MAX_CONDA_TIMESTAMP) ? (time / 1000) : time);
+                parsed.timestamp = (time > MAX_CONDA_TIMESTAMP) ? (time / 1000) : time;
             }
 
             if (auto depends = pkg["depends"].get_array(); !depends.error())
             {
-                for (auto elem : depends)
-                {
-                    if (!elem.error() && elem.is_string())
-                    {
-                        const auto ms = std::string(elem.get_string().value_unsafe());
-                        const auto maybe_dep_id = pool_add_matchspec(pool, ms.c_str(), parser);
-                        if (maybe_dep_id)
-                        {
-                            solv.add_dependency(*maybe_dep_id);
-                        }
-                        else
-                        {
-                            fmt::print(
-                                LOG_WARNING,
-                                R"(Found invalid MatchSpec "{}" in "{}")",
-                                ms,
-                                filename
-                            );
-                        }
-                    }
-                }
+                parsed.dependencies = read_string_list(out, depends);
             }
 
             if (auto constrains = pkg["constrains"]; !constrains.error())
             {
-                for (auto elem : constrains.get_array())
-                {
-                    if (!elem.error() && elem.is_string())
-                    {
-                        const auto ms = std::string(elem.get_string().value_unsafe());
-                        const auto maybe_dep_id = pool_add_matchspec(pool, ms.c_str(), parser);
-                        if (maybe_dep_id)
-                        {
-                            solv.add_constraint(*maybe_dep_id);
-                        }
-                        else
-                        {
-                            fmt::print(
-                                LOG_WARNING,
-                                R"(Found invalid MatchSpec "{}" in "{}")",
-                                ms,
-                                filename
-                            );
-                        }
-                    }
-                }
+                parsed.constraints = read_string_list(out, constrains.get_array());
             }
 
             if (auto obj = pkg["track_features"]; !obj.error())
             {
                 if (obj.is_string())
                 {
+                    parsed.track_features.first = out.lists.size();
                     auto splits = lsplit_track_features(obj.get_string().value_unsafe());
                     while (!splits[0].empty())
                     {
-                        solv.add_track_feature(splits[0]);
+                        out.lists.push_back(out.add_string(splits[0]));
                         splits = lsplit_track_features(splits[1]);
                     }
+                    parsed.track_features.last = out.lists.size();
                 }
                 else
                 {
                     // assuming obj is an array
-                    for (auto elem : obj.get_array())
-                    {
-                        if (!elem.error() && elem.is_string())
-                        {
-                            solv.add_track_feature(elem.get_string().value_unsafe());
-                        }
-                    }
+                    parsed.track_features = read_string_list(out, obj.get_array());
                 }
             }
 
             // Setting signatures in solvable if they are available and `verify-artifacts` flag is
             // enabled
-            set_solv_signatures(solv, filename, signatures);
+            if (auto sigs = signatures_for_file(filename, signatures); !sigs.empty())
+            {
+                parsed.signatures = out.add_string(sigs);
+            }
 
-            solv.add_self_provide();
+            out.packages.push_back(parsed);
             return true;
         }
 
         template <typename JSONObject, typename Filter, typename OnParsed>
-        void set_repo_solvables_impl(
-            solv::ObjPool& pool,
-            solv::ObjRepoView repo,
-            const specs::CondaURL& repo_url,
-            const std::string& channel_id,
+        void read_packages_impl(
+            RepodataPackages& out,
             const std::string& default_subdir,
             JSONObject& packages,
             const std::optional<nlohmann::json>& signatures,
             Filter&& filter,
-            OnParsed&& on_parsed,
-            MatchSpecParser parser
+            OnParsed&& on_parsed
         )
         {
             auto packages_as_object = packages.get_object();
@@ -416,25 +405,17 @@ namespace mamba::solver::libsolv
                 const std::string filename(pkg_field.unescaped_key().value());
                 if (filter(filename))
                 {
-                    auto [id, solv] = repo.add_solvable();
-                    const bool parsed = set_solvable(
-                        pool,
-                        repo_url,
-                        channel_id,
-                        solv,
-                        filename,
-                        pkg_field.value(),
-                        signatures,
-                        default_subdir,
-                        parser
-                    );
-                    if (parsed)
+                    // Strings of a package that failed to parse are dropped
+                    const auto buffer_size = out.buffer.size();
+                    const auto lists_size = out.lists.size();
+                    if (read_package(out, filename, pkg_field.value(), signatures, default_subdir))
                     {
                         on_parsed(filename);
                     }
                     else
                     {
-                        repo.remove_solvable(id, /* reuse_id= */ true);
+                        out.buffer.resize(buffer_size);
+                        out.lists.resize(lists_size);
                         LOG_WARNING << "Failed to parse from repodata " << filename;
                     }
                 }
@@ -442,89 +423,88 @@ namespace mamba::solver::libsolv
         }
 
         template <typename JSONObject>
-        void set_repo_solvables(
-            solv::ObjPool& pool,
-            solv::ObjRepoView repo,
-            const specs::CondaURL& repo_url,
-            const std::string& channel_id,
+        void read_packages(
+            RepodataPackages& out,
             const std::string& default_subdir,
             JSONObject& packages,
-            const std::optional<nlohmann::json>& signatures,
-            MatchSpecParser parser
+            const std::optional<nlohmann::json>& signatures
         )
         {
-            return set_repo_solvables_impl(
-                pool,
-                repo,
-                repo_url,
-                channel_id,
+            return read_packages_impl(
+                out,
                 default_subdir,
                 packages,
                 signatures,
                 /* filter= */ [](const auto&) { return true; },
-                /* on_parsed= */ [](const auto&) {},
-                parser
+                /* on_parsed= */ [](const auto&) {}
             );
         }
 
         template <typename JSONObject>
-        auto set_repo_solvables_and_return_added_filename_stem(
-            solv::ObjPool& pool,
-            solv::ObjRepoView repo,
-            const specs::CondaURL& repo_url,
-            const std::string& channel_id,
+        auto read_packages_and_return_added_filename_stem(
+            RepodataPackages& out,
             const std::string& default_subdir,
             JSONObject& packages,
-            const std::optional<nlohmann::json>& signatures,
-            MatchSpecParser parser
+            const std::optional<nlohmann::json>& signatures
         ) -> util::flat_set<std::string>
         {
-            auto filenames = util::flat_set<std::string>();
-            set_repo_solvables_impl(
-                pool,
-                repo,
-                repo_url,
-                channel_id,
+            auto filenames = std::vector<std::string>();
+            read_packages_impl(
+                out,
                 default_subdir,
                 packages,
                 signatures,
                 /* filter= */ [](const auto&) { return true; },
                 /* on_parsed= */
                 [&](const auto& fn)
-                { filenames.insert(std::string(specs::strip_archive_extension(fn))); },
-                parser
+                { filenames.emplace_back(specs::strip_archive_extension(fn)); }
             );
-            // Sort only once
-            return filenames;
+            // Sort only once, inserting in a flat_set one by one is quadratic
+            return util::flat_set<std::string>(std::move(filenames));
         }
 
         template <class JSONObject, class SortedStringRange>
-        void set_repo_solvables_if_not_already_set(
-            solv::ObjPool& pool,
-            solv::ObjRepoView repo,
-            const specs::CondaURL& repo_url,
-            const std::string& channel_id,
+        void read_packages_if_not_already_read(
+            RepodataPackages& out,
             const std::string& default_subdir,
             JSONObject& packages,
             const std::optional<nlohmann::json>& signatures,
-            const SortedStringRange& added,
-            MatchSpecParser parser
+            const SortedStringRange& added
         )
         {
-            return set_repo_solvables_impl(
-                pool,
-                repo,
-                repo_url,
-                channel_id,
+            return read_packages_impl(
+                out,
                 default_subdir,
                 packages,
                 signatures,
                 /* filter= */
                 [&](const auto& fn) { return !added.contains(specs::strip_archive_extension(fn)); },
-                /* on_parsed= */ [&](const auto&) {},
-                parser
+                /* on_parsed= */ [&](const auto&) {}
             );
         }
+
+        template <typename AddDependency>
+        void add_dependencies(
+            MatchSpecDependencyCache& cache,
+            const RepodataPackages& packages,
+            RepodataPackages::StringList list,
+            const char* filename,
+            AddDependency&& add
+        )
+        {
+            for (auto i = list.first; i < list.last; ++i)
+            {
+                const auto ms = packages.get(packages.lists[i]);
+                if (const auto maybe_dep_id = cache.add(ms))
+                {
+                    add(*maybe_dep_id);
+                }
+                else
+                {
+                    LOG_WARNING_FMT(R"(Found invalid MatchSpec "{}" in "{}")", ms, filename);
+                }
+            }
+        }
     }
 
     auto libsolv_read_json(
@@ -575,18 +555,33 @@ namespace mamba::solver::libsolv
             );
     }
 
-    auto mamba_read_json(
-        solv::ObjPool& pool,
-        solv::ObjRepoView repo,
+    auto RepodataPackages::add_string(std::string_view str) -> String
+    {
+        const auto out = String{ buffer.size(), str.size() };
+        buffer.append(str);
+        // Null terminated to be passed as is to libsolv
+        buffer.push_back('\0');
+        return out;
+    }
+
+    auto RepodataPackages::get(String str) const -> std::string_view
+    {
+        return { buffer.data() + str.offset, str.size };
+    }
+
+    auto RepodataPackages::c_str(String str) const -> const char*
+    {
+        return buffer.data() + str.offset;
+    }
+
+    auto mamba_parse_json(
         const fs::u8path& filename,
         const std::string& repo_url,
-        const std::string& channel_id,
         PackageTypes package_types,
-        MatchSpecParser ms_parser,
         bool verify_artifacts
-    ) -> expected_t<solv::ObjRepoView>
+    ) -> expected_t<RepodataPackages>
     {
-        LOG_INFO << "Reading repodata.json file " << filename << " for repo " << repo.name()
+        LOG_INFO << "Reading repodata.json file " << filename << " for repo " << repo_url
                  << " using mamba";
 
         // BEWARE:
@@ -665,9 +660,10 @@ namespace mamba::solver::libsolv
             return repo_url;
         }();
 
-        const auto parsed_url = specs::CondaURL::parse(base_url)
-                                    .or_else([](specs::ParseError&& err) { throw std::move(err); })
-                                    .value();
+        auto out = RepodataPackages();
+        out.base_url = specs::CondaURL::parse(base_url)
+                           .or_else([](specs::ParseError&& err) { throw std::move(err); })
+                           .value();
 
         auto signatures = [&]
         {
@@ -691,29 +687,21 @@ namespace mamba::solver::libsolv
             auto added = util::flat_set<std::string>();
             if (auto pkgs = repodata_doc["packages.conda"]; !pkgs.error())
             {
-                added = set_repo_solvables_and_return_added_filename_stem(  //
-                    pool,
-                    repo,
-                    parsed_url,
-                    channel_id,
+                added = read_packages_and_return_added_filename_stem(  //
+                    out,
                     default_subdir,
                     pkgs,
-                    json_signatures,
-                    ms_parser
+                    json_signatures
                 );
             }
             if (auto pkgs = repodata_doc["packages"]; !pkgs.error())
             {
-                set_repo_solvables_if_not_already_set(  //
-                    pool,
-                    repo,
-                    parsed_url,
-                    channel_id,
+                read_packages_if_not_already_read(  //
+                    out,
                     default_subdir,
                     pkgs,
                     json_signatures,
-                    added,
-                    ms_parser
+                    added
                 );
             }
         }
@@ -722,35 +710,166 @@ namespace mamba::solver::libsolv
             if (auto pkgs = repodata_doc["packages"];
                 !pkgs.error() && (package_types != PackageTypes::CondaOnly))
             {
-                set_repo_solvables(  //
-                    pool,
-                    repo,
-                    parsed_url,
-                    channel_id,
-                    default_subdir,
-                    pkgs,
-                    json_signatures,
-                    ms_parser
-                );
+                read_packages(out, default_subdir, pkgs, json_signatures);
             }
 
             if (auto pkgs = repodata_doc["packages.conda"];
                 !pkgs.error() && (package_types != PackageTypes::TarBz2Only))
             {
-                set_repo_solvables(  //
-                    pool,
-                    repo,
-                    parsed_url,
-                    channel_id,
-                    default_subdir,
-                    pkgs,
-                    json_signatures,
-                    ms_parser
-                );
+                read_packages(out, default_subdir, pkgs, json_signatures);
             }
         }
 
-        return { repo };
+        return { std::move(out) };
+    }
+
+    auto MatchSpecDependencyCache::Stats::hit_rate() const -> double
+    {
+        const auto total = hits + misses;
+        return (total > 0) ? static_cast<double>(hits) / static_cast<double>(total) : 0.;
+    }
+
+    MatchSpecDependencyCache::MatchSpecDependencyCache(solv::ObjPool& pool, MatchSpecParser parser)
+        : m_pool(&pool)
+        , m_parser(parser)
+    {
+    }
+
+    auto MatchSpecDependencyCache::add(std::string_view ms) -> expected_t<solv::DependencyId>
+    {
+        if (const auto it = m_ids.find(ms); it != m_ids.cend())
+        {
+            ++m_stats.hits;
+            return { it->second };
+        }
+        ++m_stats.misses;
+        // Invalid specs are not cached as they are not expected to be repeated.
+        return pool_add_matchspec(*m_pool, ms.data(), m_parser)
+            .transform(
+                [&](solv::DependencyId id)
+                {
+                    m_ids.emplace(ms, id);
+                    return id;
+                }
+            );
+    }
+
+    auto MatchSpecDependencyCache::stats() const -> const Stats&
+    {
+        return m_stats;
+    }
+
+    auto add_repodata_packages(
+        solv::ObjPool& pool,
+        solv::ObjRepoView repo,
+        const RepodataPackages& packages,
+        const std::string& channel_id,
+        MatchSpecParser parser
+    ) -> MatchSpecDependencyCache::Stats
+    {
+        auto dependency_cache = MatchSpecDependencyCache(pool, parser);
+
+        // Package urls are computed from the base url and their filename when needed.
+        repo.set_base_url(packages.base_url.str(specs::CondaURL::Credentials::Show));
+
+        for (const auto& pkg : packages.packages)
+        {
+            auto solv = repo.add_solvable().second;
+            const char* filename = packages.c_str(pkg.filename);
+
+            solv.set_channel(channel_id);
+            solv.set_file_name(filename);
+            solv.set_name(packages.get(pkg.name));
+            solv.set_version(packages.get(pkg.version));
+            solv.set_build_string(packages.get(pkg.build_string));
+            solv.set_build_number(pkg.build_number);
+            solv.set_platform(packages.c_str(pkg.platform));
+            if (pkg.size > 0)
+            {
+                solv.set_size(pkg.size);
+            }
+            if (pkg.md5.size > 0)
+            {
+                solv.set_md5(packages.c_str(pkg.md5));
+            }
+            if (pkg.sha256.size > 0)
+            {
+                solv.set_sha256(packages.c_str(pkg.sha256));
+            }
+            if (pkg.noarch.size > 0)
+            {
+                solv.set_noarch(packages.c_str(pkg.noarch));
+            }
+            if (pkg.license.size > 0)
+            {
+                solv.set_license(packages.c_str(pkg.license));
+            }
+            if (pkg.timestamp > 0)
+            {
+                solv.set_timestamp(pkg.timestamp);
+            }
+
+            add_dependencies(
+                dependency_cache,
+                packages,
+                pkg.dependencies,
+                filename,
+                [&](solv::DependencyId dep) { solv.add_dependency(dep); }
+            );
+            add_dependencies(
+                dependency_cache,
+                packages,
+                pkg.constraints,
+                filename,
+                [&](solv::DependencyId dep) { solv.add_constraint(dep); }
+            );
+
+            for (auto i = pkg.track_features.first; i < pkg.track_features.last; ++i)
+            {
+                solv.add_track_feature(packages.get(packages.lists[i]));
+            }
+
+            if (pkg.signatures.size > 0)
+            {
+                solv.set_signatures(packages.c_str(pkg.signatures));
+                LOG_INFO << "Signatures for '" << filename << "' are set in corresponding solvable.";
+            }
+
+            solv.add_self_provide();
+        }
+
+        const auto& stats = dependency_cache.stats();
+        LOG_INFO << fmt::format(
+            "Added {} packages to repo {}, parsed {} distinct MatchSpecs for {} dependencies "
+            "({:.1f}% cache hits)",
+            packages.packages.size(),
+            repo.name(),
+            stats.misses,
+            stats.hits + stats.misses,
+            100. * stats.hit_rate()
+        );
+        return stats;
+    }
+
+    auto mamba_read_json(
+        solv::ObjPool& pool,
+        solv::ObjRepoView repo,
+        const fs::u8path& filename,
+        const std::string& repo_url,
+        const std::string& channel_id,
+        PackageTypes package_types,
+        MatchSpecParser ms_parser,
+        bool verify_artifacts
+    ) -> expected_t<solv::ObjRepoView>
+    {
+        return mamba_parse_json(filename, repo_url, package_types, verify_artifacts)
+            .transform(
+                [&](RepodataPackages&& packages)
+                {
+                    add_repodata_packages(pool, repo, packages, channel_id, ms_parser);
+                    return repo;
+                }
+            );
     }
 
     [[nodiscard]] auto read_solv(
@@ -890,6 +1009,325 @@ namespace mamba::solver::libsolv
             );
     }
 
+    namespace
+    {
+        // A snapshot is the magic bytes, followed by the libsolv serialization of each repo,
+        // followed by a JSON footer with the snapshot metadata and the position of each repo, and
+        // finally the size of the footer.
+        constexpr auto snapshot_magic = std::string_view("MMBSNAP1");
+
+        /** A read only memory mapping of a whole file. */
+        class MappedFile
+        {
+        public:
+
+            static auto try_open(const fs::u8path& path) -> tl::expected<MappedFile, std::string>
+            {
+#ifdef _WIN32
+                return tl::unexpected(
+                    fmt::format(R"(Cannot map file "{}": not supported on Windows)", path)
+                );
+#else
+                const int fd = ::open(path.string().c_str(), O_RDONLY);
+                if (fd < 0)
+                {
+                    return tl::unexpected(fmt::format(R"(Cannot open file "{}")", path));
+                }
+                struct ::stat st = {};
+                void* data = MAP_FAILED;
+                if ((::fstat(fd, &st) == 0) && (st.st_size > 0))
+                {
+                    data = ::mmap(
+                        nullptr,
+                        static_cast<std::size_t>(st.st_size),
+                        PROT_READ,
+                        MAP_PRIVATE,
+                        fd,
+                        0
+                    );
+                }
+                ::close(fd);
+                if (data == MAP_FAILED)
+                {
+                    return tl::unexpected(fmt::format(R"(Cannot map file "{}")", path));
+                }
+                return MappedFile(
+                    static_cast<const char*>(data),
+                    static_cast<std::size_t>(st.st_size)
+                );
+#endif
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile(MappedFile&& other) noexcept
+                : m_data(std::exchange(other.m_data, nullptr))
+                , m_size(std::exchange(other.m_size, 0))
+            {
+            }
+
+            auto operator=(const MappedFile&) -> MappedFile& = delete;
+            auto operator=(MappedFile&&) -> MappedFile& = delete;
+
+            ~MappedFile()
+            {
+#ifndef _WIN32
+                if (m_data != nullptr)
+                {
+                    ::munmap(const_cast<char*>(m_data), m_size);
+                }
+#endif
+            }
+
+            [[nodiscard]] auto view() const -> std::string_view
+            {
+                return { m_data, m_size };
+            }
+
+        private:
+
+            const char* m_data = nullptr;
+            std::size_t m_size = 0;
+
+            MappedFile(const char* data, std::size_t size)
+                : m_data(data)
+                , m_size(size)
+            {
+            }
+        };
+
+        // Read a repo serialization from memory, without copying it.
+        auto read_solv_from_memory(solv::ObjRepoView repo, std::string_view data)
+            -> tl::expected<void, std::string>
+        {
+#ifdef _WIN32
+            return tl::unexpected(std::string("Reading from memory is not supported on Windows"));
+#else
+            // ``fmemopen`` does not write to the buffer in read mode.
+            std::FILE* file = ::fmemopen(const_cast<char*>(data.data()), data.size(), "rb");
+            if (file == nullptr)
+            {
+                return tl::unexpected(std::string("Cannot open memory stream"));
+            }
+            auto out = repo.read(file);
+            std::fclose(file);
+            return out;
+#endif
+        }
+
+        auto snapshot_footer(const std::vector<RepodataSnapshotEntry>& metadata, bool pip_added)
+            -> nlohmann::json
+        {
+            auto footer = nlohmann::json::object();
+            footer["tool_version"] = MAMBA_SOLV_VERSION;
+            footer["pip_added"] = pip_added;
+            footer["repos"] = metadata;
+            return footer;
+        }
+
+        auto snapshot_error(std::string_view msg, const fs::u8path& filename)
+        {
+            return make_unexpected(
+                fmt::format(R"({} in snapshot "{}")", msg, filename),
+                mamba_error_code::repodata_not_loaded
+            );
+        }
+
+        struct SnapshotFooter
+        {
+            nlohmann::json json;
+            /** The end of the repos serializations, where the footer starts. */
+            std::size_t repos_end = 0;
+        };
+
+        /**
+         * Parse the footer of a mapped snapshot.
+         *
+         * An error is returned if the snapshot was not written by this version of libsolv,
+         * or with another pip option.
+         */
+        auto read_snapshot_footer(
+            std::string_view data,
+            const fs::u8path& filename,
+            bool expected_pip_added
+        ) -> expected_t<SnapshotFooter>
+        {
+            std::uint64_t footer_size = 0;
+            if ((data.size() < snapshot_magic.size() + sizeof(footer_size))
+                || !util::starts_with(data, snapshot_magic))
+            {
+                return snapshot_error("Invalid header", filename);
+            }
+            const auto content_size = data.size() - sizeof(footer_size);
+            std::memcpy(&footer_size, data.data() + content_size, sizeof(footer_size));
+            if (footer_size > content_size - snapshot_magic.size())
+            {
+                return snapshot_error("Invalid footer", filename);
+            }
+            auto footer = nlohmann::json::parse(
+                data.substr(content_size - footer_size, footer_size),
+                /* cb= */ nullptr,
+                /* allow_exceptions= */ false
+            );
+            if (footer.is_discarded() || !footer.is_object() || !footer.contains("repos")
+                || !footer["repos"].is_array())
+            {
+                return snapshot_error("Invalid footer", filename);
+            }
+            const auto expected_footer = snapshot_footer({}, expected_pip_added);
+            const auto& expected_version = expected_footer.at("tool_version");
+            if ((footer.value("tool_version", nlohmann::json()) != expected_version)
+                || (footer.value("pip_added", !expected_pip_added) != expected_pip_added))
+            {
+                return snapshot_error("Outdated metadata", filename);
+            }
+            return { { std::move(footer), content_size - footer_size } };
+        }
+    }
+
+    auto read_solv_snapshot(
+        solv::ObjPool& pool,
+        const fs::u8path& filename,
+        const std::vector<RepodataSnapshotEntry>& expected,
+        bool expected_pip_added
+    ) -> expected_t<std::vector<solv::ObjRepoView>>
+    {
+        LOG_INFO << "Attempting to read libsolv snapshot " << filename;
+
+        if (!fs::exists(filename))
+        {
+            return make_unexpected(
+                fmt::format(R"(File "{}" does not exist)", filename),
+                mamba_error_code::repodata_not_loaded
+            );
+        }
+
+        auto lock = LockFile(filename);
+
+        auto maybe_mapped = MappedFile::try_open(filename);
+        if (!maybe_mapped)
+        {
+            return make_unexpected(maybe_mapped.error(), mamba_error_code::repodata_not_loaded);
+        }
+        const auto data = maybe_mapped->view();
+
+        auto maybe_footer = read_snapshot_footer(data, filename, expected_pip_added);
+        if (!maybe_footer)
+        {
+            return tl::unexpected(std::move(maybe_footer).error());
+        }
+        const auto& footer = maybe_footer->json;
+        const auto repos_end = maybe_footer->repos_end;
+        if (footer["repos"].get<std::vector<RepodataSnapshotEntry>>() != expected)
+        {
+            return snapshot_error("Outdated metadata", filename);
+        }
+
+        auto repos = std::vector<solv::ObjRepoView>();
+        repos.reserve(expected.size());
+        // The snapshot is removed so that it gets written again, since its metadata are current.
+        const auto remove_added = [&]()
+        {
+            for (auto repo : repos)
+            {
+                pool.remove_repo(repo.id(), /* reuse_ids= */ true);
+            }
+            std::error_code ec;
+            fs::remove(filename, ec);
+        };
+
+        const auto& positions = footer["repos"];
+        for (std::size_t i = 0; i < expected.size(); ++i)
+        {
+            const auto offset = positions[i].value("offset", std::uint64_t(0));
+            const auto size = positions[i].value("size", std::uint64_t(0));
+            if ((offset < snapshot_magic.size()) || (offset > repos_end)
+                || (size > repos_end - offset))
+            {
+                remove_added();
+                return snapshot_error("Invalid repo position", filename);
+            }
+
+            auto repo = pool.add_repo(expected[i].origin.url).second;
+            repos.push_back(repo);
+            if (auto read = read_solv_from_memory(repo, data.substr(offset, size)); !read)
+            {
+                remove_added();
+                return snapshot_error(read.error(), filename);
+            }
+            repo.set_url(expected[i].origin.url);
+            set_solvables_url(repo, expected[i].origin.url, expected[i].channel_id);
+            repo.internalize();
+        }
+
+        LOG_INFO << "Loaded " << repos.size() << " repos from libsolv snapshot " << filename;
+        return { std::move(repos) };
+    }
+
+    auto read_solv_snapshot_entries(const fs::u8path& filename, bool expected_pip_added)
+        -> expected_t<std::vector<RepodataSnapshotEntry>>
+    {
+        auto maybe_mapped = MappedFile::try_open(filename);
+        if (!maybe_mapped)
+        {
+            return make_unexpected(maybe_mapped.error(), mamba_error_code::repodata_not_loaded);
+        }
+        return read_snapshot_footer(maybe_mapped->view(), filename, expected_pip_added)
+            .transform(
+                [](SnapshotFooter&& footer)
+                { return footer.json["repos"].get<std::vector<RepodataSnapshotEntry>>(); }
+            );
+    }
+
+    auto write_solv_snapshot(
+        const std::vector<solv::ObjRepoView>& repos,
+        const fs::u8path& filename,
+        const std::vector<RepodataSnapshotEntry>& metadata,
+        bool pip_added
+    ) -> expected_t<void>
+    {
+        assert(repos.size() == metadata.size());
+        LOG_INFO << "Writing libsolv snapshot " << filename << " for " << repos.size() << " repos";
+
+        fs::create_directories(filename.parent_path());
+        const auto lock = LockFile(fs::exists(filename) ? filename : filename.parent_path());
+
+        auto footer = snapshot_footer(metadata, pip_added);
+
+        return util::CFile::try_open(filename, "wb")
+            .transform_error([](std::error_code&& ec) { return ec.message(); })
+            .and_then(
+                [&](util::CFile&& file_ptr) -> tl::expected<void, std::string>
+                {
+                    std::FILE* file = file_ptr.raw();
+                    std::fwrite(snapshot_magic.data(), 1, snapshot_magic.size(), file);
+                    for (std::size_t i = 0; i < repos.size(); ++i)
+                    {
+                        const auto offset = std::ftell(file);
+                        if (auto out = repos[i].write(file); !out)
+                        {
+                            return out;
+                        }
+                        footer["repos"][i]["offset"] = offset;
+                        footer["repos"][i]["size"] = std::ftell(file) - offset;
+                    }
+                    const auto footer_str = footer.dump();
+                    const std::uint64_t footer_size = footer_str.size();
+                    std::fwrite(footer_str.data(), 1, footer_str.size(), file);
+                    std::fwrite(&footer_size, sizeof(footer_size), 1, file);
+                    if (std::ferror(file) != 0)
+                    {
+                        return tl::unexpected(fmt::format(R"(Fail to write file "{}")", filename));
+                    }
+                    return file_ptr.try_close().transform_error([](const std::error_code& ec)
+                                                                { return ec.message(); });
+                }
+            )
+            .transform_error(
+                [](std::string&& str)
+                { return mamba_error(std::move(str), mamba_error_code::repodata_not_loaded); }
+            );
+    }
+
     void
     set_solvables_url(solv::ObjRepoView repo, const std::string& repo_url, const std::string& channel_id)
     {
@@ -899,13 +1337,12 @@ namespace mamba::solver::libsolv
         const auto url = specs::CondaURL::parse(repo_url)
                              .or_else([](specs::ParseError&& err) { throw std::move(err); })
                              .value();
+        // The solvable url, this is not set in libsolv parsing so we set a base url from which
+        // they are computed when needed.
+        repo.set_base_url(url.str(specs::CondaURL::Credentials::Show));
         repo.for_each_solvable(
             [&](solv::ObjSolvableView s)
             {
-                // The solvable url, this is not set in libsolv parsing so we set it manually
-                // while we still rely on libsolv for parsing
-                // TODO
-                s.set_url((url / s.file_name()).str(specs::CondaURL::Credentials::Show));
                 // The name of the channel where it came from, may be different from repo name
                 // for instance with the installed repo
                 s.set_channel(channel_id);
@@ -10,12 +10,15 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include "mamba/core/error_handling.hpp"
 #include "mamba/solver/libsolv/parameters.hpp"
 #include "mamba/solver/request.hpp"
 #include "mamba/solver/solution.hpp"
 #include "mamba/specs/channel.hpp"
+#include "mamba/specs/conda_url.hpp"
 #include "mamba/specs/match_spec.hpp"
 #include "mamba/specs/package_info.hpp"
 #include "solv-cpp/pool.hpp"
@@ -43,6 +46,14 @@ namespace mamba::solver::libsolv
         MatchSpecParser parser
     );
 
+    /**
+     * The url of the package of a solvable.
+     *
+     * Solvables added from a repodata do not store their url, it is computed from the base url
+     * of their repository and their filename.
+     */
+    [[nodiscard]] auto solvable_url(solv::ObjSolvableViewConst s) -> std::string;
+
     auto make_package_info(const solv::ObjPool& pool, solv::ObjSolvableViewConst s)
         -> specs::PackageInfo;
 
@@ -53,6 +64,110 @@ namespace mamba::solver::libsolv
         bool verify_artifacts
     ) -> expected_t<solv::ObjRepoView>;
 
+    /**
+     * Packages read from a ``repodata.json``, independently of any pool.
+     *
+     * The strings of all packages are stored, null terminated, in a single buffer.
+     * Reading the json does not need the pool and can therefore be done concurrently for several
+     * files, before adding the packages to the pool with @ref add_repodata_packages.
+     */
+    struct RepodataPackages
+    {
+        /** A string stored in ``buffer``. */
+        struct String
+        {
+            std::size_t offset = 0;
+            std::size_t size = 0;
+        };
+
+        /** A range of strings stored in ``lists``. */
+        struct StringList
+        {
+            std::size_t first = 0;
+            std::size_t last = 0;
+        };
+
+        /** The fields of a package, empty strings and null numbers are not set in libsolv. */
+        struct Package
+        {
+            String filename = {};
+            String name = {};
+            String version = {};
+            String build_string = {};
+            String platform = {};
+            String md5 = {};
+            String sha256 = {};
+            String noarch = {};
+            String license = {};
+            String signatures = {};
+            StringList dependencies = {};
+            StringList constraints = {};
+            StringList track_features = {};
+            std::size_t build_number = 0;
+            std::size_t size = 0;
+            std::size_t timestamp = 0;
+        };
+
+        specs::CondaURL base_url = {};
+        std::string buffer = {};
+        std::vector<String> lists = {};
+        std::vector<Package> packages = {};
+
+        auto add_string(std::string_view str) -> String;
+        [[nodiscard]] auto get(String str) const -> std::string_view;
+        [[nodiscard]] auto c_str(String str) const -> const char*;
+    };
+
+    [[nodiscard]] auto mamba_parse_json(
+        const fs::u8path& filename,
+        const std::string& repo_url,
+        PackageTypes types,
+        bool verify_artifacts
+    ) -> expected_t<RepodataPackages>;
+
+    /**
+     * Add MatchSpec dependencies to a pool, parsing each distinct string only once.
+     *
+     * The same dependencies are repeated many times in a repodata, so the cache is meant to be
+     * used for the duration of a repodata load.
+     * The strings used as keys are not copied and must outlive the cache.
+     */
+    class MatchSpecDependencyCache
+    {
+    public:
+
+        struct Stats
+        {
+            std::size_t hits = 0;
+            std::size_t misses = 0;
+
+            [[nodiscard]] auto hit_rate() const -> double;
+        };
+
+        MatchSpecDependencyCache(solv::ObjPool& pool, MatchSpecParser parser);
+
+        /** Add the dependency, the string must be null terminated. */
+        [[nodiscard]] auto add(std::string_view ms) -> expected_t<solv::DependencyId>;
+
+        [[nodiscard]] auto stats() const -> const Stats&;
+
+    private:
+
+        std::unordered_map<std::string_view, solv::DependencyId> m_ids = {};
+        Stats m_stats = {};
+        solv::ObjPool* m_pool;
+        MatchSpecParser m_parser;
+    };
+
+    /** Add the packages to the repo, returning the statistics of the dependency cache. */
+    auto add_repodata_packages(
+        solv::ObjPool& pool,
+        solv::ObjRepoView repo,
+        const RepodataPackages& packages,
+        const std::string& channel_id,
+        MatchSpecParser parser
+    ) -> MatchSpecDependencyCache::Stats;
+
     [[nodiscard]] auto mamba_read_json(
         solv::ObjPool& pool,
         solv::ObjRepoView repo,
@@ -78,6 +193,34 @@ namespace mamba::solver::libsolv
         const RepodataOrigin& metadata
     ) -> expected_t<solv::ObjRepoView>;
 
+    /**
+     * Read all the repos of a snapshot in new repos, with a single memory mapping of the file.
+     *
+     * On failure, the pool is left unchanged.
+     */
+    [[nodiscard]] auto read_solv_snapshot(
+        solv::ObjPool& pool,
+        const fs::u8path& filename,
+        const std::vector<RepodataSnapshotEntry>& expected,
+        bool expected_pip_added
+    ) -> expected_t<std::vector<solv::ObjRepoView>>;
+
+    /**
+     * Read the entries of a snapshot, without reading its repos.
+     *
+     * An error is returned if the snapshot cannot be read with the given pip option.
+     */
+    [[nodiscard]] auto
+    read_solv_snapshot_entries(const fs::u8path& filename, bool expected_pip_added)
+        -> expected_t<std::vector<RepodataSnapshotEntry>>;
+
+    [[nodiscard]] auto write_solv_snapshot(
+        const std::vector<solv::ObjRepoView>& repos,
+        const fs::u8path& filename,
+        const std::vector<RepodataSnapshotEntry>& metadata,
+        bool pip_added
+    ) -> expected_t<void>;
+
     void
     set_solvables_url(solv::ObjRepoView repo, const std::string& repo_url, const std::string& channel_id);
 
@@ -4,8 +4,11 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <algorithm>
+
 #include <fmt/format.h>
 
+#include "mamba/util/string.hpp"
 #include "solver/libsolv/matcher.hpp"
 
 namespace mamba::solver::libsolv
@@ -51,6 +54,46 @@ namespace mamba::solver::libsolv
         return m_channel_params;
     }
 
+    template <typename Func>
+    void Matcher::for_each_name_matching(  //
+        solv::ObjPoolView pool,
+        const specs::GlobSpec& glob,
+        Func&& func
+    )
+    {
+        auto name_less = [&](solv::StringId a, solv::StringId b)
+        { return pool.get_string(a) < pool.get_string(b); };
+
+        if (!m_names_sorted)
+        {
+            std::sort(m_names.begin(), m_names.end(), name_less);
+            m_names.erase(std::unique(m_names.begin(), m_names.end()), m_names.end());
+            m_names_sorted = true;
+        }
+
+        // Only the names starting with the literal prefix of the glob can match.
+        const auto& pattern = glob.to_string();
+        const auto prefix = std::string_view(pattern).substr(0, pattern.find(glob.glob_pattern));
+        auto it = std::lower_bound(
+            m_names.cbegin(),
+            m_names.cend(),
+            prefix,
+            [&](solv::StringId id, std::string_view str) { return pool.get_string(id) < str; }
+        );
+        for (; it != m_names.cend(); ++it)
+        {
+            const auto name = pool.get_string(*it);
+            if (!util::starts_with(name, prefix))
+            {
+                break;
+            }
+            if (glob.contains(name))
+            {
+                func(*it);
+            }
+        }
+    }
+
     auto Matcher::get_matching_packages(  //
         solv::ObjPoolView pool,
         const specs::MatchSpec& ms,
@@ -81,8 +124,25 @@ namespace mamba::solver::libsolv
         }
         else
         {
-            // Name is a Glob (e.g. ``py*``) so we have to loop through all packages.
-            pool.for_each_solvable(add_pkg_if_matching);
+            // Name is a Glob (e.g. ``py*``) so we narrow down on the names matching it first.
+            for_each_name_matching(
+                pool,
+                ms.name(),
+                [&](solv::StringId name_id)
+                {
+                    pool.for_each_whatprovides(
+                        name_id,
+                        [&](solv::ObjSolvableViewConst s)
+                        {
+                            // Only match on the package name, not on other things it provides
+                            if (s.raw()->name == name_id)
+                            {
+                                add_pkg_if_matching(s);
+                            }
+                        }
+                    );
+                }
+            );
         }
         if (m_packages_buffer.empty())
         {
@@ -110,43 +170,99 @@ namespace mamba::solver::libsolv
             .value();
     }
 
-    namespace
+    void Matcher::add_repo(solv::ObjRepoViewConst repo)
     {
-        template <typename Map>
-        [[nodiscard]] auto make_cached_version(Map& cache, std::string version)
-            -> specs::expected_parse_t<std::reference_wrapper<const specs::Version>>
+        const auto end = static_cast<std::size_t>(repo.raw()->end);
+        if (end > m_solvable_versions.size())
         {
-            if (auto it = cache.find(version); it != cache.cend())
+            m_solvable_versions.resize(end);
+        }
+        repo.for_each_solvable(
+            [&](solv::ObjSolvableViewConst solv)
             {
-                return { std::cref(it->second) };
+                // Invalid versions are reported when matching
+                [[maybe_unused]] auto ver = get_version(solv);
             }
-            if (version.empty())
+        );
+        add_repo_names(repo);
+    }
+
+    void Matcher::add_repo_names(solv::ObjRepoViewConst repo)
+    {
+        const auto names_size = m_names.size();
+        repo.for_each_solvable([&](solv::ObjSolvableViewConst solv)
+                               { m_names.push_back(solv.raw()->name); });
+        // Names are sorted by id here to remove duplicates, and by string when queried.
+        std::sort(m_names.begin() + static_cast<std::ptrdiff_t>(names_size), m_names.end());
+        m_names.erase(
+            std::unique(m_names.begin() + static_cast<std::ptrdiff_t>(names_size), m_names.end()),
+            m_names.end()
+        );
+        m_names_sorted = m_names_sorted && (m_names.size() == names_size);
+    }
+
+    auto Matcher::get_version(solv::ObjSolvableViewConst solv)
+        -> specs::expected_parse_t<version_const_ref>
+    {
+        const auto solv_id = static_cast<std::size_t>(solv.id());
+        const solv::StringId version_id = solv.raw()->evr;
+        if (solv_id < m_solvable_versions.size())
+        {
+            const auto& entry = m_solvable_versions[solv_id];
+            if ((entry.version != nullptr) && (entry.version_id == version_id))
             {
-                auto [it, inserted] = cache.emplace(std::move(version), specs::Version());
-                assert(inserted);
-                return { std::cref(it->second) };
+                return { std::cref(*entry.version) };
             }
-            return specs::Version::parse(version).transform(
-                [&](specs::Version&& ver) -> std::reference_wrapper<const specs::Version>
-                {
-                    auto [it, inserted] = cache.emplace(std::move(version), std::move(ver));
-                    assert(inserted);
-                    return { std::cref(it->second) };
-                }
-            );
         }
+
+        auto add_to_column = [&](const specs::Version& ver) -> version_const_ref
+        {
+            if (solv_id >= m_solvable_versions.size())
+            {
+                m_solvable_versions.resize(solv_id + 1);
+            }
+            m_solvable_versions[solv_id] = { version_id, &ver };
+            return { std::cref(ver) };
+        };
+
+        if (auto it = m_version_cache.find(version_id); it != m_version_cache.cend())
+        {
+            return add_to_column(it->second);
+        }
+        const auto version = solv.version();
+        if (version.empty())
+        {
+            auto [it, inserted] = m_version_cache.emplace(version_id, specs::Version());
+            assert(inserted);
+            return add_to_column(it->second);
+        }
+        return specs::Version::parse(version).transform(
+            [&](specs::Version&& ver) -> version_const_ref
+            {
+                auto [it, inserted] = m_version_cache.emplace(version_id, std::move(ver));
+                assert(inserted);
+                return add_to_column(it->second);
+            }
+        );
     }
 
-    auto Matcher::get_pkg_attributes(solv::ObjPoolView pool, solv::ObjSolvableViewConst solv)
-        -> expected_t<Pkg>
+    auto Matcher::Pkg::track_features() const -> const specs::MatchSpec::string_set&
     {
-        auto track_features = specs::MatchSpec::string_set();
-        for (solv::StringId id : solv.track_features())
+        if (!track_features_cache.has_value())
         {
-            track_features.insert(std::string(pool.get_string(id)));
+            auto& feats = track_features_cache.emplace();
+            for (solv::StringId id : solv.track_features())
+            {
+                feats.insert(std::string(pool.get_string(id)));
+            }
         }
+        return *track_features_cache;
+    }
 
-        return make_cached_version(m_version_cache, std::string(solv.version()))
+    auto Matcher::get_pkg_attributes(solv::ObjPoolView pool, solv::ObjSolvableViewConst solv)
+        -> expected_t<Pkg>
+    {
+        return get_version(solv)
             .transform(
                 [&](auto ver_ref)
                 {
@@ -158,8 +274,9 @@ namespace mamba::solver::libsolv
                         /* .md5= */ solv.md5(),
                         /* .sha256= */ solv.sha256(),
                         /* .license= */ solv.license(),
-                        /* .platform= */ std::string(solv.platform()),
-                        /* .track_features= */ std::move(track_features),
+                        /* .platform= */ solv.platform(),
+                        /* .pool= */ pool,
+                        /* .solv= */ solv,
                     };
                 }
             )
@@ -225,13 +342,47 @@ namespace mamba::solver::libsolv
             .and_then([&](specs::UnresolvedChannel&& uc) { return get_channels(uc); });
     }
 
+    auto Matcher::get_pkg_url(solv::ObjSolvableViewConst solv) -> std::optional<specs::CondaURL>
+    {
+        if (const auto url = solv.url(); !url.empty())
+        {
+            if (auto pkg_url = specs::CondaURL::parse(url))
+            {
+                return { std::move(pkg_url).value() };
+            }
+            return std::nullopt;
+        }
+
+        const auto repo = solv::ObjRepoViewConst::of_solvable(solv);
+        const auto base_url = repo.base_url();
+        if (base_url.empty())
+        {
+            return std::nullopt;
+        }
+        auto& entry = m_repo_url_cache[repo.id()];
+        if (entry.base_url != base_url)
+        {
+            entry.base_url = base_url;
+            entry.url = std::nullopt;
+            if (auto url = specs::CondaURL::parse(base_url))
+            {
+                entry.url = std::move(url).value();
+            }
+        }
+        if (!entry.url.has_value())
+        {
+            return std::nullopt;
+        }
+        return { entry.url.value() / solv.file_name() };
+    }
+
     auto Matcher::pkg_match_channels(  //
         solv::ObjSolvableViewConst solv,
         const channel_list& channels
     ) -> bool
     {
         // First check the package url
-        if (auto pkg_url = specs::CondaURL::parse(solv.url()))
+        if (auto pkg_url = get_pkg_url(solv))
         {
             for (const auto& chan : channels)
             {
@@ -8,15 +8,19 @@
 #define MAMBA_SOLVER_LIBSOLV_MATCHER
 
 #include <functional>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include "mamba/core/error_handling.hpp"
 #include "mamba/specs/channel.hpp"
+#include "mamba/specs/conda_url.hpp"
 #include "mamba/specs/match_spec.hpp"
 #include "mamba/specs/version.hpp"
 #include "solv-cpp/pool.hpp"
+#include "solv-cpp/repo.hpp"
 #include "solv-cpp/solvable.hpp"
 
 namespace mamba::solver::libsolv
@@ -45,6 +49,24 @@ namespace mamba::solver::libsolv
 
         [[nodiscard]] auto channel_params() const -> const specs::ChannelResolveParams&;
 
+        /**
+         * Index the solvables of the repository.
+         *
+         * The versions of all solvables are parsed and stored in a column indexed by solvable
+         * id that is reused for every subsequent matching.
+         * Package names are added to the table used to resolve MatchSpec with a glob name.
+         * Solvables added without being indexed still have their version parsed lazily, but are
+         * not found by glob names.
+         */
+        void add_repo(solv::ObjRepoViewConst repo);
+
+        /**
+         * Only add the package names of the repository to the table of glob names.
+         *
+         * Versions are then parsed lazily, when a MatchSpec first needs them.
+         */
+        void add_repo_names(solv::ObjRepoViewConst repo);
+
         auto get_matching_packages(  //
             solv::ObjPoolView pool,
             const specs::MatchSpec& ms,
@@ -61,7 +83,37 @@ namespace mamba::solver::libsolv
 
         using channel_list = specs::ChannelResolveParams::channel_list;
         using channel_list_const_ref = std::reference_wrapper<const channel_list>;
+        using version_const_ref = std::reference_wrapper<const specs::Version>;
+
+        /**
+         * Parsed version of a solvable.
+         *
+         * The string id is checked on lookup so that entries of removed solvables, whose
+         * ids may be reused by libsolv, are not mistaken for the new ones.
+         */
+        struct SolvableVersion
+        {
+            solv::StringId version_id = 0;
+            const specs::Version* version = nullptr;
+        };
 
+        /**
+         * Parsed base URL of a repository.
+         *
+         * The base URL string is checked on lookup since repository ids may be reused.
+         */
+        struct RepoBaseUrl
+        {
+            std::string base_url;
+            std::optional<specs::CondaURL> url;
+        };
+
+        /**
+         * A view of the solvable attributes used in ``MatchSpec::contains_except_channel``.
+         *
+         * All attributes are borrowed from the pool, except for the track features that are
+         * only materialised if the MatchSpec asks for them.
+         */
         struct Pkg
         {
             std::string_view name;
@@ -71,10 +123,20 @@ namespace mamba::solver::libsolv
             std::string_view md5;
             std::string_view sha256;
             std::string_view license;
-            std::string platform;
-            specs::MatchSpec::string_set track_features;
+            std::string_view platform;
+            solv::ObjPoolView pool;
+            solv::ObjSolvableViewConst solv;
+            mutable std::optional<specs::MatchSpec::string_set> track_features_cache = {};
+
+            [[nodiscard]] auto track_features() const -> const specs::MatchSpec::string_set&;
         };
 
+        template <typename Func>
+        void for_each_name_matching(solv::ObjPoolView pool, const specs::GlobSpec& glob, Func&&);
+
+        auto get_version(solv::ObjSolvableViewConst solv)
+            -> specs::expected_parse_t<version_const_ref>;
+
         auto get_pkg_attributes(  //
             solv::ObjPoolView pool,
             solv::ObjSolvableViewConst solv
@@ -89,6 +151,9 @@ namespace mamba::solver::libsolv
         auto get_channels(const specs::UnresolvedChannel& uc) -> expected_t<channel_list_const_ref>;
         auto get_channels(std::string_view chan) -> expected_t<channel_list_const_ref>;
 
+        /** The URL of the package, joined to the cached base URL of its repository if needed. */
+        auto get_pkg_url(solv::ObjSolvableViewConst solv) -> std::optional<specs::CondaURL>;
+
         auto pkg_match_channels(  //
             solv::ObjSolvableViewConst solv,
             const channel_list& channels
@@ -103,8 +168,15 @@ namespace mamba::solver::libsolv
         solv::ObjQueue m_packages_buffer = {};
         // No need for matchspec cache since they have the same string id they should be handled
         // by libsolv.
-        std::unordered_map<std::string, specs::Version> m_version_cache = {};
+        // Versions are keyed by their string id in the pool, which is unique per version string.
+        std::unordered_map<solv::StringId, specs::Version> m_version_cache = {};
+        // Dense column of parsed versions indexed by solvable id, pointing in the cache above.
+        std::vector<SolvableVersion> m_solvable_versions = {};
+        // Distinct package names, sorted by string lazily when resolving a glob name.
+        std::vector<solv::StringId> m_names = {};
+        bool m_names_sorted = true;
         std::unordered_map<std::string, channel_list> m_channel_cache = {};
+        std::unordered_map<solv::RepoId, RepoBaseUrl> m_repo_url_cache = {};
     };
 }
 #endif
@@ -55,4 +55,31 @@ namespace mamba::solver::libsolv
         p.etag = j.value("etag", "");
         p.mod = j.value("mod", "");
     }
+
+    auto operator==(const RepodataSnapshotEntry& lhs, const RepodataSnapshotEntry& rhs) -> bool
+    {
+        return (lhs.origin == rhs.origin) && (lhs.channel_id == rhs.channel_id)
+               && (lhs.priorities == rhs.priorities);
+    }
+
+    auto operator!=(const RepodataSnapshotEntry& lhs, const RepodataSnapshotEntry& rhs) -> bool
+    {
+        return !(lhs == rhs);
+    }
+
+    void to_json(nlohmann::json& j, const RepodataSnapshotEntry& m)
+    {
+        to_json(j, m.origin);
+        j["channel_id"] = m.channel_id;
+        j["priority"] = m.priorities.priority;
+        j["subpriority"] = m.priorities.subpriority;
+    }
+
+    void from_json(const nlohmann::json& j, RepodataSnapshotEntry& p)
+    {
+        from_json(j, p.origin);
+        p.channel_id = j.value("channel_id", "");
+        p.priorities.priority = j.value("priority", 0);
+        p.priorities.subpriority = j.value("subpriority", 0);
+    }
 }
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <cassert>
 #include <charconv>
+#include <cstdint>
 #include <iterator>
 #include <optional>
 #include <tuple>
@@ -386,9 +387,202 @@ namespace mamba::specs
      *  Implementation of Version  *
      *******************************/
 
+    namespace
+    {
+        /*
+         * The comparison key of a version is built so that a byte comparison gives the same
+         * order as the three-way comparison of the parts and atoms.
+         *
+         * The difficulty lies in the trailing elements that compare as empty (``1.0`` is ``1``).
+         * A sequence is therefore written without its trailing empty elements, and every other
+         * element is prefixed with a byte giving both the number of empty elements before it,
+         * and whether it is smaller or greater than an empty one.
+         * The end of a sequence is written as ``key_end``, which sits in between the two.
+         *
+         * - Smaller elements: ``0x01 + n_empty``, in ``[0x01, 0x7D]``, or ``0x7E`` and the
+         *   number of empties in big endian.
+         *   The more empty elements, the later the smaller element, the greater the sequence.
+         * - Greater elements: ``0xFE - n_empty``, in ``[0x82, 0xFE]``, or ``0x80`` and the
+         *   complement of the number of empties in big endian.
+         */
+        constexpr auto key_end = '\x7F';
+        constexpr std::size_t key_max_short_empties = 0x7C;
+
+        template <typename UInt>
+        void append_key_big_endian(std::string& key, UInt value)
+        {
+            for (std::size_t i = sizeof(UInt); i > 0; --i)
+            {
+                key.push_back(static_cast<char>((value >> (8 * (i - 1))) & 0xFF));
+            }
+        }
+
+        void append_key_number(std::string& key, std::size_t value)
+        {
+            if (value < 0xFF)
+            {
+                key.push_back(static_cast<char>(value));
+            }
+            else
+            {
+                key.push_back('\xFF');
+                append_key_big_endian(key, value);
+            }
+        }
+
+        void append_key_prefix(std::string& key, bool greater, std::size_t n_empty)
+        {
+            if (greater)
+            {
+                if (n_empty <= key_max_short_empties)
+                {
+                    key.push_back(static_cast<char>(0xFE - n_empty));
+                }
+                else
+                {
+                    key.push_back('\x80');
+                    append_key_big_endian(key, ~n_empty);
+                }
+            }
+            else
+            {
+                if (n_empty <= key_max_short_empties)
+                {
+                    key.push_back(static_cast<char>(0x01 + n_empty));
+                }
+                else
+                {
+                    key.push_back('\x7E');
+                    append_key_big_endian(key, n_empty);
+                }
+            }
+        }
+
+        auto is_empty_atom(const VersionPartAtom& atom) -> bool
+        {
+            return (atom.numeral() == 0) && atom.literal().empty();
+        }
+
+        auto is_greater_than_empty_atom(const VersionPartAtom& atom) -> bool
+        {
+            return (atom.numeral() > 0) || (atom.literal() == "post");
+        }
+
+        void append_key_atom(std::string& key, const VersionPartAtom& atom)
+        {
+            append_key_number(key, atom.numeral());
+            // Same special literals priority as in ``compare_three_way``
+            const auto& lit = atom.literal();
+            if (lit == "*")
+            {
+                key.push_back('\x01');
+            }
+            else if (lit == "dev")
+            {
+                key.push_back('\x02');
+            }
+            else if (lit == "_")
+            {
+                key.push_back('\x03');
+            }
+            else if (lit.empty())
+            {
+                key.push_back('\x05');
+            }
+            else if (lit == "post")
+            {
+                key.push_back('\x06');
+            }
+            else
+            {
+                key.push_back('\x04');
+                // Literals are compared as C strings
+                key.append(lit.c_str());
+                key.push_back('\x00');
+            }
+        }
+
+        /** Append the elements of a sequence, given the function to append a non empty one. */
+        template <typename Range, typename IsEmpty, typename IsGreater, typename Append>
+        void append_key_sequence(
+            std::string& key,
+            const Range& range,
+            IsEmpty is_empty,
+            IsGreater is_greater,
+            Append append
+        )
+        {
+            std::size_t n_empty = 0;
+            for (const auto& elem : range)
+            {
+                if (is_empty(elem))
+                {
+                    ++n_empty;
+                    continue;
+                }
+                append_key_prefix(key, is_greater(elem), n_empty);
+                append(key, elem);
+                n_empty = 0;
+            }
+            key.push_back(key_end);
+        }
+
+        auto is_empty_part(const VersionPart& part) -> bool
+        {
+            return std::all_of(part.atoms.cbegin(), part.atoms.cend(), is_empty_atom);
+        }
+
+        auto is_greater_than_empty_part(const VersionPart& part) -> bool
+        {
+            // Only called on non empty parts
+            const auto first = std::find_if_not(
+                part.atoms.cbegin(),
+                part.atoms.cend(),
+                is_empty_atom
+            );
+            assert(first != part.atoms.cend());
+            return is_greater_than_empty_atom(*first);
+        }
+
+        void append_key_part(std::string& key, const VersionPart& part)
+        {
+            append_key_sequence(
+                key,
+                part.atoms,
+                is_empty_atom,
+                is_greater_than_empty_atom,
+                append_key_atom
+            );
+        }
+
+        void append_key_common_version(std::string& key, const CommonVersion& version)
+        {
+            append_key_sequence(
+                key,
+                version,
+                is_empty_part,
+                is_greater_than_empty_part,
+                append_key_part
+            );
+        }
+
+        auto make_key(std::size_t epoch, const CommonVersion& version, const CommonVersion& local)
+            -> std::string
+        {
+            auto key = std::string();
+            // Most versions fit in a few bytes per part
+            key.reserve(3 + 6 * (version.size() + local.size()));
+            append_key_number(key, epoch);
+            append_key_common_version(key, version);
+            append_key_common_version(key, local);
+            return key;
+        }
+    }
+
     Version::Version(std::size_t epoch, CommonVersion version, CommonVersion local) noexcept
         : m_version{ std::move(version) }
         , m_local{ std::move(local) }
+        , m_key{ make_key(epoch, m_version, m_local) }
         , m_epoch{ epoch }
     {
     }
@@ -408,6 +602,11 @@ namespace mamba::specs
         return m_local;
     }
 
+    auto Version::key() const noexcept -> std::string_view
+    {
+        return m_key;
+    }
+
     auto Version::to_string() const -> std::string
     {
         return fmt::format("{}", *this);
@@ -441,26 +640,12 @@ namespace mamba::specs
                        [](const auto& x, const auto& y) { return compare_three_way(x, y); }
             ).first;
         }
-
-        template <>
-        auto compare_three_way(const Version& a, const Version& b) -> strong_ordering
-        {
-            if (auto c = compare_three_way(a.epoch(), b.epoch()); c != strong_ordering::equal)
-            {
-                return c;
-            }
-            if (auto c = compare_three_way(a.version(), b.version()); c != strong_ordering::equal)
-            {
-                return c;
-            }
-            return compare_three_way(a.local(), b.local());
-        }
     }
 
-    // TODO(C++20) use operator<=> to simplify code and improve operator<=
+    // The key orders in the same way as the three-way comparison of the parts, see make_key
     auto operator==(const Version& left, const Version& right) -> bool
     {
-        return compare_three_way(left, right) == strong_ordering::equal;
+        return left.key() == right.key();
     }
 
     auto operator!=(const Version& left, const Version& right) -> bool
@@ -470,22 +655,22 @@ namespace mamba::specs
 
     auto operator<(const Version& left, const Version& right) -> bool
     {
-        return compare_three_way(left, right) == strong_ordering::less;
+        return left.key() < right.key();
     }
 
     auto operator<=(const Version& left, const Version& right) -> bool
     {
-        return compare_three_way(left, right) != strong_ordering::greater;
+        return left.key() <= right.key();
     }
 
     auto operator>(const Version& left, const Version& right) -> bool
     {
-        return compare_three_way(left, right) == strong_ordering::greater;
+        return left.key() > right.key();
     }
 
     auto operator>=(const Version& left, const Version& right) -> bool
     {
-        return compare_three_way(left, right) != strong_ordering::less;
+        return left.key() >= right.key();
     }
 
     namespace
@@ -758,6 +943,11 @@ namespace mamba::specs
             static constexpr auto delims = std::string_view{ delims_buf.data(), delims_buf.size() };
 
             CommonVersion parts = {};
+            parts.reserve(1 + util::safe_num_cast<std::size_t>(std::count_if(
+                str.cbegin(),
+                str.cend(),
+                [](char c) { return delims.find(c) != std::string_view::npos; }
+            )));
             auto tail = str;
             std::size_t tail_delim_pos = 0;
             while (true)
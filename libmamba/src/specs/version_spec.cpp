@@ -17,6 +17,7 @@
 #include "mamba/util/tuple_hash.hpp"
 
 #include "specs/version_spec_impl.hpp"
+#include "specs/version_spec_program.hpp"
 
 namespace mamba::specs
 {
@@ -412,13 +413,21 @@ namespace mamba::specs
         return VersionSpec{ tree_type(std::move(inner_tree)) };
     }
 
-    VersionSpec::VersionSpec(tree_type&& tree) noexcept
+    VersionSpec::VersionSpec(tree_type&& tree)
         : m_tree(std::move(tree))
     {
+        if (auto program = VersionSpecProgram::compile(m_tree))
+        {
+            m_program = std::make_shared<const VersionSpecProgram>(std::move(program).value());
+        }
     }
 
     auto VersionSpec::contains(const Version& point) const -> bool
     {
+        if (m_program != nullptr)
+        {
+            return m_program->contains(point);
+        }
         return m_tree.evaluate([&point](const auto& node) { return node.contains(point); });
     }
 
@@ -466,6 +475,11 @@ namespace mamba::specs
         return m_tree.size();
     }
 
+    auto VersionSpec::expression() const -> const tree_type&
+    {
+        return m_tree;
+    }
+
     namespace
     {
         template <typename Val, typename Range>
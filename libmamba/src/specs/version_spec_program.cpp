@@ -0,0 +1,441 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <functional>
+#include <type_traits>
+#include <variant>
+
+#include "mamba/util/string.hpp"
+
+#include "specs/version_spec_program.hpp"
+
+namespace mamba::specs
+{
+    /****************************************
+     *  Implementation of VersionKeyRanges  *
+     ****************************************/
+
+    namespace
+    {
+        // Missing lower bounds are minus infinity, missing upper bounds are plus infinity.
+
+        using OptBound = std::optional<VersionKeyBound>;
+
+        auto lower_less(const OptBound& a, const OptBound& b) -> bool
+        {
+            if (!a.has_value() || !b.has_value())
+            {
+                return !a.has_value() && b.has_value();
+            }
+            if (a->key != b->key)
+            {
+                return a->key < b->key;
+            }
+            // A closed lower bound starts before an open one
+            return a->closed && !b->closed;
+        }
+
+        auto upper_less(const OptBound& a, const OptBound& b) -> bool
+        {
+            if (!a.has_value() || !b.has_value())
+            {
+                return a.has_value() && !b.has_value();
+            }
+            if (a->key != b->key)
+            {
+                return a->key < b->key;
+            }
+            // An open upper bound ends before a closed one
+            return !a->closed && b->closed;
+        }
+
+        auto is_empty(const VersionKeyInterval& interval) -> bool
+        {
+            if (!interval.lower.has_value() || !interval.upper.has_value())
+            {
+                return false;
+            }
+            if (interval.lower->key != interval.upper->key)
+            {
+                return interval.upper->key < interval.lower->key;
+            }
+            return !(interval.lower->closed && interval.upper->closed);
+        }
+
+        /** Whether ``next``, starting after ``current``, overlaps or touches it. */
+        auto is_contiguous(const VersionKeyInterval& current, const VersionKeyInterval& next)
+            -> bool
+        {
+            if (!current.upper.has_value() || !next.lower.has_value())
+            {
+                return true;
+            }
+            if (next.lower->key != current.upper->key)
+            {
+                return next.lower->key < current.upper->key;
+            }
+            return next.lower->closed || current.upper->closed;
+        }
+
+        auto is_full(const VersionKeyRanges& ranges) -> bool
+        {
+            return (ranges.size() == 1) && !ranges.front().lower.has_value()
+                   && !ranges.front().upper.has_value();
+        }
+    }
+
+    auto ranges_intersection(const VersionKeyRanges& a, const VersionKeyRanges& b)
+        -> VersionKeyRanges
+    {
+        auto out = VersionKeyRanges();
+        auto a_it = a.cbegin();
+        auto b_it = b.cbegin();
+        while ((a_it != a.cend()) && (b_it != b.cend()))
+        {
+            auto interval = VersionKeyInterval{
+                /* .lower= */ lower_less(a_it->lower, b_it->lower) ? b_it->lower : a_it->lower,
+                /* .upper= */ upper_less(a_it->upper, b_it->upper) ? a_it->upper : b_it->upper,
+            };
+            if (!is_empty(interval))
+            {
+                out.push_back(std::move(interval));
+            }
+            // The interval ending first cannot intersect anything further
+            if (upper_less(a_it->upper, b_it->upper))
+            {
+                ++a_it;
+            }
+            else
+            {
+                ++b_it;
+            }
+        }
+        return out;
+    }
+
+    auto ranges_union(const VersionKeyRanges& a, const VersionKeyRanges& b) -> VersionKeyRanges
+    {
+        auto all = VersionKeyRanges();
+        all.reserve(a.size() + b.size());
+        std::merge(
+            a.cbegin(),
+            a.cend(),
+            b.cbegin(),
+            b.cend(),
+            std::back_inserter(all),
+            [](const auto& x, const auto& y) { return lower_less(x.lower, y.lower); }
+        );
+
+        auto out = VersionKeyRanges();
+        for (auto& interval : all)
+        {
+            if (!out.empty() && is_contiguous(out.back(), interval))
+            {
+                if (upper_less(out.back().upper, interval.upper))
+                {
+                    out.back().upper = std::move(interval.upper);
+                }
+            }
+            else
+            {
+                out.push_back(std::move(interval));
+            }
+        }
+        return out;
+    }
+
+    auto ranges_contains(const VersionKeyRanges& ranges, std::string_view key) -> bool
+    {
+        for (const auto& interval : ranges)
+        {
+            if (interval.lower.has_value())
+            {
+                const auto cmp = key.compare(interval.lower->key);
+                // Intervals are sorted so the key is not in any of the following ones
+                if ((cmp < 0) || ((cmp == 0) && !interval.lower->closed))
+                {
+                    return false;
+                }
+            }
+            if (!interval.upper.has_value())
+            {
+                return true;
+            }
+            const auto cmp = key.compare(interval.upper->key);
+            if ((cmp < 0) || ((cmp == 0) && interval.upper->closed))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /******************************************
+     *  Implementation of VersionSpecProgram  *
+     ******************************************/
+
+    auto VersionSpecProgram::compile(const VersionSpec::tree_type& tree)
+        -> std::optional<VersionSpecProgram>
+    {
+        if (tree.empty())
+        {
+            return std::nullopt;
+        }
+
+        auto program = VersionSpecProgram();
+        auto fragments = std::vector<Fragment>();
+        tree.postfix_for_each(
+            [&](const auto& token)
+            {
+                using Token = std::decay_t<decltype(token)>;
+                if constexpr (std::is_same_v<Token, util::BoolOperator>)
+                {
+                    assert(fragments.size() >= 2);
+                    auto right = std::move(fragments.back());
+                    fragments.pop_back();
+                    auto left = std::move(fragments.back());
+                    fragments.pop_back();
+                    fragments.push_back(program.branch(token, std::move(left), std::move(right)));
+                }
+                else
+                {
+                    fragments.push_back(program.leaf(token));
+                }
+            }
+        );
+
+        assert(fragments.size() == 1);
+        auto& root = fragments.front();
+        program.materialize(root);
+        if (root.depth > max_depth)
+        {
+            return std::nullopt;
+        }
+        program.m_code = std::move(root.code);
+        return { std::move(program) };
+    }
+
+    auto VersionSpecProgram::contains(const Version& point) const -> bool
+    {
+        const auto key = point.key();
+        auto stack = std::array<bool, max_depth>{};
+        std::size_t top = 0;
+        for (const auto& instr : m_code)
+        {
+            switch (instr.op)
+            {
+                case OpCode::ranges:
+                {
+                    stack[top++] = ranges_contains(m_ranges[instr.operand], key);
+                    break;
+                }
+                case OpCode::starts_with:
+                {
+                    const auto& prefix = m_prefixes[instr.operand];
+                    if (!util::starts_with(key, prefix.necessary))
+                    {
+                        stack[top++] = false;
+                    }
+                    else
+                    {
+                        stack[top++] = (!prefix.sufficient.empty()
+                                        && util::starts_with(key, prefix.sufficient))
+                                       || m_predicates[instr.operand].contains(point);
+                    }
+                    break;
+                }
+                case OpCode::predicate:
+                {
+                    stack[top++] = m_predicates[instr.operand].contains(point);
+                    break;
+                }
+                case OpCode::logical_and:
+                {
+                    --top;
+                    stack[top - 1] = stack[top - 1] && stack[top];
+                    break;
+                }
+                case OpCode::logical_or:
+                {
+                    --top;
+                    stack[top - 1] = stack[top - 1] || stack[top];
+                    break;
+                }
+            }
+        }
+        assert(top == 1);
+        return stack[0];
+    }
+
+    auto VersionSpecProgram::size() const -> std::size_t
+    {
+        return m_code.size();
+    }
+
+    auto VersionSpecProgram::predicate_ranges(const VersionPredicate& pred)
+        -> std::optional<VersionKeyRanges>
+    {
+        const auto key = std::string(pred.m_version.key());
+        auto ranges = [](std::optional<VersionKeyBound> lower, std::optional<VersionKeyBound> upper)
+        { return VersionKeyRanges{ { std::move(lower), std::move(upper) } }; };
+
+        return std::visit(
+            [&](const auto& op) -> std::optional<VersionKeyRanges>
+            {
+                using Op = std::decay_t<decltype(op)>;
+                if constexpr (std::is_same_v<Op, VersionPredicate::free_interval>)
+                {
+                    return ranges(std::nullopt, std::nullopt);
+                }
+                else if constexpr (std::is_same_v<Op, std::equal_to<Version>>)
+                {
+                    return ranges({ { key, true } }, { { key, true } });
+                }
+                else if constexpr (std::is_same_v<Op, std::not_equal_to<Version>>)
+                {
+                    return VersionKeyRanges{
+                        { std::nullopt, { { key, false } } },
+                        { { { key, false } }, std::nullopt },
+                    };
+                }
+                else if constexpr (std::is_same_v<Op, std::greater<Version>>)
+                {
+                    return ranges({ { key, false } }, std::nullopt);
+                }
+                else if constexpr (std::is_same_v<Op, std::greater_equal<Version>>)
+                {
+                    return ranges({ { key, true } }, std::nullopt);
+                }
+                else if constexpr (std::is_same_v<Op, std::less<Version>>)
+                {
+                    return ranges(std::nullopt, { { key, false } });
+                }
+                else if constexpr (std::is_same_v<Op, std::less_equal<Version>>)
+                {
+                    return ranges(std::nullopt, { { key, true } });
+                }
+                else
+                {
+                    return std::nullopt;
+                }
+            },
+            pred.m_operator
+        );
+    }
+
+    auto VersionSpecProgram::leaf(const VersionPredicate& pred) -> Fragment
+    {
+        if (auto ranges = predicate_ranges(pred))
+        {
+            return { /* .ranges= */ std::move(ranges), /* .code= */ {}, /* .depth= */ 0 };
+        }
+
+        const auto operand = static_cast<std::uint32_t>(m_predicates.size());
+        m_predicates.push_back(pred);
+
+        auto prefix = KeyPrefix();
+        const bool is_starts_with = std::holds_alternative<VersionPredicate::starts_with>(
+            pred.m_operator
+        );
+        if (is_starts_with)
+        {
+            // The key of a version ends with the end of its version and local parts.
+            // A version starts with the prefix if its key starts with the prefix key, without
+            // the end markers, unless the prefix has trailing zero parts, which are not in the key.
+            const auto& ver = pred.m_version;
+            const auto& parts = ver.local().empty() ? ver.version() : ver.local();
+            const auto is_zero_part = [](const VersionPart& part)
+            {
+                return std::all_of(
+                    part.atoms.cbegin(),
+                    part.atoms.cend(),
+                    [](const auto& atom) { return atom == VersionPartAtom(); }
+                );
+            };
+            if (parts.empty() || !is_zero_part(parts.back()))
+            {
+                const auto key = ver.key();
+                prefix.sufficient = key.substr(0, key.size() - (ver.local().empty() ? 2 : 1));
+            }
+
+            // Any literal may follow the first number of the prefix, but the version must start
+            // with the same epoch and number.
+            // That is the key of a version with only this number, without its empty literal and
+            // the end markers of the atoms, version, and local.
+            if (!ver.version().empty() && !ver.version().front().atoms.empty())
+            {
+                const auto numeral = ver.version().front().atoms.front().numeral();
+                if (numeral > 0)
+                {
+                    const auto head = Version(ver.epoch(), { { { numeral } } });
+                    const auto key = head.key();
+                    prefix.necessary = key.substr(0, key.size() - 4);
+                }
+            }
+        }
+        m_prefixes.push_back(std::move(prefix));
+
+        const auto op = is_starts_with ? OpCode::starts_with : OpCode::predicate;
+        return { /* .ranges= */ {}, /* .code= */ { { op, operand } }, /* .depth= */ 1 };
+    }
+
+    auto VersionSpecProgram::branch(util::BoolOperator op, Fragment left, Fragment right)
+        -> Fragment
+    {
+        const bool is_and = (op == util::BoolOperator::logical_and);
+
+        if (left.ranges.has_value() && right.ranges.has_value())
+        {
+            return {
+                /* .ranges= */ is_and ? ranges_intersection(*left.ranges, *right.ranges)
+                                      : ranges_union(*left.ranges, *right.ranges),
+                /* .code= */ {},
+                /* .depth= */ 0,
+            };
+        }
+
+        // An empty set absorbs a conjunction, and a full one a disjunction
+        auto is_absorbing = [&](const Fragment& frag)
+        {
+            return frag.ranges.has_value()
+                   && (is_and ? frag.ranges->empty() : is_full(*frag.ranges));
+        };
+        if (is_absorbing(left))
+        {
+            return left;
+        }
+        if (is_absorbing(right))
+        {
+            return right;
+        }
+
+        materialize(left);
+        materialize(right);
+        auto out = Fragment{
+            /* .ranges= */ {},
+            /* .code= */ std::move(left.code),
+            /* .depth= */ std::max(left.depth, right.depth + 1),
+        };
+        out.code.insert(out.code.end(), right.code.cbegin(), right.code.cend());
+        out.code.push_back({ is_and ? OpCode::logical_and : OpCode::logical_or, 0 });
+        return out;
+    }
+
+    void VersionSpecProgram::materialize(Fragment& frag)
+    {
+        if (frag.ranges.has_value())
+        {
+            const auto operand = static_cast<std::uint32_t>(m_ranges.size());
+            m_ranges.push_back(std::move(frag.ranges).value());
+            frag.ranges.reset();
+            frag.code = { { OpCode::ranges, operand } };
+            frag.depth = 1;
+        }
+    }
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#ifndef MAMBA_SPECS_VERSION_SPEC_PROGRAM_HPP
+#define MAMBA_SPECS_VERSION_SPEC_PROGRAM_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mamba/specs/version.hpp"
+#include "mamba/specs/version_spec.hpp"
+
+namespace mamba::specs
+{
+    /** A bound of an interval of ``Version::key``. */
+    struct VersionKeyBound
+    {
+        std::string key;
+        bool closed;
+    };
+
+    /** An interval of ``Version::key``, where a missing bound is unbounded. */
+    struct VersionKeyInterval
+    {
+        std::optional<VersionKeyBound> lower = {};
+        std::optional<VersionKeyBound> upper = {};
+    };
+
+    /** A union of sorted and disjoint intervals of ``Version::key``. */
+    using VersionKeyRanges = std::vector<VersionKeyInterval>;
+
+    [[nodiscard]] auto ranges_intersection(const VersionKeyRanges& a, const VersionKeyRanges& b)
+        -> VersionKeyRanges;
+    [[nodiscard]] auto ranges_union(const VersionKeyRanges& a, const VersionKeyRanges& b)
+        -> VersionKeyRanges;
+    [[nodiscard]] auto ranges_contains(const VersionKeyRanges& ranges, std::string_view key)
+        -> bool;
+
+    /**
+     * A VersionSpec compiled into a flat postfix program on ``Version::key``.
+     *
+     * The comparison predicates (free, ``==``, ``!=``, ``<``, ``<=``, ``>``, ``>=``), and the
+     * conjunctions and disjunctions between them, are merged into key ranges.
+     * The ``starts_with`` predicates first check byte prefixes of the version key, which accept
+     * most matching versions and reject most others without looking at their parts.
+     * The remaining predicates are evaluated with ``VersionPredicate::contains``.
+     */
+    class VersionSpecProgram
+    {
+    public:
+
+        /** Compile the tree, or nothing if it is empty or too deep for the evaluation stack. */
+        [[nodiscard]] static auto compile(const VersionSpec::tree_type& tree)
+            -> std::optional<VersionSpecProgram>;
+
+        [[nodiscard]] auto contains(const Version& point) const -> bool;
+
+        /** The number of instructions of the program. */
+        [[nodiscard]] auto size() const -> std::size_t;
+
+    private:
+
+        enum struct OpCode : std::uint8_t
+        {
+            ranges,
+            starts_with,
+            predicate,
+            logical_and,
+            logical_or,
+        };
+
+        struct Instruction
+        {
+            OpCode op;
+            /** The index of the ranges or predicate operand. */
+            std::uint32_t operand;
+        };
+
+        /** A part of the program during compilation, kept as ranges while possible. */
+        struct Fragment
+        {
+            std::optional<VersionKeyRanges> ranges = {};
+            std::vector<Instruction> code = {};
+            std::size_t depth = 0;
+        };
+
+        /** Byte prefixes of ``Version::key`` to evaluate a ``starts_with`` predicate. */
+        struct KeyPrefix
+        {
+            /**
+             * Versions with a key starting with it start with the prefix.
+             *
+             * Empty when it cannot be computed (trailing zero parts are not in the key).
+             */
+            std::string sufficient = {};
+            /** Versions with a key not starting with it do not start with the prefix. */
+            std::string necessary = {};
+        };
+
+        static constexpr std::size_t max_depth = 32;
+
+        std::vector<Instruction> m_code = {};
+        std::vector<VersionKeyRanges> m_ranges = {};
+        std::vector<VersionPredicate> m_predicates = {};
+        /** For each predicate, the key prefix checks of ``starts_with``. */
+        std::vector<KeyPrefix> m_prefixes = {};
+
+        [[nodiscard]] static auto predicate_ranges(const VersionPredicate& pred)
+            -> std::optional<VersionKeyRanges>;
+
+        [[nodiscard]] auto leaf(const VersionPredicate& pred) -> Fragment;
+        [[nodiscard]] auto branch(util::BoolOperator op, Fragment left, Fragment right)
+            -> Fragment;
+        void materialize(Fragment& frag);
+    };
+}
+#endif
@@ -22,7 +22,9 @@ namespace mamba::validation
     {
         std::ifstream infile = mamba::open_ifstream(path);
         thread_local auto hasher = util::Sha256Hasher();
-        thread_local auto hash = hasher.file_hex(infile);
+        thread_local auto hash = util::Sha256Hasher::hex_array{};
+        // Assigned on each call, the returned view refers to the last computed hash
+        hash = hasher.file_hex(infile);
         return { hash.data(), hash.size() };
     }
 
@@ -30,7 +32,9 @@ namespace mamba::validation
     {
         std::ifstream infile = mamba::open_ifstream(path);
         thread_local auto hasher = util::Md5Hasher();
-        thread_local auto hash = hasher.file_hex(infile);
+        thread_local auto hash = util::Md5Hasher::hex_array{};
+        // Assigned on each call, the returned view refers to the last computed hash
+        hash = hasher.file_hex(infile);
         return { hash.data(), hash.size() };
     }
 
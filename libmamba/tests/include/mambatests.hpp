@@ -8,6 +8,9 @@
 #define LIBMAMBATESTS_HPP
 
 #include <array>
+#include <cstddef>
+#include <fstream>
+#include <string>
 #include <string_view>
 
 #include "mamba/core/context.hpp"
@@ -57,6 +60,43 @@ namespace mambatests
         return singletons().context;
     }
 
+    /**
+     * Write a linux-64 repodata with ``n_versions`` versions of ``n_names`` packages.
+     *
+     * The ``depends`` and ``constrains`` JSON array contents are written for every package, with
+     * ``{next}`` replaced by the name of the next package.
+     */
+    inline void write_large_repodata(
+        const mamba::fs::u8path& path,
+        std::size_t n_names,
+        std::size_t n_versions,
+        std::string_view depends,
+        std::string_view constrains
+    )
+    {
+        using mamba::util::concat;
+        auto out = std::ofstream(path.std_path());
+        out << R"({"info": {"subdir": "linux-64"}, "packages": {}, "packages.conda": {)";
+        for (std::size_t i = 0; i < n_names * n_versions; ++i)
+        {
+            const auto name = concat("pkg", std::to_string(i % n_names));
+            const auto version = concat("1.", std::to_string(i / n_names));
+            const auto next = concat("pkg", std::to_string((i + 1) % n_names));
+            auto pkg_depends = std::string(depends);
+            mamba::util::replace_all(pkg_depends, "{next}", next);
+            auto pkg_constrains = std::string(constrains);
+            mamba::util::replace_all(pkg_constrains, "{next}", next);
+            out << (i > 0 ? "," : "") << '"' << name << "-" << version << R"(-h0_0.conda": {)"  //
+                << R"("name": ")" << name << R"(", "version": ")" << version << R"(", )"
+                << R"("build": "h0_0", "build_number": 0, "subdir": "linux-64", )"
+                << R"("depends": [)" << pkg_depends << R"(], )"
+                << R"("constrains": [)" << pkg_constrains << R"(], )"
+                << R"("md5": "d41d8cd98f00b204e9800998ecf8427e", "size": 1234, )"
+                << R"("timestamp": 1700000000000})";
+        }
+        out << "}}";
+    }
+
     class EnvironmentCleaner
     {
     public:
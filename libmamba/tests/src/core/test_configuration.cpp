@@ -1160,6 +1160,26 @@ namespace mamba
 
 #undef TEST_BOOL_CONFIGURABLE
 
+            TEST_CASE_METHOD(Configuration, "timings_json")
+            {
+                std::string rc = "";
+
+                load_test_config(rc);
+                REQUIRE(ctx.output_params.timings_json.empty());
+                REQUIRE_FALSE(ctx.timings.enabled());
+
+                util::set_env("MAMBA_TIMINGS", "timings.json");
+                load_test_config(rc);
+                REQUIRE(ctx.output_params.timings_json == "timings.json");
+                REQUIRE(ctx.timings.enabled());
+
+                util::unset_env("MAMBA_TIMINGS");
+                ctx.output_params.timings_json.clear();
+                load_test_config(rc);
+                REQUIRE(ctx.output_params.timings_json.empty());
+                REQUIRE_FALSE(ctx.timings.enabled());
+            }
+
             TEST_CASE_METHOD(Configuration, "has_config_name")
             {
                 using namespace detail;
@@ -116,6 +116,146 @@ namespace mamba
                                                        // executed anymore as soon as `.close()` was
                                                        // called.
         }
+
+        TEST_CASE("submitted_tasks_complete_before_destruction_ends")
+        {
+            constexpr std::size_t arbitrary_task_count = 2048;
+            constexpr std::size_t arbitrary_tasks_per_generator = 24;
+            std::atomic<int> counter{ 0 };
+            {
+                MainExecutor executor;
+                executor.set_pool_size(4);
+
+                execute_tasks_from_concurrent_threads(
+                    arbitrary_task_count,
+                    arbitrary_tasks_per_generator,
+                    [&] { executor.submit([&] { ++counter; }); }
+                );
+                REQUIRE(executor.pool_size() == 4);
+            }  // All workers of the pool must have been joined here.
+            REQUIRE(counter == arbitrary_task_count);
+        }
+
+        TEST_CASE("submit_returns_task_result")
+        {
+            MainExecutor executor;
+            executor.set_pool_size(2);
+
+            auto sum = executor.submit([](int a, int b) { return a + b; }, 3, 4);
+            REQUIRE(sum.get() == 7);
+
+            auto failure = executor.submit([]() -> int { throw std::runtime_error("failure"); });
+            REQUIRE_THROWS_AS(failure.get(), std::runtime_error);
+        }
+
+        TEST_CASE("submit_from_submitted_tasks")
+        {
+            constexpr int arbitrary_task_count = 512;
+            std::atomic<int> counter{ 0 };
+            {
+                MainExecutor executor;
+                executor.set_pool_size(3);
+
+                std::vector<std::future<void>> outer_tasks;
+                for (int i = 0; i < arbitrary_task_count; ++i)
+                {
+                    outer_tasks.push_back(
+                        executor.submit([&] { executor.submit([&] { ++counter; }); })
+                    );
+                }
+                // Inner tasks are submitted before closing, they must all run.
+                for (auto& f : outer_tasks)
+                {
+                    f.wait();
+                }
+            }
+            REQUIRE(counter == arbitrary_task_count);
+        }
+
+        TEST_CASE("closed_executor_ignores_submitted_tasks")
+        {
+            MainExecutor executor;
+            executor.close();
+
+            auto future = executor.submit([] { throw "this code must never be executed"; });
+            REQUIRE_THROWS_AS(future.get(), std::future_error);
+        }
+
+        TEST_CASE("changing_pool_size_keeps_running_tasks")
+        {
+            std::atomic<int> counter{ 0 };
+            {
+                MainExecutor executor;
+                executor.set_pool_size(2);
+                auto first = executor.submit([&] { ++counter; });
+                first.wait();
+
+                executor.set_pool_size(5);
+                REQUIRE(executor.pool_size() == 5);
+                auto second = executor.submit([&] { ++counter; });
+                second.wait();
+            }
+            REQUIRE(counter == 2);
+        }
+
+        TEST_CASE("parallel_for_calls_each_index_once")
+        {
+            MainExecutor executor;
+            executor.set_pool_size(4);
+
+            constexpr std::size_t count = 1000;
+            std::vector<std::atomic<int>> calls(count);
+            executor.parallel_for(count, [&](std::size_t i) { ++calls[i]; });
+            for (const auto& c : calls)
+            {
+                REQUIRE(c == 1);
+            }
+
+            executor.parallel_for(0, [](std::size_t) { throw "this code must never be executed"; });
+        }
+
+        TEST_CASE("parallel_for_rethrows_first_error")
+        {
+            MainExecutor executor;
+            executor.set_pool_size(2);
+
+            REQUIRE_THROWS_AS(
+                executor.parallel_for(
+                    100,
+                    [](std::size_t i)
+                    {
+                        if (i == 10)
+                        {
+                            throw std::runtime_error("failure");
+                        }
+                    }
+                ),
+                std::runtime_error
+            );
+        }
+
+        TEST_CASE("parallel_for_from_busy_pool")
+        {
+            std::atomic<std::size_t> counter{ 0 };
+            {
+                MainExecutor executor;
+                executor.set_pool_size(2);
+
+                // All the workers run a parallel_for, their helpers cannot start.
+                std::vector<std::future<void>> outer_tasks;
+                for (int i = 0; i < 2; ++i)
+                {
+                    outer_tasks.push_back(executor.submit(
+                        [&] { executor.parallel_for(50, [&](std::size_t) { ++counter; }); }
+                    ));
+                }
+                for (auto& f : outer_tasks)
+                {
+                    f.get();
+                }
+            }
+            REQUIRE(counter == 100);
+        }
     }
 
 }
@@ -0,0 +1,363 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+#include <nlohmann/json.hpp>
+
+#include "mamba/core/util.hpp"
+#include "mamba/specs/package_info.hpp"
+#include "mamba/util/string.hpp"
+#include "mamba/validation/tools.hpp"
+
+// Private libmamba headers
+#include "core/link.hpp"
+#include "core/transaction_context.hpp"
+
+#include "mambatests.hpp"
+
+namespace mamba
+{
+    namespace
+    {
+        auto read_file(const fs::u8path& path) -> std::string
+        {
+            std::ifstream in(path.std_path(), std::ios::binary);
+            return { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+        }
+
+        // Writes an extracted package in ``cache`` with ``n_files`` files spread in directories,
+        // a text file with a prefix placeholder, a symlink to the first file, and ``n_links``
+        // other symlinks to the next files.
+        auto make_extracted_package(
+            const fs::u8path& cache,
+            std::size_t n_files,
+            std::size_t n_links = 0
+        ) -> specs::PackageInfo
+        {
+            auto pkg = specs::PackageInfo("pkg", "1.0", "h0_0", 0);
+            const auto pkg_dir = cache / pkg.str();
+            fs::create_directories(pkg_dir / "info");
+            fs::create_directories(pkg_dir / "bin");
+
+            auto paths = nlohmann::json::array();
+            for (std::size_t i = 0; i < n_files; ++i)
+            {
+                const auto path = util::concat(
+                    "lib/dir",
+                    std::to_string(i % 10),
+                    "/file_",
+                    std::to_string(i),
+                    ".txt"
+                );
+                fs::create_directories((pkg_dir / path).parent_path());
+                std::ofstream((pkg_dir / path).std_path()) << "content " << i << '\n';
+                paths.push_back({ { "_path", path },
+                                  { "path_type", "hardlink" },
+                                  { "size_in_bytes", 10 } });
+            }
+
+            std::ofstream((pkg_dir / "bin" / "script").std_path())
+                << "#!/opt/placeholder/bin/python\n";
+            paths.push_back({ { "_path", "bin/script" },
+                              { "path_type", "hardlink" },
+                              { "file_mode", "text" },
+                              { "prefix_placeholder", "/opt/placeholder" },
+                              { "size_in_bytes", 30 } });
+
+            fs::create_symlink("dir0/file_0.txt", pkg_dir / "lib" / "link.txt");
+            paths.push_back({ { "_path", "lib/link.txt" },
+                              { "path_type", "softlink" },
+                              { "size_in_bytes", 0 } });
+            for (std::size_t i = 1; i <= n_links; ++i)
+            {
+                const auto path = util::concat("lib/link_", std::to_string(i), ".txt");
+                const auto target = util::concat(
+                    "dir",
+                    std::to_string(i % 10),
+                    "/file_",
+                    std::to_string(i),
+                    ".txt"
+                );
+                fs::create_symlink(target, pkg_dir / path);
+                paths.push_back({ { "_path", path },
+                                  { "path_type", "softlink" },
+                                  { "size_in_bytes", 0 } });
+            }
+
+            std::ofstream((pkg_dir / "info" / "paths.json").std_path())
+                << nlohmann::json{ { "paths", paths }, { "paths_version", 1 } }.dump();
+            std::ofstream((pkg_dir / "info" / "repodata_record.json").std_path())
+                << nlohmann::json{ { "name", pkg.name },
+                                   { "version", pkg.version },
+                                   { "build", pkg.build_string },
+                                   { "build_number", pkg.build_number } }
+                       .dump();
+            return pkg;
+        }
+
+        // Feeds ``data`` by chunks of ``chunk_size`` bytes to a PrefixReplacer.
+        auto replace_prefix(
+            std::string_view data,
+            std::string_view placeholder,
+            std::string_view new_prefix,
+            FileMode mode,
+            std::size_t chunk_size
+        ) -> std::string
+        {
+            auto out = std::string();
+            auto replacer = PrefixReplacer(
+                std::string(placeholder),
+                std::string(new_prefix),
+                mode,
+                [&](std::string_view chunk) { out += chunk; }
+            );
+            for (std::size_t pos = 0; pos < data.size(); pos += chunk_size)
+            {
+                replacer.feed(data.substr(pos, chunk_size));
+            }
+            replacer.finish();
+            return out;
+        }
+
+        TEST_CASE("PrefixReplacer")
+        {
+            const auto chunk_size = GENERATE(std::size_t(1), 2, 3, 7, 1000);
+            CAPTURE(chunk_size);
+
+            SECTION("Text")
+            {
+                const auto mode = FileMode::TEXT;
+                REQUIRE(replace_prefix("", "/old", "/new", mode, chunk_size) == "");
+                REQUIRE(
+                    replace_prefix("no prefix", "/old", "/new", mode, chunk_size) == "no prefix"
+                );
+                REQUIRE(
+                    replace_prefix("a=/old/bin:/old/lib\n/ol", "/old", "/prefix", mode, chunk_size)
+                    == "a=/prefix/bin:/prefix/lib\n/ol"
+                );
+                REQUIRE(
+                    replace_prefix("/old/old", "/old", "/new", mode, chunk_size) == "/new/new"
+                );
+                REQUIRE(
+                    replace_prefix("#!/old/bin/python\n/old", "/old", "/p", mode, chunk_size)
+                    == "#!/p/bin/python\n/p"
+                );
+
+                const auto long_prefix = "/" + std::string(MAX_SHEBANG_LENGTH, 'x');
+                const auto shebang = replace_prefix(
+                    "#!/old/bin/python -E\nprint()\n",
+                    "/old",
+                    long_prefix,
+                    mode,
+                    chunk_size
+                );
+                if (util::on_win)
+                {
+                    REQUIRE(
+                        shebang == util::concat("#!", long_prefix, "/bin/python -E\nprint()\n")
+                    );
+                }
+                else
+                {
+                    REQUIRE(shebang == "#!/usr/bin/env python -E\nprint()\n");
+                }
+            }
+
+            SECTION("Binary")
+            {
+                const auto mode = FileMode::BINARY;
+                using namespace std::string_literals;
+                REQUIRE(
+                    replace_prefix("ab\0/old/lib\0cd"s, "/old", "/n", mode, chunk_size)
+                    == "ab\0/n/lib\0\0\0cd"s
+                );
+                // Padding of all replacements is at the end of the string
+                REQUIRE(
+                    replace_prefix("/old/a:/old/b\0/old"s, "/old", "/n", mode, chunk_size)
+                    == "/n/a:/n/b\0\0\0\0\0/n\0\0"s
+                );
+                REQUIRE(
+                    replace_prefix("x/old\0"s, "/old", "/longer", mode, chunk_size)
+                    == "x/longer\0"s
+                );
+            }
+        }
+
+        TEST_CASE("probe_link_capabilities")
+        {
+            TemporaryDirectory tmp;
+            const auto src = tmp.path() / "src.txt";
+            std::ofstream(src.std_path()) << "content";
+            fs::create_directories(tmp.path() / "target");
+
+            const auto capabilities = probe_link_capabilities(src, tmp.path() / "target");
+            REQUIRE(capabilities.hardlink);
+            REQUIRE(fs::is_empty(tmp.path() / "target"));
+
+            SECTION("Supported strategies copy the file")
+            {
+                std::error_code ec;
+                if (capabilities.reflink)
+                {
+                    reflink_file(src, tmp.path() / "target" / "reflink.txt", ec);
+                    REQUIRE_FALSE(ec);
+                    REQUIRE(read_file(tmp.path() / "target" / "reflink.txt") == "content");
+                }
+                if (capabilities.copy_file_range)
+                {
+                    copy_file_range_file(src, tmp.path() / "target" / "range.txt", ec);
+                    REQUIRE_FALSE(ec);
+                    REQUIRE(read_file(tmp.path() / "target" / "range.txt") == "content");
+                }
+            }
+
+            SECTION("Failures do not leave files behind")
+            {
+                std::error_code ec;
+                reflink_file(tmp.path() / "missing.txt", tmp.path() / "target" / "a.txt", ec);
+                REQUIRE(ec);
+                copy_file_range_file(src, tmp.path() / "missing" / "b.txt", ec);
+                REQUIRE(ec);
+                REQUIRE(fs::is_empty(tmp.path() / "target"));
+            }
+
+            SECTION("Capabilities are cached per pair of directories")
+            {
+                const auto first = link_capabilities(tmp.path(), tmp.path() / "target", src);
+                fs::remove(src);
+                const auto second = link_capabilities(tmp.path(), tmp.path() / "target", src);
+                REQUIRE(second.hardlink == first.hardlink);
+                REQUIRE(second.reflink == first.reflink);
+            }
+        }
+
+        auto make_transaction_context(const fs::u8path& prefix, bool always_copy = false)
+            -> TransactionContext
+        {
+            auto params = mambatests::context().transaction_params();
+            params.prefix_params.target_prefix = prefix;
+            params.prefix_params.relocate_prefix = prefix;
+            params.link_params.always_copy = always_copy;
+            return { std::move(params), { "", "" }, {} };
+        }
+
+        TEST_CASE("LinkPackage")
+        {
+            TemporaryDirectory tmp;
+            const auto cache = tmp.path() / "pkgs";
+            const auto prefix = tmp.path() / "prefix";
+            fs::create_directories(prefix);
+            const auto pkg = make_extracted_package(cache, 200);
+
+            auto transaction_context = make_transaction_context(prefix);
+            LinkPackage(pkg, cache, &transaction_context).execute();
+
+            const auto meta = nlohmann::json::parse(
+                read_file(prefix / "conda-meta" / "pkg-1.0-h0_0.json")
+            );
+            const auto paths = read_paths(cache / pkg.str());
+            REQUIRE(meta["files"].size() == paths.size());
+            REQUIRE(meta["paths_data"]["paths"].size() == paths.size());
+            for (std::size_t i = 0; i < paths.size(); ++i)
+            {
+                // Records are in the order of the package paths
+                REQUIRE(meta["files"][i] == paths[i].path);
+                REQUIRE(meta["paths_data"]["paths"][i]["_path"] == paths[i].path);
+                REQUIRE(lexists(prefix / paths[i].path));
+            }
+
+            REQUIRE(read_file(prefix / "lib/dir7/file_17.txt") == "content 17\n");
+            REQUIRE(
+                read_file(prefix / "bin/script")
+                == util::concat("#!", prefix.string(), "/bin/python\n")
+            );
+
+            const auto& link_record = meta["paths_data"]["paths"][paths.size() - 1];
+            REQUIRE(link_record["path_type"] == "softlink");
+            REQUIRE(
+                link_record["sha256_in_prefix"]
+                == validation::sha256sum(prefix / "lib/dir0/file_0.txt")
+            );
+        }
+
+        TEST_CASE("LinkPackage symlinks")
+        {
+            TemporaryDirectory tmp;
+            const auto cache = tmp.path() / "pkgs";
+            const auto pkg = make_extracted_package(cache, 30, 20);
+
+            // The prefix is reached through a symlink, unlike the canonical symlink targets
+            fs::create_directories(tmp.path() / "real_prefix");
+            fs::create_directory_symlink(tmp.path() / "real_prefix", tmp.path() / "prefix");
+            const auto prefix = tmp.path() / "prefix";
+
+            auto transaction_context = make_transaction_context(prefix);
+            LinkPackage(pkg, cache, &transaction_context).execute();
+
+            const auto meta = nlohmann::json::parse(
+                read_file(prefix / "conda-meta" / "pkg-1.0-h0_0.json")
+            );
+            const auto paths = read_paths(cache / pkg.str());
+            for (std::size_t i = 0; i < paths.size(); ++i)
+            {
+                if (paths[i].path_type == PathType::SOFTLINK)
+                {
+                    CAPTURE(paths[i].path);
+                    REQUIRE(
+                        meta["paths_data"]["paths"][i]["sha256_in_prefix"]
+                        == validation::sha256sum(prefix / paths[i].path)
+                    );
+                }
+            }
+        }
+
+        TEST_CASE("LinkPackage strategies")
+        {
+            TemporaryDirectory tmp;
+            const auto cache = tmp.path() / "pkgs";
+            const auto pkg = make_extracted_package(cache, 20);
+            const bool always_copy = GENERATE(false, true);
+            CAPTURE(always_copy);
+
+            const auto prefix = tmp.path() / "prefix";
+            auto transaction_context = make_transaction_context(prefix, always_copy);
+            LinkPackage(pkg, cache, &transaction_context).execute();
+
+            // Only the plain files are counted, not the symlink nor the file with a placeholder
+            const auto& stats = transaction_context.link_statistics();
+            REQUIRE(
+                stats.count(LinkStrategy::Reflink) + stats.count(LinkStrategy::Hardlink)
+                    + stats.count(LinkStrategy::CopyFileRange) + stats.count(LinkStrategy::Copy)
+                == 20
+            );
+            REQUIRE(stats.count(LinkStrategy::Softlink) == 0);
+            if (always_copy)
+            {
+                REQUIRE(stats.count(LinkStrategy::Hardlink) == 0);
+            }
+            REQUIRE(read_file(prefix / "lib/dir3/file_13.txt") == "content 13\n");
+        }
+
+        TEST_CASE("LinkPackage many files", "[.benchmark]")
+        {
+            TemporaryDirectory tmp;
+            const auto cache = tmp.path() / "pkgs";
+            const auto pkg = make_extracted_package(cache, 20'000, 5'000);
+
+            std::size_t run = 0;
+            BENCHMARK("execute")
+            {
+                const auto prefix = tmp.path() / util::concat("prefix", std::to_string(run++));
+                auto transaction_context = make_transaction_context(prefix);
+                return LinkPackage(pkg, cache, &transaction_context).execute();
+            };
+        }
+    }
+}
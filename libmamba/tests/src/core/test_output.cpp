@@ -4,11 +4,22 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include <catch2/catch_all.hpp>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/sinks/stdout_sinks.h>
 
 #include "mamba/core/context.hpp"
 #include "mamba/core/output.hpp"
 
+#include "core/async_log_sink.hpp"
 #include "mambatests.hpp"
 
 namespace mamba
@@ -27,5 +38,304 @@ namespace mamba
             REQUIRE(proxy.defined());
             REQUIRE(proxy);
         }
+
+        TEST_CASE("LOG macros")
+        {
+            auto& ctx = mambatests::context();
+            const auto level = ctx.output_params.logging_level;
+            ctx.set_log_level(log_level::err);
+
+            REQUIRE_FALSE(MessageLogger::is_enabled(log_level::debug));
+            REQUIRE_FALSE(MessageLogger::is_enabled(log_level::warn));
+            REQUIRE(MessageLogger::is_enabled(log_level::err));
+
+            int evaluated = 0;
+            auto count = [&evaluated] { return ++evaluated; };
+
+            // Not evaluated below the level
+            LOG_DEBUG << "Evaluated " << count();
+            LOG_WARNING_FMT("Evaluated {}", count());
+            REQUIRE(evaluated == 0);
+
+            LOG_ERROR << "Testing LOG_ERROR " << count();
+            LOG_ERROR_FMT("Testing LOG_ERROR_FMT {}", count());
+            REQUIRE(evaluated == 2);
+
+            ctx.set_log_level(level);
+        }
+
+        TEST_CASE("Logging below the level", "[.benchmark]")
+        {
+            auto& ctx = mambatests::context();
+            const auto level = ctx.output_params.logging_level;
+            ctx.set_log_level(log_level::info);
+
+            // As logged for every file when linking a package
+            const auto path = std::string("lib/python3.12/site-packages/numpy/_core/_umath.so");
+            static constexpr std::size_t n_files = 10'000;
+
+            // The unconditional stream of the LOG macros before they check the level
+            BENCHMARK("MessageLogger::stream")
+            {
+                for (std::size_t i = 0; i < n_files; ++i)
+                {
+                    MessageLogger(log_level::trace).stream() << "linking '" << path << "'";
+                }
+            };
+
+            BENCHMARK("LOG_TRACE")
+            {
+                for (std::size_t i = 0; i < n_files; ++i)
+                {
+                    LOG_TRACE << "linking '" << path << "'";
+                }
+            };
+
+            BENCHMARK("LOG_TRACE_FMT")
+            {
+                for (std::size_t i = 0; i < n_files; ++i)
+                {
+                    LOG_TRACE_FMT("linking '{}'", path);
+                }
+            };
+
+            ctx.set_log_level(level);
+        }
+
+        /** Keep the payload of the messages, optionally waiting to be released. */
+        class CollectingSink : public spdlog::sinks::base_sink<std::mutex>
+        {
+        public:
+
+            explicit CollectingSink(bool released = true)
+                : m_released(released)
+            {
+            }
+
+            void release()
+            {
+                m_released.store(true);
+                m_released.notify_all();
+            }
+
+            auto messages() -> std::vector<std::string>
+            {
+                const std::lock_guard<std::mutex> lock(mutex_);
+                return m_messages;
+            }
+
+        protected:
+
+            void sink_it_(const spdlog::details::log_msg& msg) override
+            {
+                m_released.wait(false);
+                m_messages.emplace_back(msg.payload.data(), msg.payload.size());
+            }
+
+            void flush_() override
+            {
+            }
+
+        private:
+
+            std::vector<std::string> m_messages;
+            std::atomic<bool> m_released;
+        };
+
+        void log_to(spdlog::sinks::sink& sink, const std::string& msg)
+        {
+            sink.log(spdlog::details::log_msg("test", spdlog::level::info, msg));
+        }
+
+        /** Check the messages "<thread> <number>" are increasing for every thread. */
+        void check_order(const std::vector<std::string>& messages, std::size_t n_threads)
+        {
+            auto last = std::vector<int>(n_threads, -1);
+            for (const auto& msg : messages)
+            {
+                const auto sep = msg.find(' ');
+                const auto thread = std::stoul(msg.substr(0, sep));
+                const auto number = std::stoi(msg.substr(sep + 1));
+                REQUIRE(number > last.at(thread));
+                last.at(thread) = number;
+            }
+        }
+
+        TEST_CASE("AsyncLogQueue")
+        {
+            SECTION("Capacity")
+            {
+                REQUIRE(AsyncLogQueue(0, LogOverflowPolicy::Block).capacity() == 2);
+                REQUIRE(AsyncLogQueue(8, LogOverflowPolicy::Block).capacity() == 8);
+                REQUIRE(AsyncLogQueue(100, LogOverflowPolicy::Block).capacity() == 128);
+            }
+
+            SECTION("Block keeps all messages in order")
+            {
+                static constexpr std::size_t n_threads = 4;
+                static constexpr int n_messages = 2000;
+
+                auto queue = std::make_shared<AsyncLogQueue>(16, LogOverflowPolicy::Block);
+                auto collecting = std::make_shared<CollectingSink>();
+                auto sink = AsyncLogSink(queue, collecting);
+
+                auto threads = std::vector<std::thread>();
+                for (std::size_t t = 0; t < n_threads; ++t)
+                {
+                    threads.emplace_back(
+                        [&sink, t]
+                        {
+                            for (int i = 0; i < n_messages; ++i)
+                            {
+                                log_to(sink, std::to_string(t) + " " + std::to_string(i));
+                            }
+                        }
+                    );
+                }
+                for (auto& t : threads)
+                {
+                    t.join();
+                }
+                sink.flush();
+
+                const auto messages = collecting->messages();
+                REQUIRE(messages.size() == n_threads * n_messages);
+                check_order(messages, n_threads);
+                REQUIRE(queue->dropped() == 0);
+            }
+
+            SECTION("DropOldest keeps the newest messages")
+            {
+                static constexpr int n_messages = 100;
+
+                auto queue = std::make_shared<AsyncLogQueue>(4, LogOverflowPolicy::DropOldest);
+                auto collecting = std::make_shared<CollectingSink>(/* released= */ false);
+                auto sink = AsyncLogSink(queue, collecting);
+
+                for (int i = 0; i < n_messages; ++i)
+                {
+                    log_to(sink, "0 " + std::to_string(i));
+                }
+                collecting->release();
+                sink.flush();
+
+                const auto messages = collecting->messages();
+                // The queue and the message being written
+                REQUIRE(messages.size() <= queue->capacity() + 1);
+                REQUIRE(messages.size() + queue->dropped() == n_messages);
+                REQUIRE(messages.back() == "0 " + std::to_string(n_messages - 1));
+                check_order(messages, 1);
+            }
+
+            SECTION("Close writes the queued messages")
+            {
+                auto queue = std::make_shared<AsyncLogQueue>(64, LogOverflowPolicy::Block);
+                auto collecting = std::make_shared<CollectingSink>();
+                auto sink = AsyncLogSink(queue, collecting);
+
+                for (int i = 0; i < 10; ++i)
+                {
+                    log_to(sink, "0 " + std::to_string(i));
+                }
+                queue->close();
+                REQUIRE(collecting->messages().size() == 10);
+
+                // Logged synchronously once closed
+                log_to(sink, "0 10");
+                REQUIRE(collecting->messages().size() == 11);
+                check_order(collecting->messages(), 1);
+            }
+        }
+
+        TEST_CASE("Context::set_async_logging")
+        {
+            auto& ctx = mambatests::context();
+            const auto is_async = []
+            {
+                const auto& sink = spdlog::default_logger()->sinks().front();
+                return std::dynamic_pointer_cast<AsyncLogSink>(sink) != nullptr;
+            };
+
+            ctx.set_async_logging(64, LogOverflowPolicy::DropOldest);
+            REQUIRE(is_async());
+            LOG_ERROR << "Testing asynchronous logging";
+
+            ctx.set_async_logging(64, LogOverflowPolicy::Block);
+            const auto async_sink = std::dynamic_pointer_cast<AsyncLogSink>(
+                spdlog::default_logger()->sinks().front()
+            );
+            REQUIRE(async_sink != nullptr);
+            // Wrapped only once
+            REQUIRE(std::dynamic_pointer_cast<AsyncLogSink>(async_sink->wrapped()) == nullptr);
+            REQUIRE(async_sink->queue()->policy() == LogOverflowPolicy::Block);
+
+            // Unchanged, including the capacity once rounded
+            ctx.set_async_logging(63, LogOverflowPolicy::Block);
+            REQUIRE(spdlog::default_logger()->sinks().front() == async_sink);
+
+            ctx.set_async_logging(128, LogOverflowPolicy::Block);
+            REQUIRE(spdlog::default_logger()->sinks().front() != async_sink);
+            // The replaced queue is closed, its sinks log synchronously
+            auto collecting = std::make_shared<CollectingSink>();
+            auto replaced = AsyncLogSink(async_sink->queue(), collecting);
+            log_to(replaced, "closed");
+            REQUIRE(collecting->messages().size() == 1);
+
+            ctx.set_async_logging(0, LogOverflowPolicy::Block);
+            REQUIRE_FALSE(is_async());
+        }
+
+        TEST_CASE("Logging from many threads", "[.benchmark]")
+        {
+            static constexpr std::size_t n_threads = 8;
+            static constexpr std::size_t n_messages = 2'000;
+
+            // Flushed after every message, as the terminal sinks
+            auto* null_file = std::fopen("/dev/null", "w");
+            REQUIRE(null_file != nullptr);
+            using file_sink_t = spdlog::sinks::stdout_sink_base<spdlog::details::console_mutex>;
+            auto file_sink = std::make_shared<file_sink_t>(null_file);
+
+            const auto log_from_threads = [](spdlog::sinks::sink& sink)
+            {
+                auto threads = std::vector<std::thread>();
+                for (std::size_t t = 0; t < n_threads; ++t)
+                {
+                    threads.emplace_back(
+                        [&sink]
+                        {
+                            for (std::size_t i = 0; i < n_messages; ++i)
+                            {
+                                log_to(sink, "Downloading lib/python3.12/site-packages/module.py");
+                            }
+                        }
+                    );
+                }
+                for (auto& t : threads)
+                {
+                    t.join();
+                }
+            };
+
+            // The time spent by the logging threads
+            BENCHMARK("Synchronous")
+            {
+                log_from_threads(*file_sink);
+            };
+
+            auto queue = std::make_shared<AsyncLogQueue>(
+                n_threads * n_messages,
+                LogOverflowPolicy::Block
+            );
+            auto async_sink = AsyncLogSink(queue, file_sink);
+            BENCHMARK_ADVANCED("AsyncLogSink")(Catch::Benchmark::Chronometer meter)
+            {
+                meter.measure([&] { log_from_threads(async_sink); });
+                async_sink.flush();
+            };
+
+            queue->close();
+            std::fclose(null_file);
+        }
     }
 }  // namespace mamba
@@ -4,6 +4,8 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <chrono>
+
 #include <catch2/catch_all.hpp>
 
 #include "mamba/core/context.hpp"
@@ -85,5 +87,28 @@ namespace
             // Should correspond to PackageFetcher::url_path()
             REQUIRE(req.url_path == "linux-64/xtensor-0.25.0-h00ab1b0_0.conda");
         }
+
+        SECTION("Recording timings")
+        {
+            static constexpr std::string_view url = "https://conda.anaconda.org/conda-forge/linux-64/pkg-6.4-bld.conda";
+            auto pkg_info = specs::PackageInfo::from_url(url).value();
+
+            ctx.timings.enable();
+            PackageFetcher pkg_fetcher{ pkg_info, package_caches };
+            auto req = pkg_fetcher.build_download_request(
+                std::nullopt,
+                ExtractOptions::from_context(ctx)
+            );
+
+            auto success = download::Success();
+            success.transfer.downloaded_size = 42;
+            success.transfer.total_time_us = 1500;
+            REQUIRE(req.on_success.value()(success).has_value());
+
+            const auto fetch = ctx.timings.item("fetch", pkg_info.name);
+            REQUIRE(fetch.has_value());
+            REQUIRE(fetch->wall_time == std::chrono::microseconds(1500));
+            REQUIRE(ctx.timings.counter("fetch.downloaded_bytes") == 42);
+        }
     }
 }
@@ -0,0 +1,238 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+
+#include "mamba/core/package_handling.hpp"
+#include "mamba/core/thread_utils.hpp"
+#include "mamba/core/util.hpp"
+#include "mamba/specs/archive.hpp"
+#include "mamba/util/environment.hpp"
+#include "mamba/util/string.hpp"
+
+namespace
+{
+    using namespace mamba;
+
+    // Writes a package directory with an ``info/index.json`` and some files in ``lib``.
+    void make_package_dir(const fs::u8path& dir, const std::string& name, std::size_t n_files)
+    {
+        fs::create_directories(dir / "info");
+        fs::create_directories(dir / "lib");
+        {
+            std::ofstream index((dir / "info" / "index.json").std_path());
+            index << R"({"name": ")" << name << R"(", "version": "1.0", "build": "0"})";
+        }
+        for (std::size_t i = 0; i < n_files; ++i)
+        {
+            const auto filename = util::concat("file_", std::to_string(i), ".txt");
+            std::ofstream file((dir / "lib" / filename).std_path());
+            file << name << " content " << i << '\n';
+        }
+    }
+
+    auto make_packages(const fs::u8path& root, std::size_t n_pkgs, std::size_t n_files)
+        -> std::vector<fs::u8path>
+    {
+        std::vector<fs::u8path> tarballs;
+        for (std::size_t i = 0; i < n_pkgs; ++i)
+        {
+            const auto name = util::concat("pkg", std::to_string(i));
+            const auto ext = (i % 2 == 0) ? ".tar.bz2" : ".conda";
+            const auto src = root / "src" / name;
+            make_package_dir(src, name, n_files);
+            tarballs.push_back(root / util::concat(name, "-1.0-0", ext));
+            create_package(src, tarballs.back(), 1, 1);
+        }
+        return tarballs;
+    }
+
+    auto extract_options() -> ExtractOptions
+    {
+        return { /* .sparse = */ false, /* .subproc_mode = */ extract_subproc_mode::mamba_package };
+    }
+
+    TEST_CASE("extract_concurrently")
+    {
+        TemporaryDirectory tmp;
+        const auto tarballs = make_packages(tmp.path(), 8, 20);
+        const auto cwd = fs::current_path();
+
+        std::vector<std::thread> workers;
+        for (const auto& tarball : tarballs)
+        {
+            workers.emplace_back([&tarball] { extract(tarball, extract_options()); });
+        }
+        for (auto& w : workers)
+        {
+            w.join();
+        }
+
+        REQUIRE(fs::current_path() == cwd);
+        for (std::size_t i = 0; i < tarballs.size(); ++i)
+        {
+            const auto name = util::concat("pkg", std::to_string(i));
+            const auto dest = tmp.path() / util::concat(name, "-1.0-0");
+            REQUIRE(fs::exists(dest / "info" / "index.json"));
+            std::ifstream file((dest / "lib" / "file_7.txt").std_path());
+            std::string line;
+            std::getline(file, line);
+            REQUIRE(line == util::concat(name, " content 7"));
+        }
+    }
+
+    // Reads the package file and feeds it to the extractor by chunks of ``chunk_size`` bytes.
+    void feed_package(CondaStreamExtractor& extractor, const fs::u8path& file, std::size_t chunk_size)
+    {
+        std::ifstream in(file.std_path(), std::ios::binary);
+        std::string chunk(chunk_size, '\0');
+        std::size_t offset = 0;
+        while (in.read(chunk.data(), static_cast<std::streamsize>(chunk.size())) || in.gcount() > 0)
+        {
+            const auto size = static_cast<std::size_t>(in.gcount());
+            extractor.feed(offset, std::string_view(chunk.data(), size));
+            offset += size;
+        }
+    }
+
+    TEST_CASE("CondaStreamExtractor")
+    {
+        TemporaryDirectory tmp;
+        const auto src = tmp.path() / "src" / "pkg";
+        make_package_dir(src, "pkg", 20);
+        const auto tarball = tmp.path() / "pkg-1.0-0.conda";
+        create_package(src, tarball, 1, 1);
+        const auto dest = tmp.path() / "pkg-1.0-0.streaming";
+        auto semaphore = counting_semaphore(1);
+
+        SECTION("Content fed in order")
+        {
+            CondaStreamExtractor extractor(dest, extract_options(), semaphore);
+            feed_package(extractor, tarball, 1000);
+            REQUIRE(extractor.wait());
+            REQUIRE(fs::exists(dest / "info" / "index.json"));
+            std::ifstream file((dest / "lib" / "file_7.txt").std_path());
+            std::string line;
+            std::getline(file, line);
+            REQUIRE(line == "pkg content 7");
+        }
+
+        SECTION("Content fed in small chunks")
+        {
+            // Many chunks are copied in each block handed to libarchive
+            CondaStreamExtractor extractor(dest, extract_options(), semaphore);
+            feed_package(extractor, tarball, 7);
+            extractor.close();
+            REQUIRE(extractor.wait());
+            REQUIRE(fs::exists(dest / "lib" / "file_19.txt"));
+        }
+
+        SECTION("Download restarting")
+        {
+            CondaStreamExtractor extractor(dest, extract_options(), semaphore);
+            const auto head = std::string(10, 'x');
+            extractor.feed(0, head);
+            feed_package(extractor, tarball, 1000);
+            REQUIRE_FALSE(extractor.wait());
+        }
+
+        SECTION("Truncated content")
+        {
+            CondaStreamExtractor extractor(dest, extract_options(), semaphore);
+            std::ifstream in(tarball.std_path(), std::ios::binary);
+            std::string head(100, '\0');
+            in.read(head.data(), static_cast<std::streamsize>(head.size()));
+            extractor.feed(0, head);
+            REQUIRE_FALSE(extractor.wait());
+        }
+
+        SECTION("Extraction slower than the download")
+        {
+            CondaStreamExtractor extractor(dest, extract_options(), semaphore, 10);
+            feed_package(extractor, tarball, 1000);
+            REQUIRE_FALSE(extractor.wait());
+        }
+
+        SECTION("Too many extractions running")
+        {
+            // The only slot is taken, as by another extraction
+            semaphore.lock();
+            {
+                CondaStreamExtractor extractor(dest, extract_options(), semaphore);
+                feed_package(extractor, tarball, 1000);
+                REQUIRE_FALSE(extractor.wait());
+            }
+            semaphore.unlock();
+
+            // The slot is released by the finished extraction
+            for (int i = 0; i < 2; ++i)
+            {
+                CondaStreamExtractor extractor(dest, extract_options(), semaphore);
+                feed_package(extractor, tarball, 1000);
+                REQUIRE(extractor.wait());
+            }
+        }
+
+        REQUIRE_FALSE(fs::exists(dest));
+    }
+
+    TEST_CASE("extract_package_cache", "[.benchmark]")
+    {
+        static constexpr std::size_t n_pkgs = 300;
+        TemporaryDirectory tmp;
+        const auto tarballs = make_packages(tmp.path(), n_pkgs, 50);
+        const auto n_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+        // Extracts all the tarballs using ``n_threads`` threads picking packages in turn.
+        auto extract_all = [&](auto extract_func)
+        {
+            std::atomic<std::size_t> next{ 0 };
+            std::vector<std::thread> workers;
+            for (std::size_t t = 0; t < n_threads; ++t)
+            {
+                workers.emplace_back(
+                    [&]
+                    {
+                        for (auto i = next++; i < tarballs.size(); i = next++)
+                        {
+                            const auto dest = tmp.path() / "out"
+                                              / specs::strip_archive_extension(tarballs[i].filename()
+                                              );
+                            extract_func(tarballs[i], dest, extract_options());
+                        }
+                    }
+                );
+            }
+            for (auto& w : workers)
+            {
+                w.join();
+            }
+        };
+
+        BENCHMARK("in-process")
+        {
+            return extract_all([](const auto& f, const auto& d, const auto& o)
+                               { extract(f, d, o); });
+        };
+
+        if (!util::which("mamba-package").empty())
+        {
+            BENCHMARK("subprocess")
+            {
+                return extract_all([](const auto& f, const auto& d, const auto& o)
+                                   { extract_subproc(f, d, o); });
+            };
+        }
+    }
+}
@@ -0,0 +1,319 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include <catch2/catch_all.hpp>
+#include <nlohmann/json.hpp>
+
+#include "mamba/core/channel_context.hpp"
+#include "mamba/core/prefix_data.hpp"
+#include "mamba/core/util.hpp"
+#include "mamba/util/string.hpp"
+
+// Private libmamba headers
+#include "core/prefix_index.hpp"
+#include "core/transaction_context.hpp"
+
+#include "mambatests.hpp"
+
+namespace
+{
+    using namespace mamba;
+
+    // Writes a conda-meta record with ``n_files`` entries in ``files`` and ``paths_data``.
+    void write_record(const fs::u8path& prefix, nlohmann::json record, std::size_t n_files)
+    {
+        auto files = nlohmann::json::array();
+        auto paths = nlohmann::json::array();
+        for (std::size_t i = 0; i < n_files; ++i)
+        {
+            const auto path = util::concat("lib/file_", std::to_string(i), ".txt");
+            files.push_back(path);
+            paths.push_back({ { "_path", path },
+                              { "path_type", "hardlink" },
+                              { "sha256", std::string(64, 'a') },
+                              { "size_in_bytes", 10 } });
+        }
+        record["files"] = files;
+        record["paths_data"] = { { "paths", paths }, { "paths_version", 1 } };
+
+        const auto filename = util::concat(
+            record["name"].get<std::string>(),
+            "-",
+            record["version"].get<std::string>(),
+            "-",
+            record.value("build", "0"),
+            ".json"
+        );
+        std::ofstream((prefix / "conda-meta" / filename).std_path()) << record.dump();
+    }
+
+    auto make_record(const std::string& name) -> nlohmann::json
+    {
+        return {
+            { "name", name },
+            { "version", "1.2.3" },
+            { "build", "h123_0" },
+            { "build_number", 0 },
+            { "channel", "https://conda.anaconda.org/conda-forge/linux-64" },
+            { "subdir", "linux-64" },
+            { "fn", util::concat(name, "-1.2.3-h123_0.conda") },
+            { "url", util::concat("https://conda.anaconda.org/conda-forge/linux-64/", name) },
+            { "md5", "0123456789abcdef0123456789abcdef" },
+            { "sha256", std::string(64, 'b') },
+            { "size", 12345 },
+            { "timestamp", 1700000000000 },
+            { "license", "BSD-3-Clause" },
+            { "depends", { "python >=3.8", "libzlib >=1.2" } },
+            { "constrains", { "other <2" } },
+            { "requested_spec", name },
+        };
+    }
+
+    TEST_CASE("PrefixData reads conda-meta records")
+    {
+        TemporaryDirectory tmp;
+        fs::create_directories(tmp.path() / "conda-meta");
+
+        write_record(tmp.path(), make_record("plain"), 100);
+        {
+            auto record = make_record("features");
+            record["track_features"] = "feat1,feat2";
+            record["noarch"] = "python";
+            record.erase("build");
+            record["build_string"] = "from_build_string";
+            write_record(tmp.path(), record, 3);
+        }
+        {
+            auto record = make_record("features_list");
+            record["track_features"] = { "feat1" };
+            record["noarch"] = "generic";
+            write_record(tmp.path(), record, 0);
+        }
+        {
+            // Not an integer, only handled by the nlohmann parser
+            auto record = make_record("float_timestamp");
+            record["timestamp"] = 1.5;
+            write_record(tmp.path(), record, 2);
+        }
+
+        auto channel_context = ChannelContext::make_conda_compatible(mambatests::context());
+        auto prefix_data = PrefixData::create(tmp.path(), channel_context, true).value();
+        REQUIRE(prefix_data.records().size() == 4);
+
+        // Same result as the full parsing of the files
+        auto expected = PrefixData::create(tmp.path() / "empty", channel_context, true).value();
+        for (const auto& entry : fs::directory_iterator(tmp.path() / "conda-meta"))
+        {
+            if (entry.path().extension() == ".json")
+            {
+                expected.load_single_record(entry.path());
+            }
+        }
+        REQUIRE(prefix_data.records() == expected.records());
+
+        const auto& features = prefix_data.records().at("features");
+        REQUIRE(features.track_features == std::vector<std::string>{ "feat1", "feat2" });
+        REQUIRE(features.noarch == specs::NoArchType::Python);
+        REQUIRE(features.build_string == "from_build_string");
+        REQUIRE(features.dependencies.size() == 2);
+        REQUIRE(prefix_data.records().at("features_list").noarch == specs::NoArchType::Generic);
+        REQUIRE(prefix_data.records().at("float_timestamp").timestamp == 1);
+    }
+
+    auto find_record(const PrefixIndex& index, std::string_view name)
+        -> const PrefixIndex::Record*
+    {
+        for (const auto& record : index.records())
+        {
+            if (record.info.name == name)
+            {
+                return &record;
+            }
+        }
+        return nullptr;
+    }
+
+    TEST_CASE("PrefixIndex")
+    {
+        TemporaryDirectory tmp;
+        const auto conda_meta = tmp.path() / "conda-meta";
+        fs::create_directories(conda_meta);
+        write_record(tmp.path(), make_record("a"), 10);
+        write_record(tmp.path(), make_record("b"), 2);
+
+        auto index = PrefixIndex::refresh(conda_meta, true);
+        REQUIRE(fs::exists(PrefixIndex::index_path(conda_meta)));
+        REQUIRE(index.records().size() == 2);
+        REQUIRE(find_record(index, "a")->info.version == "1.2.3");
+
+        SECTION("The index file holds the same records")
+        {
+            auto read = PrefixIndex::read(conda_meta);
+            REQUIRE(read.has_value());
+            REQUIRE(read->records().size() == 2);
+            for (std::size_t i = 0; i < 2; ++i)
+            {
+                REQUIRE(read->records()[i].filename == index.records()[i].filename);
+                REQUIRE(read->records()[i].info == index.records()[i].info);
+            }
+        }
+
+        SECTION("Changed records are read again")
+        {
+            fs::remove(conda_meta / "a-1.2.3-h123_0.json");
+            auto record = make_record("b");
+            record["license"] = "MIT";
+            write_record(tmp.path(), record, 3);
+            write_record(tmp.path(), make_record("c"), 1);
+
+            auto refreshed = PrefixIndex::refresh(conda_meta, true);
+            REQUIRE(refreshed.records().size() == 2);
+            REQUIRE(find_record(refreshed, "a") == nullptr);
+            REQUIRE(find_record(refreshed, "b")->info.license == "MIT");
+            REQUIRE(find_record(refreshed, "c") != nullptr);
+            REQUIRE(PrefixIndex::read(conda_meta)->records().size() == 2);
+        }
+
+        SECTION("Unchanged records do not rewrite the index")
+        {
+            const auto index_mtime = fs::last_write_time(PrefixIndex::index_path(conda_meta));
+            auto refreshed = PrefixIndex::refresh(conda_meta, true);
+            REQUIRE(refreshed.records().size() == 2);
+            REQUIRE(fs::last_write_time(PrefixIndex::index_path(conda_meta)) == index_mtime);
+        }
+
+        SECTION("The index is only written when requested")
+        {
+            fs::remove(PrefixIndex::index_path(conda_meta));
+            REQUIRE(PrefixIndex::refresh(conda_meta, false).records().size() == 2);
+            REQUIRE_FALSE(fs::exists(PrefixIndex::index_path(conda_meta)));
+        }
+
+        SECTION("Invalid index files are ignored")
+        {
+            std::ofstream(PrefixIndex::index_path(conda_meta).std_path()) << "mamba-ix";
+            REQUIRE_FALSE(PrefixIndex::read(conda_meta).has_value());
+            REQUIRE(PrefixIndex::refresh(conda_meta, true).records().size() == 2);
+            REQUIRE(PrefixIndex::read(conda_meta).has_value());
+        }
+    }
+
+    // Writes a ``dist-info`` directory as created by ``installer``.
+    void write_dist_info(
+        const fs::u8path& site_packages,
+        const std::string& name,
+        const std::string& version,
+        const std::string& installer
+    )
+    {
+        const auto dir = site_packages / util::concat(name, "-", version, ".dist-info");
+        fs::create_directories(dir);
+        std::ofstream((dir / "INSTALLER").std_path()) << installer << '\n';
+        std::ofstream((dir / "METADATA").std_path())
+            << "Metadata-Version: 2.1\nName: " << name << "\nVersion: " << version
+            << "\nSummary: A package\n\nName: not a header\n";
+    }
+
+    TEST_CASE("PrefixData reads pip packages")
+    {
+        TemporaryDirectory tmp;
+        const auto prefix = tmp.path();
+        fs::create_directories(prefix / "conda-meta");
+        auto python = make_record("python");
+        python["version"] = "3.12.1";
+        write_record(prefix, python, 0);
+        write_record(prefix, make_record("pip"), 0);
+
+        const auto site_packages = prefix / get_python_site_packages_short_path("3.12");
+        write_dist_info(site_packages, "Foo", "1.0", "pip");
+        write_dist_info(site_packages, "bar", "2.0", "conda");
+
+        // A stale result of ``pip inspect``, only giving the platform
+        std::ofstream((prefix / "conda-meta" / ".mamba-pip-packages").std_path())
+            << R"({"version": 1, "key": [], "platform": "linux-x86_64", "packages": []})";
+
+        // There is no python in the prefix, so loading fails if pip is run.
+        auto channel_context = ChannelContext::make_conda_compatible(mambatests::context());
+        const auto load = [&] { return PrefixData::create(prefix, channel_context); };
+
+        {
+            const auto prefix_data = load();
+            REQUIRE(prefix_data.has_value());
+            REQUIRE(prefix_data->pip_records().size() == 1);
+            const auto& foo = prefix_data->pip_records().at("Foo");
+            REQUIRE(foo.version == "1.0");
+            REQUIRE(foo.platform == "linux-x86_64");
+            REQUIRE(foo.channel == "pypi");
+        }
+
+        SECTION("Unchanged site-packages use the cache")
+        {
+            // Rewriting a file does not change the modification time of its directory
+            std::ofstream((site_packages / "Foo-1.0.dist-info" / "METADATA").std_path())
+                << "Name: Foo\nVersion: 9.9\n";
+            const auto prefix_data = load();
+            REQUIRE(prefix_data.has_value());
+            REQUIRE(prefix_data->pip_records().at("Foo").version == "1.0");
+        }
+
+        SECTION("New packages are read from their metadata")
+        {
+            write_dist_info(site_packages, "baz", "3.0", "pip");
+            const auto prefix_data = load();
+            REQUIRE(prefix_data.has_value());
+            REQUIRE(prefix_data->pip_records().size() == 2);
+            REQUIRE(prefix_data->pip_records().at("baz").version == "3.0");
+        }
+
+        SECTION("Unreadable metadata falls back to pip")
+        {
+            write_dist_info(site_packages, "baz", "3.0", "pip");
+            fs::remove(site_packages / "baz-3.0.dist-info" / "METADATA");
+            REQUIRE_FALSE(load().has_value());
+        }
+    }
+
+    TEST_CASE("PrefixData with many packages", "[.benchmark]")
+    {
+        TemporaryDirectory tmp;
+        fs::create_directories(tmp.path() / "conda-meta");
+        for (std::size_t i = 0; i < 1000; ++i)
+        {
+            write_record(tmp.path(), make_record(util::concat("pkg", std::to_string(i))), 500);
+        }
+
+        auto channel_context = ChannelContext::make_conda_compatible(mambatests::context());
+        static_cast<void>(PrefixIndex::refresh(tmp.path() / "conda-meta", true));
+        BENCHMARK("create")
+        {
+            return PrefixData::create(tmp.path(), channel_context, true).value().records().size();
+        };
+
+        fs::remove(PrefixIndex::index_path(tmp.path() / "conda-meta"));
+        BENCHMARK("create without index")
+        {
+            return PrefixData::create(tmp.path(), channel_context, true).value().records().size();
+        };
+
+        BENCHMARK("load_single_record")
+        {
+            auto prefix_data = PrefixData::create(tmp.path() / "empty", channel_context, true)
+                                   .value();
+            for (const auto& entry : fs::directory_iterator(tmp.path() / "conda-meta"))
+            {
+                if (entry.path().extension() == ".json")
+                {
+                    prefix_data.load_single_record(entry.path());
+                }
+            }
+            return prefix_data.records().size();
+        };
+    }
+}
@@ -7,6 +7,7 @@
 #include <array>
 #include <fstream>
 #include <sstream>
+#include <vector>
 
 #include <catch2/catch_all.hpp>
 
@@ -186,12 +187,28 @@ TEST_CASE("SubdirIndexLoader", "[mamba::core][mamba::core::SubdirIndexLoader]")
             SubdirIndexLoader::create(params, local_channel, "noarch", caches).value(),
         };
 
-        auto result = SubdirIndexLoader::download_required_indexes(subdirs, {}, {}, mirrors, {}, {});
+        auto ready = std::vector<const SubdirIndexLoader*>();
+        auto result = SubdirIndexLoader::download_required_indexes(
+            subdirs,
+            {},
+            {},
+            mirrors,
+            {},
+            {},
+            nullptr,
+            nullptr,
+            [&](const SubdirIndexLoader& subdir)
+            {
+                CHECK(subdir.valid_json_cache_path().has_value());
+                ready.push_back(&subdir);
+            }
+        );
         REQUIRE(result.has_value());
 
         CHECK_FALSE(subdirs[0].valid_cache_found());
         CHECK(subdirs[1].valid_cache_found());
         CHECK(subdirs[1].valid_json_cache_path().has_value());
+        CHECK(ready == std::vector<const SubdirIndexLoader*>{ &subdirs[1] });
     }
 
     SECTION("Download indexes repodata ttl")
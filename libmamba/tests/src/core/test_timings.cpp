@@ -0,0 +1,166 @@
+// Copyright (c) 2025, QuantStack and Mamba Contributors
+//
+// Distributed under the terms of the BSD 3-Clause License.
+//
+// The full license is in the file LICENSE, distributed with this software.
+
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+#include <nlohmann/json.hpp>
+
+#include "mamba/core/timings.hpp"
+#include "mamba/core/util.hpp"
+
+namespace mamba
+{
+    using namespace std::chrono_literals;
+
+    namespace
+    {
+        TEST_CASE("Timings")
+        {
+            auto timings = Timings();
+
+            SECTION("Disabled")
+            {
+                REQUIRE_FALSE(timings.enabled());
+                timings.record("solve", {}, 1s);
+                timings.add("bytes", 3);
+                {
+                    auto timer = timings.time("link", "pkg");
+                }
+                REQUIRE_FALSE(timings.phase("solve").has_value());
+                REQUIRE_FALSE(timings.phase("link").has_value());
+                REQUIRE(timings.counter("bytes") == 0);
+            }
+
+            SECTION("Phases and items")
+            {
+                timings.enable();
+                timings.record("fetch", "a", 1s, 2ms);
+                timings.record("fetch", "b", 2s);
+                timings.record("fetch", "a", 3s);
+                timings.record("solve", {}, 4s);
+
+                const auto fetch = timings.phase("fetch");
+                REQUIRE(fetch.has_value());
+                REQUIRE(fetch->wall_time == 6s);
+                REQUIRE(fetch->cpu_time == 2ms);
+                REQUIRE(fetch->count == 3);
+
+                const auto fetch_a = timings.item("fetch", "a");
+                REQUIRE(fetch_a.has_value());
+                REQUIRE(fetch_a->wall_time == 4s);
+                REQUIRE(fetch_a->count == 2);
+                REQUIRE_FALSE(timings.item("fetch", "c").has_value());
+
+                REQUIRE(timings.phase("solve")->wall_time == 4s);
+                REQUIRE_FALSE(timings.item("solve", "").has_value());
+                REQUIRE_FALSE(timings.phase("link").has_value());
+
+                timings.clear();
+                REQUIRE_FALSE(timings.phase("fetch").has_value());
+            }
+
+            SECTION("Counters")
+            {
+                timings.enable();
+                REQUIRE(timings.counter("bytes") == 0);
+                timings.add("bytes", 3);
+                timings.add("bytes", 4);
+                timings.add("files");
+                REQUIRE(timings.counter("bytes") == 7);
+                REQUIRE(timings.counter("files") == 1);
+            }
+
+            SECTION("Scoped timers")
+            {
+                timings.enable();
+                {
+                    auto timer = timings.time("link", "pkg");
+                    std::this_thread::sleep_for(10ms);
+                }
+                auto timer = timings.time("link", "pkg");
+                auto moved = std::move(timer);
+                moved.stop();
+                moved.stop();
+
+                const auto link = timings.item("link", "pkg");
+                REQUIRE(link.has_value());
+                REQUIRE(link->count == 2);
+                REQUIRE(link->wall_time >= 10ms);
+
+                // A null pointer records nothing
+                Timings::ScopedTimer(nullptr, "link", "pkg").stop();
+                REQUIRE(timings.phase("link")->count == 2);
+            }
+
+            SECTION("Thread CPU time")
+            {
+                // Sleeping does not use the CPU
+                const auto sleep_start = Timings::thread_cpu_time();
+                std::this_thread::sleep_for(50ms);
+                REQUIRE(Timings::thread_cpu_time() - sleep_start < 25ms);
+
+                // Busy waiting does
+                const auto busy_start = Timings::thread_cpu_time();
+                REQUIRE(busy_start > Timings::duration(0));
+                while (Timings::thread_cpu_time() - busy_start < 5ms)
+                {
+                }
+            }
+
+            SECTION("Concurrent recording")
+            {
+                timings.enable();
+                auto threads = std::vector<std::thread>();
+                for (int i = 0; i < 4; ++i)
+                {
+                    threads.emplace_back(
+                        [&timings]
+                        {
+                            for (int j = 0; j < 1000; ++j)
+                            {
+                                timings.record("extract", "pkg", 1us);
+                                timings.add("files");
+                            }
+                        }
+                    );
+                }
+                for (auto& t : threads)
+                {
+                    t.join();
+                }
+                REQUIRE(timings.phase("extract")->count == 4000);
+                REQUIRE(timings.phase("extract")->wall_time == 4ms);
+                REQUIRE(timings.counter("files") == 4000);
+            }
+
+            SECTION("JSON")
+            {
+                timings.enable();
+                timings.record("fetch", "a", 500ms, 250ms);
+                timings.record("solve", {}, 2s);
+                timings.add("fetch.downloaded_bytes", 42);
+
+                const auto json = timings.to_json();
+                REQUIRE(json["phases"]["fetch"]["wall_time"] == 0.5);
+                REQUIRE(json["phases"]["fetch"]["cpu_time"] == 0.25);
+                REQUIRE(json["phases"]["fetch"]["count"] == 1);
+                REQUIRE(json["phases"]["fetch"]["items"]["a"]["wall_time"] == 0.5);
+                REQUIRE(json["phases"]["solve"]["wall_time"] == 2.0);
+                REQUIRE_FALSE(json["phases"]["solve"].contains("items"));
+                REQUIRE(json["counters"]["fetch.downloaded_bytes"] == 42);
+
+                auto file = TemporaryFile("timings", ".json");
+                timings.dump(file.path());
+                auto in = std::ifstream(file.path().std_path());
+                REQUIRE(nlohmann::json::parse(in) == json);
+            }
+        }
+    }
+}
@@ -10,6 +10,7 @@
 #include "mamba/core/util.hpp"
 #include "mamba/download/downloader.hpp"
 #include "mamba/util/string.hpp"
+#include "mamba/util/url_manip.hpp"
 
 namespace mamba
 {
@@ -45,6 +46,35 @@ namespace mamba
             REQUIRE_THROWS_AS(download::download(dl_request, {}, {}, {}), std::runtime_error);
         }
 
+        TEST_CASE("checksums_computed_while_downloading", "[mamba::download]")
+        {
+            const auto tmp_dir = TemporaryDirectory();
+            const auto source = tmp_dir.path() / "source.txt";
+            {
+                auto f = open_ofstream(source);
+                f << "test";
+            }
+
+            download::Request request(
+                "test",
+                download::MirrorName(""),
+                util::path_to_url(source.string()),
+                (tmp_dir.path() / "downloaded.txt").string()
+            );
+            request.compute_sha256 = true;
+            request.compute_md5 = true;
+
+            download::MultiRequest dl_request{ std::vector{ std::move(request) } };
+            download::MultiResult res = download::download(dl_request, {}, {}, {});
+            REQUIRE(res.size() == std::size_t(1));
+            REQUIRE(res[0]);
+            REQUIRE(
+                res[0].value().sha256
+                == "9f86d081884c7d659a2feaa0c55ad015a3bf4f1b2b0b822cd15d6c15b0f00a08"
+            );
+            REQUIRE(res[0].value().md5 == "098f6bcd4621d373cade4e832627b4f6");
+        }
+
         TEST_CASE("Use CA certificate from the root prefix", "[mamba::download]")
         {
             const auto tmp_dir = TemporaryDirectory();
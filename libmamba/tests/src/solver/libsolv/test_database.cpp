@@ -74,6 +74,22 @@ namespace
                     REQUIRE(db.repo_count() == 0);
                     REQUIRE_FALSE(db.installed_repo().has_value());
                     REQUIRE(db.package_count() == 0);
+
+                    SECTION("Match packages reusing removed ids")
+                    {
+                        auto new_pkgs = std::array{ mkpkg("x", "3.0"), mkpkg("x", "4.0") };
+                        db.add_repo_from_packages(new_pkgs, "repo2");
+                        std::size_t count = 0;
+                        db.for_each_package_matching(
+                            specs::MatchSpec::parse("x>=3.0").value(),
+                            [&](const auto& p)
+                            {
+                                count++;
+                                REQUIRE(p.name == "x");
+                            }
+                        );
+                        REQUIRE(count == 2);
+                    }
                 }
             }
 
@@ -120,6 +136,84 @@ namespace
                 }
             }
 
+            SECTION("Serialize multiple repos in a snapshot")
+            {
+                auto tmp_dir = TemporaryDirectory();
+                auto snapshot_file = tmp_dir.path() / "repos.snapshot.solv";
+
+                auto repo2 = db.add_repo_from_packages(std::array{ mkpkg("y", "1.0") }, "repo2");
+                auto entries = std::vector<libsolv::RepodataSnapshotEntry>{
+                    {
+                        /* .origin= */ { "https://repo.mamba.pm/a", "etag1", "mod1" },
+                        /* .channel_id= */ "a",
+                        /* .priorities= */ { 2, 0 },
+                    },
+                    {
+                        /* .origin= */ { "https://repo.mamba.pm/b", "etag2", "mod2" },
+                        /* .channel_id= */ "b",
+                        /* .priorities= */ { 1, 0 },
+                    },
+                };
+                auto written = db.native_serialize_repos({ repo1, repo2 }, snapshot_file, entries);
+                REQUIRE(written.has_value());
+
+                SECTION("Read snapshot")
+                {
+                    auto other_db = libsolv::Database({}, { matchspec_parser });
+                    auto repos = other_db.add_repos_from_native_snapshot(snapshot_file, entries)
+                                     .value();
+                    REQUIRE(repos.size() == 2);
+                    REQUIRE(repos[0].name() == entries[0].origin.url);
+                    REQUIRE(repos[0].package_count() == repo1.package_count());
+                    REQUIRE(repos[0].priority() == entries[0].priorities);
+                    REQUIRE(repos[1].package_count() == repo2.package_count());
+                    REQUIRE(repos[1].priority() == entries[1].priorities);
+                    REQUIRE(other_db.package_count() == db.package_count());
+
+                    // Packages come from the channel and url of their entry
+                    other_db.for_each_package_in_repo(
+                        repos[1],
+                        [&](const auto& pkg)
+                        {
+                            REQUIRE(pkg.channel == entries[1].channel_id);
+                            REQUIRE(util::starts_with(pkg.package_url, entries[1].origin.url));
+                        }
+                    );
+                }
+
+                SECTION("Read snapshot entries")
+                {
+                    REQUIRE(libsolv::Database::native_snapshot_entries(snapshot_file) == entries);
+                    REQUIRE_FALSE(libsolv::Database::native_snapshot_entries(
+                        snapshot_file,
+                        libsolv::PipAsPythonDependency::Yes
+                    ));
+                    REQUIRE_FALSE(
+                        libsolv::Database::native_snapshot_entries(tmp_dir.path() / "missing")
+                    );
+                }
+
+                SECTION("Fail reading outdated snapshot")
+                {
+                    auto other_db = libsolv::Database({}, { matchspec_parser });
+                    auto outdated = entries;
+                    outdated[1].origin.etag = "etag3";
+                    REQUIRE_FALSE(other_db.add_repos_from_native_snapshot(snapshot_file, outdated));
+
+                    auto reordered = std::vector{ entries[1], entries[0] };
+                    REQUIRE_FALSE(
+                        other_db.add_repos_from_native_snapshot(snapshot_file, reordered)
+                    );
+
+                    REQUIRE_FALSE(other_db.add_repos_from_native_snapshot(
+                        snapshot_file,
+                        entries,
+                        libsolv::PipAsPythonDependency::Yes
+                    ));
+                    REQUIRE(other_db.repo_count() == 0);
+                }
+            }
+
             SECTION("Iterate over packages")
             {
                 auto repo2 = db.add_repo_from_packages(std::array{ mkpkg("z", "2.0") }, "repo1");
@@ -153,6 +247,33 @@ namespace
                     REQUIRE(count == 2);
                 }
 
+                SECTION("Matching a MatchSpec with a glob name")
+                {
+                    auto count_matching = [&](std::string_view spec)
+                    {
+                        std::size_t count = 0;
+                        db.for_each_package_matching(
+                            specs::MatchSpec::parse(spec).value(),
+                            [&](const auto&) { count++; }
+                        );
+                        return count;
+                    };
+                    REQUIRE(count_matching("z*") == 2);
+                    REQUIRE(count_matching("*>=2.0") == 2);
+                    REQUIRE(count_matching("y*") == 0);
+
+                    // Glob names are resolved by the Matcher name index, which must include
+                    // the repos added after a previous query.
+                    // Libsolv caches the packages matching a dependency so we use new ones.
+                    if (matchspec_parser == libsolv::MatchSpecParser::Mamba)
+                    {
+                        db.add_repo_from_packages(std::array{ mkpkg("zz", "1.0") }, "repo3");
+                        REQUIRE(count_matching("z*>=1.0") == 3);
+                        REQUIRE(count_matching("*z*>=1.0") == 3);
+                        REQUIRE(count_matching("z*z") == 1);
+                    }
+                }
+
                 SECTION("Matching a strict MatchSpec")
                 {
                     std::size_t count = 0;
@@ -249,6 +370,31 @@ namespace
             REQUIRE(found_python);
         }
 
+        SECTION("Add repo from repodata parsed separately")
+        {
+            const auto repodata = mambatests::test_data_dir
+                                  / "repodata/conda-forge-numpy-linux-64.json";
+            const auto url = "https://conda.anaconda.org/conda-forge/linux-64";
+            auto parsed = libsolv::Database::parse_repodata_json(repodata, url);
+            REQUIRE(parsed.has_value());
+            REQUIRE(parsed->url() == url);
+            REQUIRE(parsed->package_count() == 33);
+
+            auto repo1 = db.add_repo_from_parsed_repodata(parsed.value(), "conda-forge");
+            REQUIRE(repo1.has_value());
+            REQUIRE(repo1->package_count() == 33);
+
+            auto other_db = libsolv::Database({}, { matchspec_parser });
+            auto repo2 = other_db.add_repo_from_repodata_json(repodata, url, "conda-forge");
+            REQUIRE(repo2.has_value());
+
+            auto pkgs1 = std::vector<specs::PackageInfo>();
+            db.for_each_package_in_repo(repo1.value(), [&](auto&& p) { pkgs1.push_back(p); });
+            auto pkgs2 = std::vector<specs::PackageInfo>();
+            other_db.for_each_package_in_repo(repo2.value(), [&](auto&& p) { pkgs2.push_back(p); });
+            REQUIRE(pkgs1 == pkgs2);
+        }
+
         SECTION("Add repo from repodata only .tar.bz2")
         {
             const auto repodata = mambatests::test_data_dir
@@ -531,4 +677,66 @@ namespace
             );
         }
     }
+
+    TEST_CASE("Load repodata", "[.benchmark]")
+    {
+        auto tmp_dir = TemporaryDirectory();
+        const auto repodata = tmp_dir.path() / "repodata.json";
+        // 100'000 packages spread over 500 names
+        mambatests::write_large_repodata(
+            repodata,
+            500,
+            200,
+            R"("python >=3.8", "libgcc-ng >=12", "{next} >=1.0")",
+            R"("{next} <2")"
+        );
+        const auto url = std::string("https://conda.anaconda.org/conda-forge/linux-64");
+
+        BENCHMARK("add_repo_from_repodata_json")
+        {
+            auto db = libsolv::Database({}, { libsolv::MatchSpecParser::Mamba });
+            return db.add_repo_from_repodata_json(repodata, url, "conda-forge").has_value();
+        };
+
+        BENCHMARK("parse_repodata_json")
+        {
+            return libsolv::Database::parse_repodata_json(repodata, url).has_value();
+        };
+
+        const auto parsed = libsolv::Database::parse_repodata_json(repodata, url).value();
+        BENCHMARK("add_repo_from_parsed_repodata")
+        {
+            auto db = libsolv::Database({}, { libsolv::MatchSpecParser::Mamba });
+            return db.add_repo_from_parsed_repodata(parsed, "conda-forge").has_value();
+        };
+
+        auto db = libsolv::Database({}, { libsolv::MatchSpecParser::Mamba });
+        auto repo = db.add_repo_from_repodata_json(repodata, url, "conda-forge").value();
+
+        const auto ms = specs::MatchSpec::parse("pkg1>=1.100,<1.150").value();
+        BENCHMARK("for_each_package_matching")
+        {
+            std::size_t count = 0;
+            db.for_each_package_matching(ms, [&](const auto&) { count++; });
+            return count;
+        };
+
+        const auto glob_ms = specs::MatchSpec::parse("pkg1*>=1.100,<1.150").value();
+        BENCHMARK("for_each_package_matching glob")
+        {
+            std::size_t count = 0;
+            db.for_each_package_matching(glob_ms, [&](const auto&) { count++; });
+            return count;
+        };
+
+        BENCHMARK("for_each_package_in_repo")
+        {
+            std::size_t url_size = 0;
+            db.for_each_package_in_repo(
+                repo,
+                [&](const auto& p) { url_size += p.package_url.size(); }
+            );
+            return url_size;
+        };
+    }
 }
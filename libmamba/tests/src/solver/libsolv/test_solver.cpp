@@ -5,12 +5,14 @@
 // The full license is in the file LICENSE, distributed with this software.
 
 #include <array>
+#include <string>
 #include <type_traits>
 #include <variant>
 #include <vector>
 
 #include <catch2/catch_all.hpp>
 
+#include "mamba/core/util.hpp"
 #include "mamba/fs/filesystem.hpp"
 #include "mamba/solver/libsolv/database.hpp"
 #include "mamba/solver/libsolv/solver.hpp"
@@ -1329,4 +1331,80 @@ namespace
             ));
         }
     }
+
+    TEST_CASE("Solve glob names with a Libsolv database", "[mamba::solver][mamba::solver::libsolv]")
+    {
+        using PackageInfo = specs::PackageInfo;
+
+        // As the commands loading the database with the Libsolv parser and solving with Mixed
+        auto db = libsolv::Database({}, { libsolv::MatchSpecParser::Libsolv });
+
+        auto pkg1 = PackageInfo("foo-a");
+        pkg1.md5 = "0bab699354cbd66959550eb9b9866620";
+        auto pkg2 = PackageInfo("foo-b");
+        pkg2.md5 = "bad";
+        auto pkg3 = PackageInfo("bar");
+        pkg3.md5 = "0bab699354cbd66959550eb9b9866620";
+        db.add_repo_from_packages(
+            std::array{ pkg1, pkg2, pkg3 },
+            "repo",
+            libsolv::PipAsPythonDependency::No
+        );
+
+        // Not a simple spec, so it goes through the namespace callback
+        auto request = Request{
+            /* .flags= */ {},
+            /* .jobs= */ { Request::Install{ "foo*[md5=0bab699354cbd66959550eb9b9866620]"_ms } },
+        };
+        const auto outcome = libsolv::Solver().solve(db, request, libsolv::MatchSpecParser::Mixed);
+
+        REQUIRE(outcome.has_value());
+        REQUIRE(std::holds_alternative<Solution>(outcome.value()));
+        const auto& solution = std::get<Solution>(outcome.value());
+        REQUIRE(solution.actions.size() == 1);
+        REQUIRE(std::holds_alternative<Solution::Install>(solution.actions.front()));
+        REQUIRE(std::get<Solution::Install>(solution.actions.front()).install.name == "foo-a");
+    }
+
+    TEST_CASE("Solve a large environment", "[.benchmark]")
+    {
+        static constexpr std::size_t n_names = 500;
+        auto tmp_dir = TemporaryDirectory();
+        const auto repodata = tmp_dir.path() / "repodata.json";
+        // Each package depends on a range of versions of the next package
+        mambatests::write_large_repodata(
+            repodata,
+            n_names,
+            100,
+            R"("{next} >=1.0,<2.0a0 h0*")",
+            R"("{next} !=1.0")"
+        );
+
+        auto db = libsolv::Database({}, { libsolv::MatchSpecParser::Mamba });
+        const auto repo = db.add_repo_from_repodata_json(
+            repodata,
+            "https://conda.anaconda.org/conda-forge/linux-64",
+            "conda-forge"
+        );
+        REQUIRE(repo.has_value());
+
+        auto jobs = Request::job_list();
+        for (std::size_t i = 0; i < n_names; i += 5)
+        {
+            const auto spec = util::concat("pkg", std::to_string(i), ">=1.10,<1.90 h0_*");
+            jobs.push_back(Request::Install{ specs::MatchSpec::parse(spec).value() });
+        }
+        const auto request = Request{ /* .flags= */ {}, /* .jobs= */ std::move(jobs) };
+
+        const auto outcome = libsolv::Solver().solve(db, request, libsolv::MatchSpecParser::Mamba);
+        REQUIRE(outcome.has_value());
+        REQUIRE(std::holds_alternative<Solution>(outcome.value()));
+
+        BENCHMARK("solve")
+        {
+            return libsolv::Solver()
+                .solve(db, request, libsolv::MatchSpecParser::Mamba)
+                .has_value();
+        };
+    }
 }
@@ -6,6 +6,8 @@
 
 #include <algorithm>
 #include <array>
+#include <random>
+#include <string>
 #include <vector>
 
 #include <catch2/catch_all.hpp>
@@ -659,4 +661,191 @@ namespace
         // None compare equal (given the is_sorted assumption)
         REQUIRE(std::adjacent_find(versions.cbegin(), versions.cend()) == versions.cend());
     }
+
+    /**
+     * The three-way comparison of the parts of two versions, without the ``Version::key``.
+     *
+     * Missing trailing parts compare as empty parts.
+     */
+    auto compare_parts(const CommonVersion& a, const CommonVersion& b) -> int
+    {
+        const auto empty = VersionPart();
+        const auto size = std::max(a.size(), b.size());
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            const auto& x = (i < a.size()) ? a[i] : empty;
+            const auto& y = (i < b.size()) ? b[i] : empty;
+            if (x < y)
+            {
+                return -1;
+            }
+            if (y < x)
+            {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    auto compare_parts(const Version& a, const Version& b) -> int
+    {
+        if (a.epoch() != b.epoch())
+        {
+            return (a.epoch() < b.epoch()) ? -1 : 1;
+        }
+        if (const auto c = compare_parts(a.version(), b.version()); c != 0)
+        {
+            return c;
+        }
+        return compare_parts(a.local(), b.local());
+    }
+
+    /** Random version strings made of the interesting atoms. */
+    auto make_version_strings(std::size_t count, std::uint32_t seed) -> std::vector<std::string>
+    {
+        static constexpr auto literals = std::array<std::string_view, 10>{
+            "", "", "", "*", "dev", "_", "a", "rc", "post", "abc",
+        };
+        static constexpr auto numerals = std::array<std::string_view, 6>{
+            "", "0", "0", "1", "2", "300",
+        };
+
+        auto rng = std::mt19937(seed);
+        auto pick = [&](const auto& choices) { return choices[rng() % choices.size()]; };
+        auto make_common = [&](std::size_t max_parts)
+        {
+            auto out = std::string();
+            const auto n_parts = 1 + rng() % max_parts;
+            for (std::size_t p = 0; p < n_parts; ++p)
+            {
+                if (p > 0)
+                {
+                    out += '.';
+                }
+                const auto n_atoms = 1 + rng() % 2;
+                for (std::size_t a = 0; a < n_atoms; ++a)
+                {
+                    auto num = pick(numerals);
+                    auto lit = pick(literals);
+                    // An atom needs a numeral if it follows another, and something in any case
+                    if ((a > 0 || lit.empty() || lit == "_") && num.empty())
+                    {
+                        num = "0";
+                    }
+                    out += num;
+                    out += lit;
+                }
+            }
+            return out;
+        };
+
+        auto out = std::vector<std::string>();
+        out.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto str = std::string();
+            if (rng() % 8 == 0)
+            {
+                str += "1!";
+            }
+            str += make_common(5);
+            if (rng() % 8 == 0)
+            {
+                str += '+';
+                str += make_common(2);
+            }
+            out.push_back(std::move(str));
+        }
+        return out;
+    }
+
+    auto parse_versions(const std::vector<std::string>& strings) -> std::vector<Version>
+    {
+        auto out = std::vector<Version>();
+        out.reserve(strings.size());
+        for (const auto& str : strings)
+        {
+            if (auto v = Version::parse(str))
+            {
+                out.push_back(std::move(v).value());
+            }
+        }
+        return out;
+    }
+
+    TEST_CASE("Version::key", "[mamba::specs][mamba::specs::Version]")
+    {
+        SECTION("Orders as the parts")
+        {
+            const auto versions = parse_versions(make_version_strings(400, 42));
+            REQUIRE(versions.size() > 300);
+            for (const auto& a : versions)
+            {
+                for (const auto& b : versions)
+                {
+                    const auto expected = compare_parts(a, b);
+                    CAPTURE(a.to_string(), b.to_string());
+                    REQUIRE((a < b) == (expected < 0));
+                    REQUIRE((a == b) == (expected == 0));
+                }
+            }
+        }
+
+        SECTION("Large numbers")
+        {
+            REQUIRE(Version(0, { { { 254 } } }) < Version(0, { { { 255 } } }));
+            REQUIRE(Version(0, { { { 255 } } }) < Version(0, { { { 256 } } }));
+            REQUIRE(Version(0, { { { 256 } } }) < Version(0, { { { 20240101 } } }));
+            REQUIRE(Version(300, {}) > Version(2, { { { 20240101 } } }));
+        }
+
+        SECTION("Many empty parts")
+        {
+            auto make = [](std::size_t n_empty, VersionPartAtom last)
+            {
+                auto parts = CommonVersion(n_empty + 1, VersionPart{ { 0 } });
+                parts.back() = VersionPart{ std::move(last) };
+                return Version(0, std::move(parts));
+            };
+            for (std::size_t n : { 0, 1, 124, 125, 126, 300 })
+            {
+                CAPTURE(n);
+                REQUIRE(make(n, { 0, "dev" }) < make(n + 1, { 0, "dev" }));
+                REQUIRE(make(n + 1, { 1 }) < make(n, { 1 }));
+                REQUIRE(make(n, { 0, "dev" }) < Version());
+                REQUIRE(make(n, { 1 }) > Version());
+                REQUIRE(make(n, { 0 }) == Version());
+            }
+        }
+    }
+
+    TEST_CASE("Version sort", "[.benchmark]")
+    {
+        const auto strings = make_version_strings(100'000, 7);
+
+        BENCHMARK("parse")
+        {
+            return parse_versions(strings);
+        };
+
+        const auto versions = parse_versions(strings);
+
+        BENCHMARK("sort with key")
+        {
+            auto sorted = versions;
+            std::sort(sorted.begin(), sorted.end());
+            return sorted;
+        };
+
+        BENCHMARK("sort with parts")
+        {
+            auto sorted = versions;
+            std::sort(
+                sorted.begin(),
+                sorted.end(),
+                [](const auto& a, const auto& b) { return compare_parts(a, b) < 0; }
+            );
+            return sorted;
+        };
+    }
 }
@@ -4,12 +4,16 @@
 //
 // The full license is in the file LICENSE, distributed with this software.
 
+#include <algorithm>
 #include <array>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include <catch2/catch_all.hpp>
 
 #include "mamba/specs/version_spec.hpp"
+#include "mamba/util/string.hpp"
 
 using namespace mamba::specs;
 
@@ -18,6 +22,20 @@ namespace
     using namespace mamba::specs::version_literals;
     using namespace mamba::specs::version_spec_literals;
 
+    /**
+     * Whether the VersionSpec contains the version.
+     *
+     * Also checks that the compiled program of the VersionSpec agrees with the evaluation of its
+     * expression tree.
+     */
+    auto contains(const VersionSpec& spec, const Version& point) -> bool
+    {
+        const auto expected = spec.expression().evaluate([&](const auto& pred)
+                                                         { return pred.contains(point); });
+        REQUIRE(spec.contains(point) == expected);
+        return expected;
+    }
+
     TEST_CASE("VersionPredicate", "[mamba::specs][mamba::specs::VersionSpec]")
     {
         const auto v1 = "1.0"_v;
@@ -203,7 +221,7 @@ namespace
         SECTION("empty")
         {
             auto spec = VersionSpec();
-            REQUIRE(spec.contains(Version()));
+            REQUIRE(contains(spec, Version()));
             REQUIRE(spec.to_string() == "=*");
         }
 
@@ -212,8 +230,8 @@ namespace
             const auto v1 = "1.0"_v;
             const auto v2 = "2.0"_v;
             auto spec = VersionSpec::from_predicate(VersionPredicate::make_equal_to(v1));
-            REQUIRE(spec.contains(v1));
-            REQUIRE_FALSE(spec.contains(v2));
+            REQUIRE(contains(spec, v1));
+            REQUIRE_FALSE(contains(spec, v2));
             REQUIRE(spec.to_string() == "==1.0");
         }
 
@@ -237,13 +255,14 @@ namespace
 
             auto spec = VersionSpec(std::move(parser).tree());
 
-            REQUIRE(spec.contains(Version(0, { { { 2 } }, { { 3 } }, { { 1 } } })));  // 2.3.1
-            REQUIRE(spec.contains(Version(0, { { { 2 } }, { { 8 } } })));             // 2.8
-            REQUIRE(spec.contains(Version(0, { { { 1 } }, { { 8 } } })));             // 1.8
+            REQUIRE(contains(spec, Version(0, { { { 2 } }, { { 3 } }, { { 1 } } })));  // 2.3.1
+            REQUIRE(contains(spec, Version(0, { { { 2 } }, { { 8 } } })));             // 2.8
+            REQUIRE(contains(spec, Version(0, { { { 1 } }, { { 8 } } })));             // 1.8
 
-            REQUIRE_FALSE(spec.contains(Version(0, { { { 2 } }, { { 0 } }, { { 0 } } })));  // 2.0.0
-            REQUIRE_FALSE(spec.contains(Version(0, { { { 2 } }, { { 1 } } })));             // 2.1
-            REQUIRE_FALSE(spec.contains(Version(0, { { { 2 } }, { { 3 } } })));             // 2.3
+            // 2.0.0
+            REQUIRE_FALSE(contains(spec, Version(0, { { { 2 } }, { { 0 } }, { { 0 } } })));
+            REQUIRE_FALSE(contains(spec, Version(0, { { { 2 } }, { { 1 } } })));  // 2.1
+            REQUIRE_FALSE(contains(spec, Version(0, { { { 2 } }, { { 3 } } })));  // 2.3
 
             // Note this won't always be the same as the parsed string because of the tree
             // serialization
@@ -255,226 +274,226 @@ namespace
     {
         SECTION("Successful")
         {
-            REQUIRE(""_vs.contains("1.6"_v));
-            REQUIRE(""_vs.contains("0.6+0.7"_v));
-
-            REQUIRE("*"_vs.contains("1.4"_v));
-            REQUIRE("=*"_vs.contains("1.4"_v));
-
-            REQUIRE("1.7"_vs.contains("1.7"_v));
-            REQUIRE("1.7"_vs.contains("1.7.0.0"_v));
-            REQUIRE_FALSE("1.7"_vs.contains("1.6"_v));
-            REQUIRE_FALSE("1.7"_vs.contains("1.7.7"_v));
-            REQUIRE_FALSE("1.7"_vs.contains("1.7.0.1"_v));
-
-            REQUIRE("==1.7"_vs.contains("1.7"_v));
-            REQUIRE("==1.7"_vs.contains("1.7.0.0"_v));
-            REQUIRE_FALSE("==1.7"_vs.contains("1.6"_v));
-            REQUIRE_FALSE("==1.7"_vs.contains("1.7.7"_v));
-            REQUIRE_FALSE("==1.7"_vs.contains("1.7.0.1"_v));
-
-            REQUIRE_FALSE("!=1.7"_vs.contains("1.7"_v));
-            REQUIRE_FALSE("!=1.7"_vs.contains("1.7.0.0"_v));
-            REQUIRE("!=1.7"_vs.contains("1.6"_v));
-            REQUIRE("!=1.7"_vs.contains("1.7.7"_v));
-            REQUIRE("!=1.7"_vs.contains("1.7.0.1"_v));
-
-            REQUIRE_FALSE("<1.7"_vs.contains("1.7"_v));
-            REQUIRE_FALSE("<1.7"_vs.contains("1.7.0.0"_v));
-            REQUIRE("<1.7"_vs.contains("1.6"_v));
-            REQUIRE("<1.7"_vs.contains("1.7a"_v));
-            REQUIRE_FALSE("<1.7"_vs.contains("1.7.7"_v));
-            REQUIRE_FALSE("<1.7"_vs.contains("1.7.0.1"_v));
-
-            REQUIRE("<=1.7"_vs.contains("1.7"_v));
-            REQUIRE("<=1.7"_vs.contains("1.7.0.0"_v));
-            REQUIRE("<=1.7"_vs.contains("1.6"_v));
-            REQUIRE("<=1.7"_vs.contains("1.7a"_v));
-            REQUIRE_FALSE("<=1.7"_vs.contains("1.7.7"_v));
-            REQUIRE_FALSE("<=1.7"_vs.contains("1.7.0.1"_v));
-
-            REQUIRE_FALSE(">1.7"_vs.contains("1.7"_v));
-            REQUIRE_FALSE(">1.7"_vs.contains("1.7.0.0"_v));
-            REQUIRE_FALSE(">1.7"_vs.contains("1.6"_v));
-            REQUIRE_FALSE(">1.7"_vs.contains("1.7a"_v));
-            REQUIRE(">1.7"_vs.contains("1.7.7"_v));
-            REQUIRE(">1.7"_vs.contains("1.7.0.1"_v));
-
-            REQUIRE(">= 1.7"_vs.contains("1.7"_v));
-            REQUIRE(">= 1.7"_vs.contains("1.7.0.0"_v));
-            REQUIRE_FALSE(">= 1.7"_vs.contains("1.6"_v));
-            REQUIRE_FALSE(">= 1.7"_vs.contains("1.7a"_v));
-            REQUIRE(">= 1.7"_vs.contains("1.7.7"_v));
-            REQUIRE(">= 1.7"_vs.contains("1.7.0.1"_v));
-
-            REQUIRE_FALSE(" = 1.8"_vs.contains("1.7.0.1"_v));
-            REQUIRE(" = 1.8"_vs.contains("1.8"_v));
-            REQUIRE(" = 1.8"_vs.contains("1.8.0"_v));
-            REQUIRE(" = 1.8"_vs.contains("1.8.1"_v));
-            REQUIRE(" = 1.8"_vs.contains("1.8alpha"_v));
-            REQUIRE_FALSE(" = 1.8"_vs.contains("1.9"_v));
-
-            REQUIRE_FALSE(" = 1.8.* "_vs.contains("1.7.0.1"_v));
-            REQUIRE(" = 1.8.*"_vs.contains("1.8"_v));
-            REQUIRE(" = 1.8.*"_vs.contains("1.8.0"_v));
-            REQUIRE(" = 1.8.*"_vs.contains("1.8.1"_v));
-            REQUIRE(" = 1.8.*"_vs.contains("1.8alpha"_v));  // Like Conda
-            REQUIRE_FALSE(" = 1.8.*"_vs.contains("1.9"_v));
-
-            REQUIRE_FALSE("  1.8.* "_vs.contains("1.7.0.1"_v));
-            REQUIRE("  1.8.*"_vs.contains("1.8"_v));
-            REQUIRE("  1.8.*"_vs.contains("1.8.0"_v));
-            REQUIRE("  1.8.*"_vs.contains("1.8.1"_v));
-            REQUIRE("  1.8.*"_vs.contains("1.8alpha"_v));  // Like Conda
-            REQUIRE_FALSE("  1.8.*"_vs.contains("1.9"_v));
-
-            REQUIRE(" != 1.8.*"_vs.contains("1.7.0.1"_v));
-            REQUIRE_FALSE(" != 1.8.*"_vs.contains("1.8"_v));
-            REQUIRE_FALSE(" != 1.8.*"_vs.contains("1.8.0"_v));
-            REQUIRE_FALSE(" != 1.8.*"_vs.contains("1.8.1"_v));
-            REQUIRE_FALSE(" != 1.8.*"_vs.contains("1.8alpha"_v));  // Like Conda
-            REQUIRE(" != 1.8.*"_vs.contains("1.9"_v));
-
-            REQUIRE(" 1.*.3"_vs.contains("1.7.3"_v));
-            REQUIRE(" 1.*.3"_vs.contains("1.7.0.3"_v));
-            REQUIRE_FALSE(" 1.*.3"_vs.contains("1.7.3.4"_v));
-            REQUIRE_FALSE(" 1.*.3"_vs.contains("1.3"_v));
-            REQUIRE_FALSE(" 1.*.3"_vs.contains("2.0.3"_v));
-
-            REQUIRE(" =1.*.3"_vs.contains("1.7.3"_v));
-            REQUIRE(" =1.*.3"_vs.contains("1.7.0.3"_v));
-            REQUIRE_FALSE(" =1.*.3"_vs.contains("1.7.3.4"_v));
-            REQUIRE_FALSE(" =1.*.3"_vs.contains("1.3"_v));
-            REQUIRE_FALSE(" =1.*.3"_vs.contains("2.0.3"_v));
-
-            REQUIRE_FALSE("!=1.*.3 "_vs.contains("1.7.3"_v));
-            REQUIRE_FALSE("!=1.*.3 "_vs.contains("1.7.0.3"_v));
-            REQUIRE("!=1.*.3 "_vs.contains("1.7.3.4"_v));
-            REQUIRE("!=1.*.3 "_vs.contains("1.3"_v));
-            REQUIRE("!=1.*.3 "_vs.contains("2.0.3"_v));
-
-            REQUIRE_FALSE(" ~= 1.8 "_vs.contains("1.7.0.1"_v));
-            REQUIRE(" ~= 1.8 "_vs.contains("1.8"_v));
-            REQUIRE(" ~= 1.8 "_vs.contains("1.8.0"_v));
-            REQUIRE(" ~= 1.8 "_vs.contains("1.8.1"_v));
-            REQUIRE(" ~= 1.8 "_vs.contains("1.9"_v));
-            REQUIRE(" ~= 1.8 "_vs.contains("1.8post"_v));
-            REQUIRE_FALSE(" ~= 1.8 "_vs.contains("1.8alpha"_v));
-
-            REQUIRE(" ~=1 "_vs.contains("1.7.0.1"_v));
-            REQUIRE(" ~=1 "_vs.contains("1.8"_v));
-            REQUIRE(" ~=1 "_vs.contains("1.8post"_v));
-            REQUIRE(" ~=1 "_vs.contains("2.0"_v));
-            REQUIRE_FALSE(" ~=1 "_vs.contains("0.1"_v));
-            REQUIRE_FALSE(" ~=1 "_vs.contains("1.0.alpha"_v));
-
-            REQUIRE_FALSE(" (>= 1.7, <1.8) |>=1.9.0.0 "_vs.contains("1.6"_v));
-            REQUIRE(" (>= 1.7, <1.8) |>=1.9.0.0 "_vs.contains("1.7.0.0"_v));
-            REQUIRE_FALSE(" (>= 1.7, <1.8) |>=1.9.0.0 "_vs.contains("1.8.1"_v));
-            REQUIRE(" (>= 1.7, <1.8) |>=1.9.0.0 "_vs.contains("6.33"_v));
+            REQUIRE(contains(""_vs, "1.6"_v));
+            REQUIRE(contains(""_vs, "0.6+0.7"_v));
+
+            REQUIRE(contains("*"_vs, "1.4"_v));
+            REQUIRE(contains("=*"_vs, "1.4"_v));
+
+            REQUIRE(contains("1.7"_vs, "1.7"_v));
+            REQUIRE(contains("1.7"_vs, "1.7.0.0"_v));
+            REQUIRE_FALSE(contains("1.7"_vs, "1.6"_v));
+            REQUIRE_FALSE(contains("1.7"_vs, "1.7.7"_v));
+            REQUIRE_FALSE(contains("1.7"_vs, "1.7.0.1"_v));
+
+            REQUIRE(contains("==1.7"_vs, "1.7"_v));
+            REQUIRE(contains("==1.7"_vs, "1.7.0.0"_v));
+            REQUIRE_FALSE(contains("==1.7"_vs, "1.6"_v));
+            REQUIRE_FALSE(contains("==1.7"_vs, "1.7.7"_v));
+            REQUIRE_FALSE(contains("==1.7"_vs, "1.7.0.1"_v));
+
+            REQUIRE_FALSE(contains("!=1.7"_vs, "1.7"_v));
+            REQUIRE_FALSE(contains("!=1.7"_vs, "1.7.0.0"_v));
+            REQUIRE(contains("!=1.7"_vs, "1.6"_v));
+            REQUIRE(contains("!=1.7"_vs, "1.7.7"_v));
+            REQUIRE(contains("!=1.7"_vs, "1.7.0.1"_v));
+
+            REQUIRE_FALSE(contains("<1.7"_vs, "1.7"_v));
+            REQUIRE_FALSE(contains("<1.7"_vs, "1.7.0.0"_v));
+            REQUIRE(contains("<1.7"_vs, "1.6"_v));
+            REQUIRE(contains("<1.7"_vs, "1.7a"_v));
+            REQUIRE_FALSE(contains("<1.7"_vs, "1.7.7"_v));
+            REQUIRE_FALSE(contains("<1.7"_vs, "1.7.0.1"_v));
+
+            REQUIRE(contains("<=1.7"_vs, "1.7"_v));
+            REQUIRE(contains("<=1.7"_vs, "1.7.0.0"_v));
+            REQUIRE(contains("<=1.7"_vs, "1.6"_v));
+            REQUIRE(contains("<=1.7"_vs, "1.7a"_v));
+            REQUIRE_FALSE(contains("<=1.7"_vs, "1.7.7"_v));
+            REQUIRE_FALSE(contains("<=1.7"_vs, "1.7.0.1"_v));
+
+            REQUIRE_FALSE(contains(">1.7"_vs, "1.7"_v));
+            REQUIRE_FALSE(contains(">1.7"_vs, "1.7.0.0"_v));
+            REQUIRE_FALSE(contains(">1.7"_vs, "1.6"_v));
+            REQUIRE_FALSE(contains(">1.7"_vs, "1.7a"_v));
+            REQUIRE(contains(">1.7"_vs, "1.7.7"_v));
+            REQUIRE(contains(">1.7"_vs, "1.7.0.1"_v));
+
+            REQUIRE(contains(">= 1.7"_vs, "1.7"_v));
+            REQUIRE(contains(">= 1.7"_vs, "1.7.0.0"_v));
+            REQUIRE_FALSE(contains(">= 1.7"_vs, "1.6"_v));
+            REQUIRE_FALSE(contains(">= 1.7"_vs, "1.7a"_v));
+            REQUIRE(contains(">= 1.7"_vs, "1.7.7"_v));
+            REQUIRE(contains(">= 1.7"_vs, "1.7.0.1"_v));
+
+            REQUIRE_FALSE(contains(" = 1.8"_vs, "1.7.0.1"_v));
+            REQUIRE(contains(" = 1.8"_vs, "1.8"_v));
+            REQUIRE(contains(" = 1.8"_vs, "1.8.0"_v));
+            REQUIRE(contains(" = 1.8"_vs, "1.8.1"_v));
+            REQUIRE(contains(" = 1.8"_vs, "1.8alpha"_v));
+            REQUIRE_FALSE(contains(" = 1.8"_vs, "1.9"_v));
+
+            REQUIRE_FALSE(contains(" = 1.8.* "_vs, "1.7.0.1"_v));
+            REQUIRE(contains(" = 1.8.*"_vs, "1.8"_v));
+            REQUIRE(contains(" = 1.8.*"_vs, "1.8.0"_v));
+            REQUIRE(contains(" = 1.8.*"_vs, "1.8.1"_v));
+            REQUIRE(contains(" = 1.8.*"_vs, "1.8alpha"_v));  // Like Conda
+            REQUIRE_FALSE(contains(" = 1.8.*"_vs, "1.9"_v));
+
+            REQUIRE_FALSE(contains("  1.8.* "_vs, "1.7.0.1"_v));
+            REQUIRE(contains("  1.8.*"_vs, "1.8"_v));
+            REQUIRE(contains("  1.8.*"_vs, "1.8.0"_v));
+            REQUIRE(contains("  1.8.*"_vs, "1.8.1"_v));
+            REQUIRE(contains("  1.8.*"_vs, "1.8alpha"_v));  // Like Conda
+            REQUIRE_FALSE(contains("  1.8.*"_vs, "1.9"_v));
+
+            REQUIRE(contains(" != 1.8.*"_vs, "1.7.0.1"_v));
+            REQUIRE_FALSE(contains(" != 1.8.*"_vs, "1.8"_v));
+            REQUIRE_FALSE(contains(" != 1.8.*"_vs, "1.8.0"_v));
+            REQUIRE_FALSE(contains(" != 1.8.*"_vs, "1.8.1"_v));
+            REQUIRE_FALSE(contains(" != 1.8.*"_vs, "1.8alpha"_v));  // Like Conda
+            REQUIRE(contains(" != 1.8.*"_vs, "1.9"_v));
+
+            REQUIRE(contains(" 1.*.3"_vs, "1.7.3"_v));
+            REQUIRE(contains(" 1.*.3"_vs, "1.7.0.3"_v));
+            REQUIRE_FALSE(contains(" 1.*.3"_vs, "1.7.3.4"_v));
+            REQUIRE_FALSE(contains(" 1.*.3"_vs, "1.3"_v));
+            REQUIRE_FALSE(contains(" 1.*.3"_vs, "2.0.3"_v));
+
+            REQUIRE(contains(" =1.*.3"_vs, "1.7.3"_v));
+            REQUIRE(contains(" =1.*.3"_vs, "1.7.0.3"_v));
+            REQUIRE_FALSE(contains(" =1.*.3"_vs, "1.7.3.4"_v));
+            REQUIRE_FALSE(contains(" =1.*.3"_vs, "1.3"_v));
+            REQUIRE_FALSE(contains(" =1.*.3"_vs, "2.0.3"_v));
+
+            REQUIRE_FALSE(contains("!=1.*.3 "_vs, "1.7.3"_v));
+            REQUIRE_FALSE(contains("!=1.*.3 "_vs, "1.7.0.3"_v));
+            REQUIRE(contains("!=1.*.3 "_vs, "1.7.3.4"_v));
+            REQUIRE(contains("!=1.*.3 "_vs, "1.3"_v));
+            REQUIRE(contains("!=1.*.3 "_vs, "2.0.3"_v));
+
+            REQUIRE_FALSE(contains(" ~= 1.8 "_vs, "1.7.0.1"_v));
+            REQUIRE(contains(" ~= 1.8 "_vs, "1.8"_v));
+            REQUIRE(contains(" ~= 1.8 "_vs, "1.8.0"_v));
+            REQUIRE(contains(" ~= 1.8 "_vs, "1.8.1"_v));
+            REQUIRE(contains(" ~= 1.8 "_vs, "1.9"_v));
+            REQUIRE(contains(" ~= 1.8 "_vs, "1.8post"_v));
+            REQUIRE_FALSE(contains(" ~= 1.8 "_vs, "1.8alpha"_v));
+
+            REQUIRE(contains(" ~=1 "_vs, "1.7.0.1"_v));
+            REQUIRE(contains(" ~=1 "_vs, "1.8"_v));
+            REQUIRE(contains(" ~=1 "_vs, "1.8post"_v));
+            REQUIRE(contains(" ~=1 "_vs, "2.0"_v));
+            REQUIRE_FALSE(contains(" ~=1 "_vs, "0.1"_v));
+            REQUIRE_FALSE(contains(" ~=1 "_vs, "1.0.alpha"_v));
+
+            REQUIRE_FALSE(contains(" (>= 1.7, <1.8) |>=1.9.0.0 "_vs, "1.6"_v));
+            REQUIRE(contains(" (>= 1.7, <1.8) |>=1.9.0.0 "_vs, "1.7.0.0"_v));
+            REQUIRE_FALSE(contains(" (>= 1.7, <1.8) |>=1.9.0.0 "_vs, "1.8.1"_v));
+            REQUIRE(contains(" (>= 1.7, <1.8) |>=1.9.0.0 "_vs, "6.33"_v));
 
             // Test from Conda
-            REQUIRE("==1.7"_vs.contains("1.7.0"_v));
-            REQUIRE("<=1.7"_vs.contains("1.7.0"_v));
-            REQUIRE_FALSE("<1.7"_vs.contains("1.7.0"_v));
-            REQUIRE(">=1.7"_vs.contains("1.7.0"_v));
-            REQUIRE_FALSE(">1.7"_vs.contains("1.7.0"_v));
-            REQUIRE_FALSE(">=1.7"_vs.contains("1.6.7"_v));
-            REQUIRE_FALSE(">2013b"_vs.contains("2013a"_v));
-            REQUIRE(">2013b"_vs.contains("2013k"_v));
-            REQUIRE_FALSE(">2013b"_vs.contains("3.0.0"_v));
-            REQUIRE(">1.0.0a"_vs.contains("1.0.0"_v));
-            REQUIRE(">1.0.0*"_vs.contains("1.0.0"_v));
-            REQUIRE("1.0*"_vs.contains("1.0"_v));
-            REQUIRE("1.0*"_vs.contains("1.0.0"_v));
-            REQUIRE("1.0.0*"_vs.contains("1.0"_v));
-            REQUIRE_FALSE("1.0.0*"_vs.contains("1.0.1"_v));
-            REQUIRE("2013a*"_vs.contains("2013a"_v));
-            REQUIRE_FALSE("2013b*"_vs.contains("2013a"_v));
-            REQUIRE_FALSE("1.2.4*"_vs.contains("1.3.4"_v));
-            REQUIRE("1.2.3*"_vs.contains("1.2.3+4.5.6"_v));
-            REQUIRE("1.2.3+4*"_vs.contains("1.2.3+4.5.6"_v));
-            REQUIRE_FALSE("1.2.3+5*"_vs.contains("1.2.3+4.5.6"_v));
-            REQUIRE_FALSE("1.2.4+5*"_vs.contains("1.2.3+4.5.6"_v));
-            REQUIRE("1.7.*"_vs.contains("1.7.1"_v));
-            REQUIRE("1.7.1"_vs.contains("1.7.1"_v));
-            REQUIRE_FALSE("1.7.0"_vs.contains("1.7.1"_v));
-            REQUIRE_FALSE("1.7"_vs.contains("1.7.1"_v));
-            REQUIRE_FALSE("1.5.*"_vs.contains("1.7.1"_v));
-            REQUIRE(">=1.5"_vs.contains("1.7.1"_v));
-            REQUIRE("!=1.5"_vs.contains("1.7.1"_v));
-            REQUIRE_FALSE("!=1.7.1"_vs.contains("1.7.1"_v));
-            REQUIRE("==1.7.1"_vs.contains("1.7.1"_v));
-            REQUIRE_FALSE("==1.7"_vs.contains("1.7.1"_v));
-            REQUIRE_FALSE("==1.7.2"_vs.contains("1.7.1"_v));
-            REQUIRE("==1.7.1.0"_vs.contains("1.7.1"_v));
-            REQUIRE("==1.7.1.*"_vs.contains("1.7.1.1"_v));  // Degenerate case
-            REQUIRE("1.7.*|1.8.*"_vs.contains("1.7.1"_v));
-            REQUIRE(">1.7,<1.8"_vs.contains("1.7.1"_v));
-            REQUIRE_FALSE(">1.7.1,<1.8"_vs.contains("1.7.1"_v));
-            REQUIRE("*"_vs.contains("1.7.1"_v));
-            REQUIRE("1.5.*|>1.7,<1.8"_vs.contains("1.7.1"_v));
-            REQUIRE_FALSE("1.5.*|>1.7,<1.7.1"_vs.contains("1.7.1"_v));
-            REQUIRE("1.7.0.post123"_vs.contains("1.7.0.post123"_v));
-            REQUIRE("1.7.0.post123.gabcdef9"_vs.contains("1.7.0.post123.gabcdef9"_v));
-            REQUIRE("1.7.0.post123+gabcdef9"_vs.contains("1.7.0.post123+gabcdef9"_v));
-            REQUIRE("=3.3"_vs.contains("3.3.1"_v));
-            REQUIRE("=3.3"_vs.contains("3.3"_v));
-            REQUIRE_FALSE("=3.3"_vs.contains("3.4"_v));
-            REQUIRE("3.3.*"_vs.contains("3.3.1"_v));
-            REQUIRE("3.3.*"_vs.contains("3.3"_v));
-            REQUIRE_FALSE("3.3.*"_vs.contains("3.4"_v));
-            REQUIRE("=3.3.*"_vs.contains("3.3.1"_v));
-            REQUIRE("=3.3.*"_vs.contains("3.3"_v));
-            REQUIRE_FALSE("=3.3.*"_vs.contains("3.4"_v));
-            REQUIRE_FALSE("!=3.3.*"_vs.contains("3.3.1"_v));
-            REQUIRE("!=3.3.*"_vs.contains("3.4"_v));
-            REQUIRE("!=3.3.*"_vs.contains("3.4.1"_v));
-            REQUIRE("!=3.3"_vs.contains("3.3.1"_v));
-            REQUIRE_FALSE("!=3.3"_vs.contains("3.3.0.0"_v));
-            REQUIRE_FALSE("!=3.3.*"_vs.contains("3.3.0.0"_v));
-            REQUIRE_FALSE(">=2.7, !=3.0.*, !=3.1.*, !=3.2.*, !=3.3.*"_vs.contains("2.6.8"_v));
-            REQUIRE(">=2.7, !=3.0.*, !=3.1.*, !=3.2.*, !=3.3.*"_vs.contains("2.7.2"_v));
-            REQUIRE_FALSE(">=2.7, !=3.0.*, !=3.1.*, !=3.2.*, !=3.3.*"_vs.contains("3.3"_v));
-            REQUIRE_FALSE(">=2.7, !=3.0.*, !=3.1.*, !=3.2.*, !=3.3.*"_vs.contains("3.3.4"_v));
-            REQUIRE(">=2.7, !=3.0.*, !=3.1.*, !=3.2.*, !=3.3.*"_vs.contains("3.4"_v));
-            REQUIRE(">=2.7, !=3.0.*, !=3.1.*, !=3.2.*, !=3.3.*"_vs.contains("3.4a"_v));
-            REQUIRE("~=1.10"_vs.contains("1.11.0"_v));
-            REQUIRE_FALSE("~=1.10.0"_vs.contains("1.11.0"_v));
-            REQUIRE_FALSE("~=3.3.2"_vs.contains("3.4.0"_v));
-            REQUIRE_FALSE("~=3.3.2"_vs.contains("3.3.1"_v));
-            REQUIRE("~=3.3.2"_vs.contains("3.3.2.0"_v));
-            REQUIRE("~=3.3.2"_vs.contains("3.3.3"_v));
-            REQUIRE("~=3.3.2|==2.2"_vs.contains("2.2.0"_v));
-            REQUIRE("~=3.3.2|==2.2"_vs.contains("3.3.3"_v));
-            REQUIRE_FALSE("~=3.3.2|==2.2"_vs.contains("2.2.1"_v));
-            REQUIRE("*.*"_vs.contains("3.3"_v));
-            REQUIRE("*.*"_vs.contains("3.3.3"_v));
-            REQUIRE_FALSE("*.*"_vs.contains("3"_v));
-            REQUIRE("2.*.1.1.*"_vs.contains("2.0.1.0.1.1.3"_v));
-            REQUIRE_FALSE("2.*.1.1.*"_vs.contains("2.1.0.1.1"_v));
-            REQUIRE("*.3"_vs.contains("2.1.0.1.1.3"_v));
-            REQUIRE_FALSE("*.3"_vs.contains("0.3.4"_v));
-            REQUIRE("*.2023_10_12"_vs.contains("2.1.0.2023_10_12"_v));
-            REQUIRE(">=10.0,*.*"_vs.contains("10.1"_v));
-            REQUIRE_FALSE(">=10.0,*.*"_vs.contains("11"_v));
-            REQUIRE("1.*.1"_vs.contains("1.7.1"_v));
+            REQUIRE(contains("==1.7"_vs, "1.7.0"_v));
+            REQUIRE(contains("<=1.7"_vs, "1.7.0"_v));
+            REQUIRE_FALSE(contains("<1.7"_vs, "1.7.0"_v));
+            REQUIRE(contains(">=1.7"_vs, "1.7.0"_v));
+            REQUIRE_FALSE(contains(">1.7"_vs, "1.7.0"_v));
+            REQUIRE_FALSE(contains(">=1.7"_vs, "1.6.7"_v));
+            REQUIRE_FALSE(contains(">2013b"_vs, "2013a"_v));
+            REQUIRE(contains(">2013b"_vs, "2013k"_v));
+            REQUIRE_FALSE(contains(">2013b"_vs, "3.0.0"_v));
+            REQUIRE(contains(">1.0.0a"_vs, "1.0.0"_v));
+            REQUIRE(contains(">1.0.0*"_vs, "1.0.0"_v));
+            REQUIRE(contains("1.0*"_vs, "1.0"_v));
+            REQUIRE(contains("1.0*"_vs, "1.0.0"_v));
+            REQUIRE(contains("1.0.0*"_vs, "1.0"_v));
+            REQUIRE_FALSE(contains("1.0.0*"_vs, "1.0.1"_v));
+            REQUIRE(contains("2013a*"_vs, "2013a"_v));
+            REQUIRE_FALSE(contains("2013b*"_vs, "2013a"_v));
+            REQUIRE_FALSE(contains("1.2.4*"_vs, "1.3.4"_v));
+            REQUIRE(contains("1.2.3*"_vs, "1.2.3+4.5.6"_v));
+            REQUIRE(contains("1.2.3+4*"_vs, "1.2.3+4.5.6"_v));
+            REQUIRE_FALSE(contains("1.2.3+5*"_vs, "1.2.3+4.5.6"_v));
+            REQUIRE_FALSE(contains("1.2.4+5*"_vs, "1.2.3+4.5.6"_v));
+            REQUIRE(contains("1.7.*"_vs, "1.7.1"_v));
+            REQUIRE(contains("1.7.1"_vs, "1.7.1"_v));
+            REQUIRE_FALSE(contains("1.7.0"_vs, "1.7.1"_v));
+            REQUIRE_FALSE(contains("1.7"_vs, "1.7.1"_v));
+            REQUIRE_FALSE(contains("1.5.*"_vs, "1.7.1"_v));
+            REQUIRE(contains(">=1.5"_vs, "1.7.1"_v));
+            REQUIRE(contains("!=1.5"_vs, "1.7.1"_v));
+            REQUIRE_FALSE(contains("!=1.7.1"_vs, "1.7.1"_v));
+            REQUIRE(contains("==1.7.1"_vs, "1.7.1"_v));
+            REQUIRE_FALSE(contains("==1.7"_vs, "1.7.1"_v));
+            REQUIRE_FALSE(contains("==1.7.2"_vs, "1.7.1"_v));
+            REQUIRE(contains("==1.7.1.0"_vs, "1.7.1"_v));
+            REQUIRE(contains("==1.7.1.*"_vs, "1.7.1.1"_v));  // Degenerate case
+            REQUIRE(contains("1.7.*|1.8.*"_vs, "1.7.1"_v));
+            REQUIRE(contains(">1.7,<1.8"_vs, "1.7.1"_v));
+            REQUIRE_FALSE(contains(">1.7.1,<1.8"_vs, "1.7.1"_v));
+            REQUIRE(contains("*"_vs, "1.7.1"_v));
+            REQUIRE(contains("1.5.*|>1.7,<1.8"_vs, "1.7.1"_v));
+            REQUIRE_FALSE(contains("1.5.*|>1.7,<1.7.1"_vs, "1.7.1"_v));
+            REQUIRE(contains("1.7.0.post123"_vs, "1.7.0.post123"_v));
+            REQUIRE(contains("1.7.0.post123.gabcdef9"_vs, "1.7.0.post123.gabcdef9"_v));
+            REQUIRE(contains("1.7.0.post123+gabcdef9"_vs, "1.7.0.post123+gabcdef9"_v));
+            REQUIRE(contains("=3.3"_vs, "3.3.1"_v));
+            REQUIRE(contains("=3.3"_vs, "3.3"_v));
+            REQUIRE_FALSE(contains("=3.3"_vs, "3.4"_v));
+            REQUIRE(contains("3.3.*"_vs, "3.3.1"_v));
+            REQUIRE(contains("3.3.*"_vs, "3.3"_v));
+            REQUIRE_FALSE(contains("3.3.*"_vs, "3.4"_v));
+            REQUIRE(contains("=3.3.*"_vs, "3.3.1"_v));
+            REQUIRE(contains("=3.3.*"_vs, "3.3"_v));
+            REQUIRE_FALSE(contains("=3.3.*"_vs, "3.4"_v));
+            REQUIRE_FALSE(contains("!=3.3.*"_vs, "3.3.1"_v));
+            REQUIRE(contains("!=3.3.*"_vs, "3.4"_v));
+            REQUIRE(contains("!=3.3.*"_vs, "3.4.1"_v));
+            REQUIRE(contains("!=3.3"_vs, "3.3.1"_v));
+            REQUIRE_FALSE(contains("!=3.3"_vs, "3.3.0.0"_v));
+            REQUIRE_FALSE(contains("!=3.3.*"_vs, "3.3.0.0"_v));
+            REQUIRE_FALSE(contains(">=2.7, !=3.0.*, !=3.1.*, !=3.2.*, !=3.3.*"_vs, "2.6.8"_v));
+            REQUIRE(contains(">=2.7, !=3.0.*, !=3.1.*, !=3.2.*, !=3.3.*"_vs, "2.7.2"_v));
+            REQUIRE_FALSE(contains(">=2.7, !=3.0.*, !=3.1.*, !=3.2.*, !=3.3.*"_vs, "3.3"_v));
+            REQUIRE_FALSE(contains(">=2.7, !=3.0.*, !=3.1.*, !=3.2.*, !=3.3.*"_vs, "3.3.4"_v));
+            REQUIRE(contains(">=2.7, !=3.0.*, !=3.1.*, !=3.2.*, !=3.3.*"_vs, "3.4"_v));
+            REQUIRE(contains(">=2.7, !=3.0.*, !=3.1.*, !=3.2.*, !=3.3.*"_vs, "3.4a"_v));
+            REQUIRE(contains("~=1.10"_vs, "1.11.0"_v));
+            REQUIRE_FALSE(contains("~=1.10.0"_vs, "1.11.0"_v));
+            REQUIRE_FALSE(contains("~=3.3.2"_vs, "3.4.0"_v));
+            REQUIRE_FALSE(contains("~=3.3.2"_vs, "3.3.1"_v));
+            REQUIRE(contains("~=3.3.2"_vs, "3.3.2.0"_v));
+            REQUIRE(contains("~=3.3.2"_vs, "3.3.3"_v));
+            REQUIRE(contains("~=3.3.2|==2.2"_vs, "2.2.0"_v));
+            REQUIRE(contains("~=3.3.2|==2.2"_vs, "3.3.3"_v));
+            REQUIRE_FALSE(contains("~=3.3.2|==2.2"_vs, "2.2.1"_v));
+            REQUIRE(contains("*.*"_vs, "3.3"_v));
+            REQUIRE(contains("*.*"_vs, "3.3.3"_v));
+            REQUIRE_FALSE(contains("*.*"_vs, "3"_v));
+            REQUIRE(contains("2.*.1.1.*"_vs, "2.0.1.0.1.1.3"_v));
+            REQUIRE_FALSE(contains("2.*.1.1.*"_vs, "2.1.0.1.1"_v));
+            REQUIRE(contains("*.3"_vs, "2.1.0.1.1.3"_v));
+            REQUIRE_FALSE(contains("*.3"_vs, "0.3.4"_v));
+            REQUIRE(contains("*.2023_10_12"_vs, "2.1.0.2023_10_12"_v));
+            REQUIRE(contains(">=10.0,*.*"_vs, "10.1"_v));
+            REQUIRE_FALSE(contains(">=10.0,*.*"_vs, "11"_v));
+            REQUIRE(contains("1.*.1"_vs, "1.7.1"_v));
 
             // Regex are currently not supported
-            // REQUIRE("^1.7.1$"_vs.contains("1.7.1"_v));
-            // REQUIRE(R"(^1\.7\.1$)"_vs.contains("1.7.1"_v));
-            // REQUIRE(R"(^1\.7\.[0-9]+$)"_vs.contains("1.7.1"_v));
-            // REQUIRE_FALSE(R"(^1\.8.*$)"_vs.contains("1.7.1"_v));
-            // REQUIRE(R"(^1\.[5-8]\.1$)"_vs.contains("1.7.1"_v));
-            // REQUIRE_FALSE(R"(^[^1].*$)"_vs.contains("1.7.1"_v));
-            // REQUIRE(R"(^[0-9+]+\.[0-9+]+\.[0-9]+$)"_vs.contains("1.7.1"_v));
-            // REQUIRE_FALSE("^$"_vs.contains("1.7.1"_v));
-            // REQUIRE("^.*$"_vs.contains("1.7.1"_v));
-            // REQUIRE("1.7.*|^0.*$"_vs.contains("1.7.1"_v));
-            // REQUIRE_FALSE("1.6.*|^0.*$"_vs.contains("1.7.1"_v));
-            // REQUIRE("1.6.*|^0.*$|1.7.1"_vs.contains("1.7.1"_v));
-            // REQUIRE("^0.*$|1.7.1"_vs.contains("1.7.1"_v));
-            // REQUIRE(R"(1.6.*|^.*\.7\.1$|0.7.1)"_vs.contains("1.7.1"_v));
+            // REQUIRE(contains("^1.7.1$"_vs, "1.7.1"_v));
+            // REQUIRE(Rcontains("(^1\.7\.1$)"_vs, "1.7.1"_v));
+            // REQUIRE(Rcontains("(^1\.7\.[0-9]+$)"_vs, "1.7.1"_v));
+            // REQUIRE_FALSE(Rcontains("(^1\.8.*$)"_vs, "1.7.1"_v));
+            // REQUIRE(Rcontains("(^1\.[5-8]\.1$)"_vs, "1.7.1"_v));
+            // REQUIRE_FALSE(Rcontains("(^[^1].*$)"_vs, "1.7.1"_v));
+            // REQUIRE(Rcontains("(^[0-9+]+\.[0-9+]+\.[0-9]+$)"_vs, "1.7.1"_v));
+            // REQUIRE_FALSE(contains("^$"_vs, "1.7.1"_v));
+            // REQUIRE(contains("^.*$"_vs, "1.7.1"_v));
+            // REQUIRE(contains("1.7.*|^0.*$"_vs, "1.7.1"_v));
+            // REQUIRE_FALSE(contains("1.6.*|^0.*$"_vs, "1.7.1"_v));
+            // REQUIRE(contains("1.6.*|^0.*$|1.7.1"_vs, "1.7.1"_v));
+            // REQUIRE(contains("^0.*$|1.7.1"_vs, "1.7.1"_v));
+            // REQUIRE(Rcontains("(1.6.*|^.*\.7\.1$|0.7.1)"_vs, "1.7.1"_v));
         }
 
         SECTION("Unsuccessful")
@@ -596,4 +615,94 @@ namespace
         REQUIRE(hash_fn(spec1) == hash_fn(spec2));
         REQUIRE(hash_fn(spec1) != hash_fn(spec3));
     }
+
+    TEST_CASE("VersionSpec compiled program", "[mamba::specs][mamba::specs::VersionSpec]")
+    {
+        static constexpr auto specs = std::array<std::string_view, 21>{
+            ">=1.2,<2",
+            "<1.0|>=1.5,<1.7|==2.0",
+            "!=1.5,!=1.6",
+            "!=1.5|!=1.6",
+            "(>1.0,<1.0)|1.8.*",
+            ">=1.0,<=1.0",
+            "<1.5|>1.2",
+            "(<1.5|>1.2),!=1.8",
+            "1.8.*,!=1.8.3",
+            "~=1.4.2|<0.5",
+            "1.0.*",
+            "1.2.0.*",
+            "=1.0",
+            "=1.2",
+            "=1.2+local",
+            ">=2|(<1.5,!=1.2)",
+            "1.*.3|>2.0a",
+            "((>=1.0,<1.2)|(>=1.5,<1.8)),(>1.1|<1.0)",
+            ">1.2,<1.2",
+            "*,<1.5",
+            "1!1.0.*|0.1",
+        };
+        const auto versions = mamba::util::split(
+            "0.1 0.5 1.0 1.0.0 1.0a 1.0.3 1.1 1.2 1.2.0 1.2.1 1.2.3 1.2+local 1.4.2 1.4.3 1.5 "
+            "1.5.0.1 1.6 1.7 1.8 1.8.0 1.8.3 1.8a 1.8.3.0 1.9 2.0 2.0a 2.0.post1 2.1 1!1.0 1!1.0.5 "
+            "1a.2 1.2a 10.2 0.1.2",
+            " "
+        );
+
+        for (const auto& spec_str : specs)
+        {
+            const auto spec = VersionSpec::parse(spec_str).value();
+            for (const auto& ver_str : versions)
+            {
+                CAPTURE(spec_str, ver_str);
+                [[maybe_unused]] const auto found = contains(spec, Version::parse(ver_str).value());
+            }
+        }
+
+        REQUIRE_FALSE(contains("1.0.*"_vs, "1.5"_v));
+        REQUIRE(contains("1.0.*"_vs, "1.0.5"_v));
+        REQUIRE(contains("!=1.5,!=1.6"_vs, "1.5.1"_v));
+        REQUIRE_FALSE(contains("!=1.5,!=1.6"_vs, "1.6.0"_v));
+    }
+
+    TEST_CASE("VersionSpec contains", "[.benchmark]")
+    {
+        auto versions = std::vector<Version>();
+        for (std::size_t major = 0; major < 10; ++major)
+        {
+            for (std::size_t minor = 0; minor < 100; ++minor)
+            {
+                for (std::size_t patch = 0; patch < 10; ++patch)
+                {
+                    versions.push_back(Version(0, { { { major } }, { { minor } }, { { patch } } }));
+                }
+            }
+        }
+
+        for (const auto spec_str : { ">=1.2,<2|>=3.4.5,<3.5", "4.18.*", "!=1.2.3,>=1.0,<6" })
+        {
+            const auto spec = VersionSpec::parse(spec_str).value();
+
+            BENCHMARK(std::string("compiled ") + spec_str)
+            {
+                return std::count_if(
+                    versions.cbegin(),
+                    versions.cend(),
+                    [&](const auto& v) { return spec.contains(v); }
+                );
+            };
+
+            BENCHMARK(std::string("tree ") + spec_str)
+            {
+                return std::count_if(
+                    versions.cbegin(),
+                    versions.cend(),
+                    [&](const auto& v)
+                    {
+                        return spec.expression().evaluate([&](const auto& pred)
+                                                          { return pred.contains(v); });
+                    }
+                );
+            };
+        }
+    }
 }
@@ -505,4 +505,42 @@ namespace
         // There could be many representations, here is one
         REQUIRE(result == "((x0 or x1) and ((x2 or (x3 or x4)) and x5)) or x6");
     }
+
+    TEST_CASE("Postfix traversal")
+    {
+        auto parser = InfixParser<std::size_t, BoolOperator>{};
+        // Infix:  (x0 or x1) and x2
+        REQUIRE(parser.push_left_parenthesis());
+        REQUIRE(parser.push_variable(0));
+        REQUIRE(parser.push_operator(BoolOperator::logical_or));
+        REQUIRE(parser.push_variable(1));
+        REQUIRE(parser.push_right_parenthesis());
+        REQUIRE(parser.push_operator(BoolOperator::logical_and));
+        REQUIRE(parser.push_variable(2));
+        REQUIRE(parser.finalize());
+        auto tree = flat_bool_expr_tree(std::move(parser).tree());
+
+        auto result = std::string();
+        tree.postfix_for_each(
+            [&](const auto& token)
+            {
+                using Token = std::decay_t<decltype(token)>;
+                if constexpr (std::is_same_v<Token, BoolOperator>)
+                {
+                    result += (token == BoolOperator::logical_or) ? " or" : " and";
+                }
+                else
+                {
+                    result += " x";
+                    result += std::to_string(token);
+                }
+            }
+        );
+        REQUIRE(result == " x0 x1 or x2 and");
+
+        auto empty_visited = false;
+        flat_bool_expr_tree<std::size_t>().postfix_for_each([&](const auto&)
+                                                            { empty_visited = true; });
+        REQUIRE_FALSE(empty_visited);
+    }
 }
@@ -38,6 +38,31 @@ namespace
         REQUIRE(md5 == "098f6bcd4621d373cade4e832627b4f6");
     }
 
+    TEST_CASE("checksums_of_successive_files")
+    {
+        auto tmp_a = TemporaryFile();
+        auto tmp_b = TemporaryFile();
+        {
+            auto f = mamba::open_ofstream(tmp_a.path());
+            f << "test";
+        }
+        {
+            auto f = mamba::open_ofstream(tmp_b.path());
+            f << "other";
+        }
+
+        // Successive calls from the same thread must not reuse the previous result
+        const auto sha256_a = std::string(sha256sum(tmp_a.path()));
+        const auto sha256_b = std::string(sha256sum(tmp_b.path()));
+        REQUIRE(sha256_a == "9f86d081884c7d659a2feaa0c55ad015a3bf4f1b2b0b822cd15d6c15b0f00a08");
+        REQUIRE(sha256_b != sha256_a);
+
+        const auto md5_a = std::string(md5sum(tmp_a.path()));
+        const auto md5_b = std::string(md5sum(tmp_b.path()));
+        REQUIRE(md5_a == "098f6bcd4621d373cade4e832627b4f6");
+        REQUIRE(md5_b != md5_a);
+    }
+
     TEST_CASE("ed25519_key_hex_to_bytes")
     {
         std::array<std::byte, MAMBA_ED25519_KEYSIZE_BYTES> pk, sk;
@@ -91,6 +91,15 @@ init_general_options(CLI::App* subcom, Configuration& config)
     auto& use_uv = config.at("use_uv");
     subcom->add_flag("--use-uv", use_uv.get_cli_config<bool>(), use_uv.description())->group(cli_group);
 
+    auto& timings_json = config.at("timings_json");
+    subcom
+        ->add_option(
+            "--timings-json",
+            timings_json.get_cli_config<fs::u8path>(),
+            timings_json.description()
+        )
+        ->group(cli_group);
+
     auto& debug = config.at("debug");
     subcom->add_flag("--debug", debug.get_cli_config<bool>(), "Debug mode")->group("");
 
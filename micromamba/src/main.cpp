@@ -15,6 +15,8 @@
 #include "mamba/util/os_win.hpp"
 #endif
 
+#include <chrono>
+
 #include <CLI/CLI.hpp>
 
 #include "mamba/api/configuration.hpp"
@@ -33,6 +35,7 @@ using namespace mamba;  // NOLINT(build/namespaces)
 int
 main(int argc, char** argv)
 {
+    const auto start = std::chrono::steady_clock::now();
     mamba::MainExecutor scoped_threads;
     mamba::Context ctx{ {
         /* .enable_logging = */ true,
@@ -111,6 +114,20 @@ main(int argc, char** argv)
 
     reset_console();
 
+    if (!ctx.output_params.timings_json.empty())
+    {
+        ctx.timings.record("command", {}, std::chrono::steady_clock::now() - start);
+        try
+        {
+            ctx.timings.dump(ctx.output_params.timings_json);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_WARNING << "Could not write the timings to " << ctx.output_params.timings_json
+                        << ": " << e.what();
+        }
+    }
+
     if (error_to_report)
     {
         LOG_CRITICAL << error_to_report.value();